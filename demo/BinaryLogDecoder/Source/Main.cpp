@@ -0,0 +1,78 @@
+﻿/*
+  ==============================================================================
+
+    Renders a binary log, written by a ConsoleOutputStream in record mode,
+    as text on the standard output.
+
+    Usage: BinaryLogDecoder <log file> [--locations]
+
+    With "--locations", each line is preceded by the source file and line
+    of the call site that wrote it.
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+	ConsoleOutputStream ezout, ezerr;
+
+	ezout.setFlushPolicy(ConsoleOutputStream::flushAutomatically);
+	ezerr.setSink(new StandardOutputSink(true), true);
+	ezerr.setFlushPolicy(ConsoleOutputStream::flushUnbuffered);
+
+	if (argc < 2)
+	{
+		ezerr << "Usage: " << argv[0] << " <log file> [--locations]" << newLine;
+		return 1;
+	}
+
+	const File logFile(File::getCurrentWorkingDirectory().getChildFile(String::fromUTF8(argv[1])));
+	const bool showLocations = argc > 2 && strcmp(argv[2], "--locations") == 0;
+
+	FileInputStream fileStream(logFile);
+
+	if (!fileStream.openedOk())
+	{
+		ezerr << "Cannot open " << logFile.getFullPathName() << newLine;
+		return 1;
+	}
+
+	BufferedInputStream source(fileStream, 256 * 1024);
+	ConsoleLogReader reader(source);
+
+	if (showLocations)
+	{
+		ConsoleChunkBuffer line;
+
+		while (reader.readNextLine(line))
+		{
+			ezout << reader.getSourceFile() << ":" << reader.getSourceLine() << ": ";
+
+			for (const ConsoleChunk *c = line.getFirstChunk(); c != nullptr; c = c->next)
+				ezout.write(c->data, c->size);
+
+			line.clear();
+		}
+	}
+	else
+	{
+		while (reader.readNextLine(ezout))
+		{
+		}
+	}
+
+	ezout.flush();
+
+	if (reader.getError().isNotEmpty())
+	{
+		ezerr << logFile.getFileName() << ": " << reader.getError()
+		      << " (after " << reader.getNumLinesRead() << " lines)" << newLine;
+		return 1;
+	}
+
+	return 0;
+}
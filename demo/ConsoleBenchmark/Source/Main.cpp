@@ -0,0 +1,521 @@
+﻿/*
+  ==============================================================================
+
+    Measures the throughput and the per-message latency of ConsoleOutputStream
+    against std::cout, printf and write(2), for several workloads, writing to
+    /dev/null, a pipe and a file.
+
+    Usage: ConsoleBenchmark [--messages N] [--repeat N]
+                            [--workloads ascii,cjk,numeric,small]
+                            [--targets null,pipe,file]
+                            [--methods ezconsole,ezconsole-async,cout,printf,write]
+           ConsoleBenchmark --test
+
+    Every method writes to file descriptor 1, which is pointed at the target
+    for the length of a run, and stdout is fully buffered for all of them.
+    One message in every 16 is timed on its own for the latency percentiles.
+
+    Each result is printed on the standard output as one line of JSON, so
+    that runs can be compared between releases of the module. Progress goes
+    to the standard error.
+
+    With --test, the unit tests below are run instead, and the exit code is
+    the number of failures.
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#include <cstdio>
+#include <iostream>
+
+
+//==============================================================================
+namespace
+{
+	const char *const asciiLine = "The quick brown fox jumps over the lazy dog, 0123456789 times.\n";
+	const char *const cjkLine = "控制台输出测试：中文、日本語、한국어混排的一行文本。\n";
+	const char *const smallLine = "ok\n";
+
+	const char *const workloadNames[] = { "ascii", "cjk", "numeric", "small" };
+	const char *const targetNames[] = { "null", "pipe", "file" };
+	const char *const methodNames[] = { "ezconsole", "ezconsole-async", "cout", "printf", "write" };
+
+	enum Workload { asciiWorkload, cjkWorkload, numericWorkload, smallWorkload };
+	enum Method { ezconsoleMethod, ezconsoleAsyncMethod, coutMethod, printfMethod, writeMethod };
+
+	const int latencySampleInterval = 16;
+
+	//==============================================================================
+	// Sends the results to a file descriptor other than 1, which the runs take over.
+	class DescriptorSink : public ConsoleSink
+	{
+	public:
+		explicit DescriptorSink(int fd) : fileDescriptor(fd) {}
+
+		bool write(const void *data, size_t numBytes) override
+		{
+			return StandardOutputSink::writeToFileDescriptor(fileDescriptor, data, numBytes);
+		}
+
+	private:
+		int fileDescriptor;
+	};
+
+	//==============================================================================
+	class ConsoleStreamWriter
+	{
+	public:
+		explicit ConsoleStreamWriter(bool async)
+		{
+			// Whether stdout is a terminal is only looked at once, before the
+			// targets take it over, so ask for the buffering a file would get.
+			stream.setFlushPolicy(ConsoleOutputStream::flushBlockBuffered);
+			stream.setAsyncMode(async);
+		}
+
+		void write(Workload workload, int i)
+		{
+			switch (workload)
+			{
+			case asciiWorkload:   stream << asciiLine; break;
+			case cjkWorkload:     stream << cjkLine; break;
+			case numericWorkload: stream << "id " << i << " value " << i * 0.25 << " mask " << ConsoleOutputStream::hex((juce::uint64)i) << "\n"; break;
+			case smallWorkload:   stream << smallLine; break;
+			}
+		}
+
+		void finish()
+		{
+			stream.flush();
+		}
+
+	private:
+		ConsoleOutputStream stream;
+	};
+
+	class CoutWriter
+	{
+	public:
+		void write(Workload workload, int i)
+		{
+			switch (workload)
+			{
+			case asciiWorkload:   std::cout << asciiLine; break;
+			case cjkWorkload:     std::cout << cjkLine; break;
+			case numericWorkload: std::cout << "id " << i << " value " << i * 0.25 << " mask " << std::hex << i << std::dec << '\n'; break;
+			case smallWorkload:   std::cout << smallLine; break;
+			}
+		}
+
+		void finish()
+		{
+			std::cout.flush();
+		}
+	};
+
+	class PrintfWriter
+	{
+	public:
+		void write(Workload workload, int i)
+		{
+			switch (workload)
+			{
+			case asciiWorkload:   printf("%s", asciiLine); break;
+			case cjkWorkload:     printf("%s", cjkLine); break;
+			case numericWorkload: printf("id %d value %g mask %x\n", i, i * 0.25, (unsigned int)i); break;
+			case smallWorkload:   printf("%s", smallLine); break;
+			}
+		}
+
+		void finish()
+		{
+			fflush(stdout);
+		}
+	};
+
+	// One system call per message, which is what an unbuffered logger does.
+	class RawWriteWriter
+	{
+	public:
+		RawWriteWriter()
+			: asciiSize(strlen(asciiLine)), cjkSize(strlen(cjkLine)), smallSize(strlen(smallLine))
+		{
+		}
+
+		void write(Workload workload, int i)
+		{
+			switch (workload)
+			{
+			case asciiWorkload:   writeAll(asciiLine, asciiSize); break;
+			case cjkWorkload:     writeAll(cjkLine, cjkSize); break;
+			case numericWorkload: writeAll(line, (size_t)snprintf(line, sizeof(line), "id %d value %g mask %x\n", i, i * 0.25, (unsigned int)i)); break;
+			case smallWorkload:   writeAll(smallLine, smallSize); break;
+			}
+		}
+
+		void finish()
+		{
+		}
+
+	private:
+		static void writeAll(const char *data, size_t numBytes)
+		{
+			StandardOutputSink::writeToFileDescriptor(STDOUT_FILENO, data, numBytes);
+		}
+
+		const size_t asciiSize, cjkSize, smallSize;
+		char line[128];
+	};
+
+	//==============================================================================
+	// Keeps reading the other end of the pipe target, as a consumer would.
+	class PipeDrain : public Thread
+	{
+	public:
+		explicit PipeDrain(int fd) : Thread("PipeDrain"), fileDescriptor(fd) {}
+
+		~PipeDrain()
+		{
+			waitForThreadToExit(-1);
+		}
+
+		void run() override
+		{
+			char data[65536];
+
+			while (::read(fileDescriptor, data, sizeof(data)) != 0)
+			{
+			}
+		}
+
+	private:
+		int fileDescriptor;
+	};
+
+	class Target
+	{
+	public:
+		explicit Target(int index)
+		{
+			if (index == 0)
+			{
+				fileDescriptor = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+			}
+			else if (index == 1)
+			{
+				int fds[2];
+
+				if (::pipe(fds) == 0)
+				{
+					fileDescriptor = fds[1];
+					readEnd = fds[0];
+					drain = new PipeDrain(readEnd);
+					drain->startThread();
+				}
+			}
+			else
+			{
+				file = File::createTempFile(".log");
+				fileDescriptor = ::open(file.getFullPathName().toRawUTF8(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			}
+		}
+
+		~Target()
+		{
+			if (fileDescriptor >= 0)
+				::close(fileDescriptor);
+
+			drain = nullptr;
+
+			if (readEnd >= 0)
+				::close(readEnd);
+
+			if (file != File())
+				file.deleteFile();
+		}
+
+		bool isOpen() const
+		{
+			return fileDescriptor >= 0;
+		}
+
+		// Each run starts with an empty file, so they all pay the same for growing it.
+		void rewind()
+		{
+			if (file != File() && ::ftruncate(fileDescriptor, 0) == 0)
+				::lseek(fileDescriptor, 0, SEEK_SET);
+		}
+
+		int getFileDescriptor() const
+		{
+			return fileDescriptor;
+		}
+
+	private:
+		int fileDescriptor = -1, readEnd = -1;
+		ScopedPointer<PipeDrain> drain;
+		File file;
+	};
+
+	//==============================================================================
+	template <typename Writer>
+	double runWriter(Writer &writer, Workload workload, int numMessages, ConsoleLatencyHistogram &latency)
+	{
+		const int64 start = Time::getHighResolutionTicks();
+
+		for (int i = 0; i < numMessages; ++i)
+		{
+			if (i % latencySampleInterval == 0)
+			{
+				const int64 messageStart = Time::getHighResolutionTicks();
+				writer.write(workload, i);
+				latency.record((uint64)(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - messageStart) * 1.0e9));
+			}
+			else
+			{
+				writer.write(workload, i);
+			}
+		}
+
+		writer.finish();
+		return Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+	}
+
+	double runOnce(Method method, Workload workload, int numMessages, ConsoleLatencyHistogram &latency)
+	{
+		switch (method)
+		{
+		case ezconsoleMethod:      { ConsoleStreamWriter w(false); return runWriter(w, workload, numMessages, latency); }
+		case ezconsoleAsyncMethod: { ConsoleStreamWriter w(true);  return runWriter(w, workload, numMessages, latency); }
+		case coutMethod:           { CoutWriter w;                 return runWriter(w, workload, numMessages, latency); }
+		case printfMethod:         { PrintfWriter w;               return runWriter(w, workload, numMessages, latency); }
+		default:                   { RawWriteWriter w;             return runWriter(w, workload, numMessages, latency); }
+		}
+	}
+
+	//==============================================================================
+	// Only counts a line once it has been flushed, which is all that a producer
+	// returning from "flush" may count on.
+	class FlushRecordingSink : public ConsoleSink
+	{
+	public:
+		bool write(const void *data, size_t numBytes) override
+		{
+			const ScopedLock sl(lock);
+			pending += String::fromUTF8(static_cast<const char*>(data), (int)numBytes);
+			return true;
+		}
+
+		bool flush() override
+		{
+			const ScopedLock sl(lock);
+
+			for (int end = pending.indexOfChar('\n'); end >= 0; end = pending.indexOfChar('\n'))
+			{
+				flushedLines.add(pending.substring(0, end));
+				pending = pending.substring(end + 1);
+			}
+
+			return true;
+		}
+
+		bool hasFlushed(const String &line) const
+		{
+			const ScopedLock sl(lock);
+			return flushedLines.contains(line);
+		}
+
+	private:
+		CriticalSection lock;
+		String pending;
+		SortedSet<String> flushedLines;
+	};
+
+	// Several producers write to one ConcurrentConsoleStream, and each checks
+	// that its own line has been flushed when its "flush" returns.
+	class ConcurrentFlushTest : public UnitTest
+	{
+	public:
+		ConcurrentFlushTest() : UnitTest("ConcurrentConsoleStream flush") {}
+
+		void runTest() override
+		{
+			beginTest("Writer thread");
+			runProducers(true);
+
+			beginTest("Synchronised sink");
+			runProducers(false);
+		}
+
+	private:
+		enum { numProducers = 8, numLinesPerProducer = 2000 };
+
+		class Producer : public Thread
+		{
+		public:
+			Producer(ConcurrentConsoleStream &streamToUse, FlushRecordingSink &sinkToCheck, int producerIndex)
+				: Thread("Producer"), stream(streamToUse), sink(sinkToCheck), index(producerIndex)
+			{
+			}
+
+			void run() override
+			{
+				for (int i = 0; i < numLinesPerProducer; ++i)
+				{
+					const String line = "producer " + String(index) + " line " + String(i);
+
+					stream << line << "\n";
+					stream.flush();
+
+					if (!sink.hasFlushed(line))
+						++numMissing;
+				}
+			}
+
+			int numMissing = 0;
+
+		private:
+			ConcurrentConsoleStream &stream;
+			FlushRecordingSink &sink;
+			const int index;
+		};
+
+		void runProducers(bool useWriterThread)
+		{
+			FlushRecordingSink sink;
+			ConcurrentConsoleStream stream(&sink, false, useWriterThread);
+			OwnedArray<Producer> producers;
+
+			for (int i = 0; i < numProducers; ++i)
+				producers.add(new Producer(stream, sink, i))->startThread();
+
+			for (int i = 0; i < numProducers; ++i)
+			{
+				producers[i]->waitForThreadToExit(-1);
+				expectEquals(producers[i]->numMissing, 0, "lines not flushed when flush returned");
+			}
+		}
+	};
+
+	ConcurrentFlushTest concurrentFlushTest;
+
+	int runUnitTests()
+	{
+		UnitTestRunner runner;
+		runner.runAllTests();
+
+		int numFailures = 0;
+
+		for (int i = 0; i < runner.getNumResults(); ++i)
+			numFailures += runner.getResult(i)->failures;
+
+		return numFailures;
+	}
+
+	//==============================================================================
+	String getOption(const StringArray &args, const char *name, const String &defaultValue)
+	{
+		const int index = args.indexOf(name);
+		return index >= 0 && index + 1 < args.size() ? args[index + 1] : defaultValue;
+	}
+
+	// Returns the indexes of the chosen names, in the order of the table.
+	Array<int> getChoices(const StringArray &args, const char *name, const char *const *names, int numNames)
+	{
+		const StringArray chosen(StringArray::fromTokens(getOption(args, name, "all"), ",", ""));
+		Array<int> indexes;
+
+		for (int i = 0; i < numNames; ++i)
+			if (chosen.contains("all") || chosen.contains(names[i]))
+				indexes.add(i);
+
+		return indexes;
+	}
+}
+
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+	StringArray args;
+
+	for (int i = 1; i < argc; ++i)
+		args.add(String::fromUTF8(argv[i]));
+
+	if (args.contains("--test"))
+		return runUnitTests();
+
+	const int numMessages = jmax(1, getOption(args, "--messages", "1000000").getIntValue());
+	const int numRepeats = jmax(1, getOption(args, "--repeat", "3").getIntValue());
+
+	const Array<int> workloads = getChoices(args, "--workloads", workloadNames, numElementsInArray(workloadNames));
+	const Array<int> targets = getChoices(args, "--targets", targetNames, numElementsInArray(targetNames));
+	const Array<int> methods = getChoices(args, "--methods", methodNames, numElementsInArray(methodNames));
+
+	const int resultsDescriptor = ::dup(STDOUT_FILENO);
+
+	ConsoleOutputStream results, progress;
+	results.setSink(new DescriptorSink(resultsDescriptor), true);
+	progress.setSink(new StandardOutputSink(true), true);
+	progress.setFlushPolicy(ConsoleOutputStream::flushUnbuffered);
+
+	// Whatever stdout was, printf and cout get the same buffering as a file.
+	setvbuf(stdout, nullptr, _IOFBF, BUFSIZ);
+
+	for (int t = 0; t < targets.size(); ++t)
+	{
+		Target target(targets[t]);
+
+		if (!target.isOpen())
+		{
+			progress << "Cannot open the " << targetNames[targets[t]] << " target" << "\n";
+			return 1;
+		}
+
+		for (int w = 0; w < workloads.size(); ++w)
+		{
+			for (int m = 0; m < methods.size(); ++m)
+			{
+				progress << workloadNames[workloads[w]] << " -> " << targetNames[targets[t]]
+				         << " with " << methodNames[methods[m]] << "\n";
+
+				ConsoleLatencyHistogram latency;
+				Array<double> seconds;
+
+				for (int r = 0; r < numRepeats; ++r)
+				{
+					target.rewind();
+					::dup2(target.getFileDescriptor(), STDOUT_FILENO);
+
+					seconds.add(runOnce((Method)methods[m], (Workload)workloads[w], numMessages, latency));
+
+					fflush(stdout);
+					::dup2(resultsDescriptor, STDOUT_FILENO);
+				}
+
+				std::sort(seconds.begin(), seconds.end());
+				const double median = seconds[seconds.size() / 2];
+
+				results << "{\"workload\":\"" << workloadNames[workloads[w]] << "\""
+				        << ",\"target\":\"" << targetNames[targets[t]] << "\""
+				        << ",\"method\":\"" << methodNames[methods[m]] << "\""
+				        << ",\"messages\":" << numMessages
+				        << ",\"repeats\":" << numRepeats
+				        << ",\"seconds\":" << median
+				        << ",\"messagesPerSecond\":" << (juce::int64)(numMessages / median)
+				        << ",\"latencyMeanNs\":" << (juce::int64)latency.getMean()
+				        << ",\"latencyP50Ns\":" << (juce::int64)latency.getValueAtPercentile(50.0)
+				        << ",\"latencyP99Ns\":" << (juce::int64)latency.getValueAtPercentile(99.0)
+				        << ",\"latencyP999Ns\":" << (juce::int64)latency.getValueAtPercentile(99.9)
+				        << ",\"latencyMaxNs\":" << (juce::int64)latency.getMax()
+				        << "}\n";
+
+				results.printData();
+			}
+		}
+	}
+
+	return 0;
+}
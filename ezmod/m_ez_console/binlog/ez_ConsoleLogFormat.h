@@ -0,0 +1,206 @@
+﻿#pragma once
+#define EZ_CONSOLELOGFORMAT_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief The format string of one logging call site, with a numeric id.
+	       一个日志调用点的格式字符串及其数字 id。
+
+	Each call site keeps one of these in a static variable, which the
+	EZ_CONSOLE_LOG macro declares for you. The id is handed out the first time
+	the call site runs. In record mode, a ConsoleOutputStream writes only this
+	id and the raw arguments, and describes the format itself once per stream
+	so that ConsoleLogReader can render the text later.
+
+	As with ConsoleOutputStream::print, each "{}" is replaced by the next
+	argument, and "{{" and "}}" stand for literal braces. The text is split into
+	its literal parts once, when the object is created.
+
+	每个调用点在一个静态变量中保存一个该对象，EZ_CONSOLE_LOG 宏会替你声明它。id在
+	调用点第一次执行时分配。在记录模式下，ConsoleOutputStream 只写出这个id和原始
+	参数，并在每个输出流中对格式本身描述一次，以便 ConsoleLogReader 之后渲染出文本。
+
+	与 ConsoleOutputStream::print 相同，每个"{}"都会被下一个参数替换，"{{"和"}}"
+	表示字面的花括号。文本在对象创建时一次性拆分为各个字面部分。
+
+	@see EZ_CONSOLE_LOG, ConsoleOutputStream::log, ConsoleLogReader
+*/
+class ConsoleLogFormat
+{
+public:
+	//==============================================================================
+	/** @brief Creates a format and gives it a new id.
+	           创建一个格式并为其分配一个新的id。
+
+		@param formatText  The format string. It must stay valid for as long as
+		                   this object does, which a string literal always does.
+		                   格式字符串。它必须在该对象的整个生命周期内保持有效，字符串
+		                   字面量总是满足这一点。
+
+		@param sourceFile  The file of the call site, usually __FILE__.
+		                   调用点所在的文件，通常为__FILE__。
+
+		@param sourceLine  The line of the call site, usually __LINE__.
+		                   调用点所在的行，通常为__LINE__。
+	*/
+	ConsoleLogFormat(const char *formatText, const char *sourceFile, int sourceLine)
+		: text(formatText), file(sourceFile), line(sourceLine),
+		  id(getNextId().fetch_add(1))
+	{
+		jassert(formatText != nullptr);
+
+		numPlaceholders = splitLiterals(formatText, strlen(formatText), literals, literalEnds);
+
+		// An unmatched brace: use "{{" and "}}" for literal braces.
+		jassert(numPlaceholders >= 0);
+	}
+
+	//==============================================================================
+	/** @brief Returns the id that records of this format are written with.
+	           返回该格式的记录所使用的id。
+	*/
+	juce::uint32 getId() const               { return id; }
+
+	/** @brief Returns the format string given in the constructor.
+	           返回构造函数中指定的格式字符串。
+	*/
+	const char* getText() const              { return text; }
+
+	/** @brief Returns the source file given in the constructor.
+	           返回构造函数中指定的源文件。
+	*/
+	const char* getSourceFile() const        { return file != nullptr ? file : ""; }
+
+	/** @brief Returns the source line given in the constructor.
+	           返回构造函数中指定的源代码行。
+	*/
+	int getSourceLine() const                { return line; }
+
+	/** @brief Returns the number of placeholders, or -1 if a brace is not matched.
+	           返回占位符的数量，如果有不匹配的花括号则返回-1。
+	*/
+	int getNumPlaceholders() const           { return numPlaceholders; }
+
+	/** @brief Appends one literal part of the text.
+	           追加文本的一个字面部分。
+
+		Part 0 is the text before the first placeholder, part 1 the text after
+		it, and so on. Indexes past the last part append nothing.
+
+		第0部分是第一个占位符之前的文本，第1部分是它之后的文本，依此类推。超出最后一
+		部分的索引不追加任何内容。
+	*/
+	void writeLiteral(ConsoleChunkBuffer &buffer, int index) const
+	{
+		writeLiteral(buffer, literals, literalEnds, index);
+	}
+
+	//==============================================================================
+	/** @brief The id of the first format. The ids below it are kept for the records
+	           that describe a log file itself.
+	           第一个格式的id。比它小的id保留给描述日志文件本身的记录使用。
+	*/
+	enum { firstFormatId = 16 };
+
+	/** @brief Splits a format string into its unescaped literal parts.
+	           将格式字符串拆分为反转义后的各个字面部分。
+
+		@returns The number of placeholders, or -1 if a brace is not matched.
+		@returns 占位符的数量，如果有不匹配的花括号则返回-1。
+	*/
+	static int splitLiterals(const char *formatText, size_t numBytes,
+		juce::MemoryBlock &literalText, juce::Array<int> &partEnds)
+	{
+		literalText.setSize(numBytes);
+		partEnds.clearQuick();
+
+		char *dest = static_cast<char*>(literalText.getData());
+		int length = 0;
+		bool isMatched = true;
+
+		for (size_t i = 0; i < numBytes; ++i)
+		{
+			const char c = formatText[i];
+			const char next = i + 1 < numBytes ? formatText[i + 1] : 0;
+
+			if (c == '{' && next == '}')
+			{
+				partEnds.add(length);
+				++i;
+				continue;
+			}
+
+			if (c == '{' || c == '}')
+			{
+				if (next != c)
+					isMatched = false;
+				else
+					++i;
+			}
+
+			dest[length++] = c;
+		}
+
+		partEnds.add(length);
+		literalText.setSize((size_t)length);
+
+		return isMatched ? partEnds.size() - 1 : -1;
+	}
+
+	/** @brief Appends one literal part of a text split by splitLiterals.
+	           追加由 splitLiterals 拆分的文本的一个字面部分。
+	*/
+	static void writeLiteral(ConsoleChunkBuffer &buffer, const juce::MemoryBlock &literalText,
+		const juce::Array<int> &partEnds, int index)
+	{
+		if (!juce::isPositiveAndBelow(index, partEnds.size()))
+			return;
+
+		const int start = index > 0 ? partEnds.getUnchecked(index - 1) : 0;
+		const int end = partEnds.getUnchecked(index);
+
+		if (end > start)
+			buffer.append(static_cast<const char*>(literalText.getData()) + start, (size_t)(end - start));
+	}
+
+private:
+	//==============================================================================
+	static std::atomic<juce::uint32>& getNextId()
+	{
+		static std::atomic<juce::uint32> nextId { (juce::uint32)firstFormatId };
+		return nextId;
+	}
+
+	//==============================================================================
+	const char *text, *file;
+	const int line;
+	const juce::uint32 id;
+
+	int numPlaceholders;
+	juce::MemoryBlock literals;
+	juce::Array<int> literalEnds;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleLogFormat)
+};
+
+//==============================================================================
+/** @brief Writes a line through a ConsoleLogFormat kept at the call site.
+           通过保存在调用点的 ConsoleLogFormat 写出一行。
+
+	This declares the static ConsoleLogFormat and calls
+	ConsoleOutputStream::log with it, so a call site looks like:
+
+	这会声明静态的 ConsoleLogFormat 并以其调用 ConsoleOutputStream::log，因此
+	调用点看起来像这样：
+
+	@code
+	EZ_CONSOLE_LOG(ezlog, "frame {} took {} ms\n", frameNumber, milliseconds);
+	@endcode
+*/
+#define EZ_CONSOLE_LOG(stream, formatText, ...) \
+	do \
+	{ \
+		static const ConsoleLogFormat ezConsoleLogFormat_(formatText, __FILE__, __LINE__); \
+		(stream).log(ezConsoleLogFormat_, ##__VA_ARGS__); \
+	} while (false)
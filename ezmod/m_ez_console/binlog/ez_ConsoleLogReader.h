@@ -0,0 +1,405 @@
+﻿#pragma once
+#define EZ_CONSOLELOGREADER_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Reads a binary log and renders its lines as text.
+	       读取二进制日志并将其中的行渲染为文本。
+
+	The formats described in the log are collected as they come, and each log
+	line is rendered with ConsoleFormatArgument, so the text is exactly what the
+	stream would have printed in text mode. Logs that were joined together,
+	or written by several streams into one file, are read as one.
+
+	Reading stops at the end of the source or at the first damaged record. A
+	record cut short at the end of the source counts as damaged, so getError
+	tells a clean end from a broken one.
+
+	日志中描述的格式会随读取过程被收集起来，每一行日志都通过 ConsoleFormatArgument
+	渲染，因此得到的文本与输出流在文本模式下输出的完全相同。拼接在一起的日志，或者
+	由多个输出流写入同一个文件的日志，都会被当作一个日志读取。
+
+	读取会在数据源结束或遇到第一条损坏的记录时停止。在数据源末尾被截断的记录也被视
+	为损坏，因此可以通过 getError 区分正常结束和数据损坏。
+
+	@see ConsoleLogRecord, ConsoleOutputStream::setRecordMode
+*/
+class ConsoleLogReader
+{
+public:
+	//==============================================================================
+	/** @brief Creates a reader for a stream, which must outlive the reader.
+	           为一个数据流创建读取器，该数据流的生命周期必须长于读取器。
+	*/
+	explicit ConsoleLogReader(juce::InputStream &sourceStream)
+		: source(sourceStream)
+	{
+	}
+
+	//==============================================================================
+	/** @brief Appends the text of the next log line to a buffer.
+	           将下一行日志的文本追加到缓冲区。
+
+		@returns false at the end of the log, or if a record is damaged.
+		@returns 到达日志末尾或记录损坏时返回false。
+	*/
+	bool readNextLine(ConsoleChunkBuffer &buffer)
+	{
+		juce::uint32 tag;
+
+		while (readRecord(tag))
+		{
+			if (tag == ConsoleLogRecord::startTag)
+			{
+				if (!readStart())
+					return false;
+			}
+			else if (!hasStart)
+			{
+				return fail("this is not a binary log");
+			}
+			else if (tag == ConsoleLogRecord::formatTag)
+			{
+				if (!readFormat())
+					return false;
+			}
+			else if (tag >= ConsoleLogFormat::firstFormatId)
+			{
+				return renderLine(tag, buffer);
+			}
+		}
+
+		return false;
+	}
+
+	/** @brief Writes the text of the next log line to a stream.
+	           将下一行日志的文本写入一个输出流。
+
+		@returns false at the end of the log, or if a record is damaged.
+		@returns 到达日志末尾或记录损坏时返回false。
+	*/
+	bool readNextLine(juce::OutputStream &destination)
+	{
+		const bool lineRead = readNextLine(text);
+
+		for (const ConsoleChunk *c = text.getFirstChunk(); c != nullptr; c = c->next)
+			destination.write(c->data, c->size);
+
+		text.clear();
+		return lineRead;
+	}
+
+	//==============================================================================
+	/** @brief Returns a description of the damage, or an empty string after a clean end.
+	           返回损坏情况的描述，正常结束时返回空字符串。
+	*/
+	const juce::String& getError() const
+	{
+		return error;
+	}
+
+	/** @brief Returns the number of log lines read so far.
+	           返回目前为止读取的日志行数。
+	*/
+	juce::int64 getNumLinesRead() const
+	{
+		return numLinesRead;
+	}
+
+	/** @brief Returns the source file of the line read last.
+	           返回最后读取的一行所在的源文件。
+	*/
+	juce::String getSourceFile() const
+	{
+		return lastFormat != nullptr ? lastFormat->sourceFile : juce::String();
+	}
+
+	/** @brief Returns the source line of the line read last.
+	           返回最后读取的一行所在的源代码行。
+	*/
+	int getSourceLine() const
+	{
+		return lastFormat != nullptr ? lastFormat->sourceLine : 0;
+	}
+
+private:
+	//==============================================================================
+	enum
+	{
+		maxPayloadSize = 1 << 30,
+		maxNumFormats = 1 << 20
+	};
+
+	struct Format
+	{
+		juce::String signature, sourceFile;
+		int sourceLine;
+		juce::MemoryBlock literals;
+		juce::Array<int> literalEnds;
+	};
+
+	//==============================================================================
+	bool readRecord(juce::uint32 &tag)
+	{
+		char header[ConsoleLogRecord::headerSize];
+		const int numRead = source.read(header, sizeof(header));
+
+		if (numRead == 0)
+			return false;
+
+		if (numRead != (int)sizeof(header))
+			return fail("the log ends in the middle of a record");
+
+		tag = ConsoleLogRecord::readUInt32(header);
+		payloadSize = ConsoleLogRecord::readUInt32(header + 4);
+
+		const juce::int64 totalLength = source.getTotalLength();
+
+		if (payloadSize > (size_t)maxPayloadSize)
+			return fail("a record is damaged");
+
+		if (totalLength >= 0 && source.getPosition() + (juce::int64)payloadSize > totalLength)
+			return fail("the log ends in the middle of a record");
+
+		payload.ensureSize(payloadSize);
+
+		if (payloadSize > 0 && source.read(payload.getData(), (int)payloadSize) != (int)payloadSize)
+			return fail("the log ends in the middle of a record");
+
+		return true;
+	}
+
+	bool readStart()
+	{
+		const char *data = static_cast<const char*>(payload.getData());
+
+		if (payloadSize < 8 || memcmp(data, ConsoleLogRecord::getMagic(), 4) != 0)
+			return fail("this is not a binary log");
+
+		if (ConsoleLogRecord::readUInt32(data + 4) > (juce::uint32)ConsoleLogRecord::version)
+			return fail("the log was written by a newer version");
+
+		hasStart = true;
+		return true;
+	}
+
+	bool readFormat()
+	{
+		const char *p = static_cast<const char*>(payload.getData());
+		const char *end = p + payloadSize;
+		const char *signature, *file, *formatText;
+		size_t signatureSize, fileSize, formatSize;
+
+		if (payloadSize < 8)
+			return fail("a format record is damaged");
+
+		const juce::uint32 id = ConsoleLogRecord::readUInt32(p);
+		const juce::uint32 line = ConsoleLogRecord::readUInt32(p + 4);
+		p += 8;
+
+		if (id < (juce::uint32)ConsoleLogFormat::firstFormatId
+			|| id - (juce::uint32)ConsoleLogFormat::firstFormatId >= (juce::uint32)maxNumFormats
+			|| !readString(p, end, signature, signatureSize)
+			|| !readString(p, end, file, fileSize)
+			|| !readString(p, end, formatText, formatSize))
+			return fail("a format record is damaged");
+
+		const int index = (int)(id - ConsoleLogFormat::firstFormatId);
+
+		while (formats.size() <= index)
+			formats.add(nullptr);
+
+		Format *format = new Format();
+		format->signature = juce::String::fromUTF8(signature, (int)signatureSize);
+		format->sourceFile = juce::String::fromUTF8(file, (int)fileSize);
+		format->sourceLine = (int)line;
+		ConsoleLogFormat::splitLiterals(formatText, formatSize, format->literals, format->literalEnds);
+
+		if (lastFormat == formats[index])
+			lastFormat = nullptr;
+
+		formats.set(index, format);
+		return true;
+	}
+
+	bool renderLine(juce::uint32 id, ConsoleChunkBuffer &buffer)
+	{
+		const Format *format = formats[(int)(id - ConsoleLogFormat::firstFormatId)];
+
+		if (format == nullptr)
+			return fail("a line uses format " + juce::String((int)id) + ", which was never described");
+
+		const char *p = static_cast<const char*>(payload.getData());
+		const char *end = p + payloadSize;
+		const char *signature = format->signature.toRawUTF8();
+		const int numArguments = (int)format->signature.getNumBytesAsUTF8();
+
+		for (int i = 0; i < numArguments; ++i)
+		{
+			ConsoleLogFormat::writeLiteral(buffer, format->literals, format->literalEnds, i);
+
+			if (!renderArgument(buffer, signature[i], p, end))
+				return fail("a line of format " + juce::String((int)id) + " is damaged");
+		}
+
+		ConsoleLogFormat::writeLiteral(buffer, format->literals, format->literalEnds, numArguments);
+
+		lastFormat = format;
+		++numLinesRead;
+		return true;
+	}
+
+	//==============================================================================
+	static bool renderArgument(ConsoleChunkBuffer &buffer, char typeCode, const char *&p, const char *end)
+	{
+		const size_t remaining = (size_t)(end - p);
+		const char *data = p;
+
+		switch (typeCode)
+		{
+			case 'b':
+				if (remaining < 1) return false;
+				ConsoleFormatArgument<bool>::write(buffer, *p++ != 0);
+				return true;
+
+			case 'c':
+				if (remaining < 1) return false;
+				ConsoleFormatArgument<char>::write(buffer, *p++);
+				return true;
+
+			case 'i':
+				if (remaining < 4) return false;
+				ConsoleFormatArgument<juce::int32>::write(buffer, (juce::int32)ConsoleLogRecord::readUInt32(data));
+				p += 4;
+				return true;
+
+			case 'u':
+				if (remaining < 4) return false;
+				ConsoleFormatArgument<juce::uint32>::write(buffer, ConsoleLogRecord::readUInt32(data));
+				p += 4;
+				return true;
+
+			case 'I':
+				if (remaining < 8) return false;
+				ConsoleFormatArgument<juce::int64>::write(buffer, (juce::int64)ConsoleLogRecord::readUInt64(data));
+				p += 8;
+				return true;
+
+			case 'U':
+				if (remaining < 8) return false;
+				ConsoleFormatArgument<juce::uint64>::write(buffer, ConsoleLogRecord::readUInt64(data));
+				p += 8;
+				return true;
+
+			case 'f':
+			{
+				if (remaining < 4) return false;
+				const juce::uint32 bits = ConsoleLogRecord::readUInt32(data);
+				float value;
+				memcpy(&value, &bits, 4);
+				ConsoleFormatArgument<float>::write(buffer, value);
+				p += 4;
+				return true;
+			}
+
+			case 'd':
+			{
+				if (remaining < 8) return false;
+				ConsoleFormatArgument<double>::write(buffer, readDouble(data));
+				p += 8;
+				return true;
+			}
+
+			case 's':
+			{
+				const char *text;
+				size_t numBytes;
+
+				if (!readString(p, end, text, numBytes))
+					return false;
+
+				buffer.append(text, numBytes);
+				return true;
+			}
+
+			case 't':
+				if (remaining < 8) return false;
+				ConsoleFormatArgument<juce::Time>::write(buffer, juce::Time((juce::int64)ConsoleLogRecord::readUInt64(data)));
+				p += 8;
+				return true;
+
+			case 'x':
+			{
+				if (remaining < 10) return false;
+				const ConsoleNumberFormat::Hex number = { ConsoleLogRecord::readUInt64(data), (int)data[8], data[9] != 0 };
+				ConsoleFormatArgument<ConsoleNumberFormat::Hex>::write(buffer, number);
+				p += 10;
+				return true;
+			}
+
+			case 'F':
+			{
+				if (remaining < 9) return false;
+				const ConsoleNumberFormat::Fixed number = { readDouble(data), (int)data[8] };
+				ConsoleFormatArgument<ConsoleNumberFormat::Fixed>::write(buffer, number);
+				p += 9;
+				return true;
+			}
+
+			case 'v':
+				if (remaining < 1 || *p == 'v')
+					return false;
+
+				++p;
+				return renderArgument(buffer, *data, p, end);
+
+			default:
+				return false;
+		}
+	}
+
+	static double readDouble(const char *data)
+	{
+		const juce::uint64 bits = ConsoleLogRecord::readUInt64(data);
+		double value;
+		memcpy(&value, &bits, 8);
+		return value;
+	}
+
+	static bool readString(const char *&p, const char *end, const char *&text, size_t &numBytes)
+	{
+		if (end - p < 4)
+			return false;
+
+		numBytes = ConsoleLogRecord::readUInt32(p);
+
+		if ((size_t)(end - p - 4) < numBytes)
+			return false;
+
+		text = p + 4;
+		p += 4 + numBytes;
+		return true;
+	}
+
+	bool fail(const juce::String &description)
+	{
+		error = description;
+		return false;
+	}
+
+	//==============================================================================
+	juce::InputStream &source;
+	juce::MemoryBlock payload;
+	size_t payloadSize = 0;
+	bool hasStart = false;
+
+	juce::OwnedArray<Format> formats;
+	const Format *lastFormat = nullptr;
+	ConsoleChunkBuffer text;
+
+	juce::String error;
+	juce::int64 numLinesRead = 0;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleLogReader)
+};
@@ -0,0 +1,485 @@
+﻿#pragma once
+#define EZ_CONSOLELOGRECORD_H_INCLUDED
+
+template <typename Type> struct ConsoleLogArgument;
+
+//==============================================================================
+/**
+
+    @brief Writes the records of a binary log.
+	       写出二进制日志的记录。
+
+	A binary log is a sequence of records. Each record starts with two
+	little-endian 32-bit values: a tag and the size of the payload that follows.
+
+	- Tag 0 starts a log. Its payload is the magic "EZLG" and the version.
+	- Tag 1 describes a format. Its payload is the format id, the source line,
+	  then the argument signature, the source file and the format string, each
+	  as a 32-bit length followed by the bytes.
+	- Any tag from ConsoleLogFormat::firstFormatId up is a log line: the tag is
+	  the format id and the payload holds the arguments, each encoded as its
+	  ConsoleLogArgument describes, in the order of the signature.
+
+	A stream writes the start record when record mode is switched on and
+	describes each format before its first line, so a log can be read on its own
+	and several logs can simply be joined together.
+
+	二进制日志是一个记录序列。每条记录以两个小端序的32位数值开头：一个标签和其后
+	负载的大小。
+
+	- 标签0表示日志的开始。其负载为魔数"EZLG"和版本号。
+	- 标签1描述一个格式。其负载为格式id、源代码行，然后依次是参数签名、源文件和格式
+	  字符串，每一项都以一个32位长度加上其字节表示。
+	- 从 ConsoleLogFormat::firstFormatId 开始的任何标签都是一行日志：标签即格式id，
+	  负载中按签名的顺序保存着各个参数，每个参数按其 ConsoleLogArgument 的描述编码。
+
+	输出流在开启记录模式时写出开始记录，并在每个格式的第一行之前对其进行描述，因此
+	一个日志可以被单独读取，多个日志也可以直接拼接在一起。
+
+	@see ConsoleLogReader
+*/
+class ConsoleLogRecord
+{
+public:
+	//==============================================================================
+	enum
+	{
+		startTag = 0,      /**< The tag of the record that starts a log.
+		                        日志开始记录的标签。 */
+		formatTag = 1,     /**< The tag of a record that describes a format.
+		                        描述格式的记录的标签。 */
+		headerSize = 8,    /**< The size of the tag and the payload size.
+		                        标签和负载大小所占的字节数。 */
+		version = 1        /**< The version written into the start record.
+		                        写入开始记录的版本号。 */
+	};
+
+	/** @brief Returns the four bytes that the start record begins with.
+	           返回开始记录起始处的四个字节。
+	*/
+	static const char* getMagic()
+	{
+		return "EZLG";
+	}
+
+	//==============================================================================
+	/** @brief Appends the record that starts a log.
+	           追加日志的开始记录。
+	*/
+	static void writeStart(ConsoleChunkBuffer &buffer)
+	{
+		char *dest = buffer.prepareWrite(headerSize + 8);
+
+		writeUInt32(dest, startTag);
+		writeUInt32(dest, 8);
+		memcpy(dest, getMagic(), 4);
+		dest += 4;
+		writeUInt32(dest, version);
+
+		buffer.commitWrite(headerSize + 8);
+	}
+
+	/** @brief Appends the record that describes a format.
+	           追加描述一个格式的记录。
+
+		@param signature  The argument type codes, one character per argument.
+		                  参数的类型代码，每个参数一个字符。
+	*/
+	static void writeFormat(ConsoleChunkBuffer &buffer, const ConsoleLogFormat &format, const char *signature)
+	{
+		const char *strings[] = { signature, format.getSourceFile(), format.getText() };
+		size_t lengths[3], payloadSize = 8;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			lengths[i] = strlen(strings[i]);
+			payloadSize += 4 + lengths[i];
+		}
+
+		char header[headerSize + 8];
+		char *dest = header;
+
+		writeUInt32(dest, formatTag);
+		writeUInt32(dest, (juce::uint32)payloadSize);
+		writeUInt32(dest, format.getId());
+		writeUInt32(dest, (juce::uint32)format.getSourceLine());
+		buffer.append(header, sizeof(header));
+
+		for (int i = 0; i < 3; ++i)
+		{
+			dest = header;
+			writeUInt32(dest, (juce::uint32)lengths[i]);
+			buffer.append(header, 4);
+			buffer.append(strings[i], lengths[i]);
+		}
+	}
+
+	/** @brief Appends a log line: the format id and the raw arguments.
+	           追加一行日志：格式id和原始参数。
+
+		Records that fit in a chunk are encoded in place. Larger ones, which
+		can only come from long strings, are encoded into a temporary block.
+
+		能放入一个内存块的记录直接在缓冲区中编码。更大的记录只可能来自很长的字符串，
+		它们先被编码到一个临时内存块中。
+	*/
+	template <typename... Args>
+	static void writeLine(ConsoleChunkBuffer &buffer, juce::uint32 formatId, const Args&... args)
+	{
+		const size_t argumentSizes[] = { 0, ConsoleLogArgument<Args>::getSize(args)... };
+		size_t payloadSize = 0;
+
+		for (size_t size : argumentSizes)
+			payloadSize += size;
+
+		const size_t recordSize = headerSize + payloadSize;
+
+		if (recordSize <= (size_t)ConsoleChunk::capacity)
+		{
+			encodeLine(buffer.prepareWrite(recordSize), formatId, payloadSize, args...);
+			buffer.commitWrite(recordSize);
+		}
+		else
+		{
+			juce::HeapBlock<char> record(recordSize);
+			encodeLine(record, formatId, payloadSize, args...);
+			buffer.append(record, recordSize);
+		}
+	}
+
+	//==============================================================================
+	static void writeUInt32(char *&dest, juce::uint32 value)
+	{
+		value = juce::ByteOrder::swapIfBigEndian(value);
+		memcpy(dest, &value, 4);
+		dest += 4;
+	}
+
+	static void writeUInt64(char *&dest, juce::uint64 value)
+	{
+		value = juce::ByteOrder::swapIfBigEndian(value);
+		memcpy(dest, &value, 8);
+		dest += 8;
+	}
+
+	static void writeString(char *&dest, const char *text, size_t numBytes)
+	{
+		writeUInt32(dest, (juce::uint32)numBytes);
+		memcpy(dest, text, numBytes);
+		dest += numBytes;
+	}
+
+	static juce::uint32 readUInt32(const char *source)
+	{
+		return juce::ByteOrder::littleEndianInt(source);
+	}
+
+	static juce::uint64 readUInt64(const char *source)
+	{
+		return (juce::uint64)juce::ByteOrder::littleEndianInt64(source);
+	}
+
+private:
+	//==============================================================================
+	template <typename... Args>
+	static void encodeLine(char *dest, juce::uint32 formatId, size_t payloadSize, const Args&... args)
+	{
+		writeUInt32(dest, formatId);
+		writeUInt32(dest, (juce::uint32)payloadSize);
+
+		using Expander = int[];
+		(void)Expander { 0, (ConsoleLogArgument<Args>::encode(dest, args), 0)... };
+	}
+};
+
+//==============================================================================
+/**
+
+    @brief Encodes one argument of a log line.
+	       编码一行日志中的一个参数。
+
+	Each supported type has a one-character code that goes into the signature
+	of the format, and is stored as:
+
+	- 'b' bool and 'c' char as one byte.
+	- 'i' and 'u' for integers of up to 32 bits, 'I' and 'U' for 64-bit ones,
+	  in the size of the code.
+	- 'f' float and 'd' double as their IEEE bits.
+	- 's' strings of any kind as a 32-bit length and the UTF-8 bytes.
+	- 't' juce::Time as 64-bit milliseconds.
+	- 'x' ConsoleNumberFormat::Hex as the 64-bit value, the number of digits
+	  and the case, and 'F' ConsoleNumberFormat::Fixed as the double and the
+	  number of decimal places.
+	- 'v' juce::var as one of the codes 'I', 'd', 'b' or 's', then that value.
+
+	All multi-byte values are little-endian. Wide strings are not supported,
+	because their UTF-8 size is not known without converting them twice.
+
+	每种支持的类型都有一个单字符代码，记入格式的签名中，其存储方式为：
+
+	- 'b' bool 和 'c' char 占一个字节。
+	- 'i'和'u'表示最多32位的整数，'I'和'U'表示64位整数，按代码对应的大小存储。
+	- 'f' float 和 'd' double 存储其IEEE位模式。
+	- 's' 各种字符串存储为一个32位长度加上UTF-8字节。
+	- 't' juce::Time 存储为64位的毫秒数。
+	- 'x' ConsoleNumberFormat::Hex 存储64位数值、位数和大小写，'F'
+	  ConsoleNumberFormat::Fixed 存储double数值和小数位数。
+	- 'v' juce::var 先存储'I'、'd'、'b'或's'之一的代码，再存储对应的值。
+
+	所有多字节数值都是小端序。不支持宽字符串，因为不转换两次就无法得知其UTF-8大小。
+*/
+template <typename Type>
+struct ConsoleLogArgument
+{
+	static constexpr bool isSupported = std::is_integral<Type>::value;
+
+	typedef typename std::conditional<std::is_signed<Type>::value,
+		typename std::conditional<(sizeof(Type) > 4), juce::int64, juce::int32>::type,
+		typename std::conditional<(sizeof(Type) > 4), juce::uint64, juce::uint32>::type>::type StoredType;
+
+	static constexpr char typeCode = std::is_signed<Type>::value ? (sizeof(Type) > 4 ? 'I' : 'i')
+	                                                             : (sizeof(Type) > 4 ? 'U' : 'u');
+
+	static size_t getSize(Type)
+	{
+		return sizeof(StoredType);
+	}
+
+	static void encode(char *&dest, Type value)
+	{
+		if (sizeof(StoredType) == 8)
+			ConsoleLogRecord::writeUInt64(dest, (juce::uint64)(StoredType)value);
+		else
+			ConsoleLogRecord::writeUInt32(dest, (juce::uint32)(StoredType)value);
+	}
+};
+
+template <>
+struct ConsoleLogArgument<bool>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 'b';
+
+	static size_t getSize(bool)                      { return 1; }
+	static void encode(char *&dest, bool value)      { *dest++ = value ? 1 : 0; }
+};
+
+template <>
+struct ConsoleLogArgument<char>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 'c';
+
+	static size_t getSize(char)                      { return 1; }
+	static void encode(char *&dest, char value)      { *dest++ = value; }
+};
+
+template <>
+struct ConsoleLogArgument<float>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 'f';
+
+	static size_t getSize(float)                     { return 4; }
+
+	static void encode(char *&dest, float value)
+	{
+		juce::uint32 bits;
+		memcpy(&bits, &value, 4);
+		ConsoleLogRecord::writeUInt32(dest, bits);
+	}
+};
+
+template <>
+struct ConsoleLogArgument<double>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 'd';
+
+	static size_t getSize(double)                    { return 8; }
+
+	static void encode(char *&dest, double value)
+	{
+		juce::uint64 bits;
+		memcpy(&bits, &value, 8);
+		ConsoleLogRecord::writeUInt64(dest, bits);
+	}
+};
+
+template <>
+struct ConsoleLogArgument<long double> : public ConsoleLogArgument<double> {};
+
+template <>
+struct ConsoleLogArgument<const char*>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 's';
+
+	static size_t getSize(const char *text)
+	{
+		return 4 + (text != nullptr ? strlen(text) : 0);
+	}
+
+	static void encode(char *&dest, const char *text)
+	{
+		ConsoleLogRecord::writeString(dest, text, text != nullptr ? strlen(text) : 0);
+	}
+};
+
+template <>
+struct ConsoleLogArgument<char*> : public ConsoleLogArgument<const char*> {};
+
+template <size_t size>
+struct ConsoleLogArgument<char[size]> : public ConsoleLogArgument<const char*> {};
+
+template <>
+struct ConsoleLogArgument<juce::String>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 's';
+
+	static size_t getSize(const juce::String &text)
+	{
+		return 4 + text.getNumBytesAsUTF8();
+	}
+
+	static void encode(char *&dest, const juce::String &text)
+	{
+		ConsoleLogRecord::writeString(dest, text.toRawUTF8(), text.getNumBytesAsUTF8());
+	}
+};
+
+template <>
+struct ConsoleLogArgument<juce::StringRef>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 's';
+
+	static size_t getSize(const juce::StringRef &text)
+	{
+		return 3 + text.text.sizeInBytes();
+	}
+
+	static void encode(char *&dest, const juce::StringRef &text)
+	{
+		ConsoleLogRecord::writeString(dest, text.text.getAddress(), text.text.sizeInBytes() - 1);
+	}
+};
+
+template <>
+struct ConsoleLogArgument<juce::File>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 's';
+
+	static size_t getSize(const juce::File &file)
+	{
+		return ConsoleLogArgument<juce::String>::getSize(file.getFullPathName());
+	}
+
+	static void encode(char *&dest, const juce::File &file)
+	{
+		ConsoleLogArgument<juce::String>::encode(dest, file.getFullPathName());
+	}
+};
+
+template <>
+struct ConsoleLogArgument<juce::Time>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 't';
+
+	static size_t getSize(const juce::Time&)         { return 8; }
+
+	static void encode(char *&dest, const juce::Time &time)
+	{
+		ConsoleLogRecord::writeUInt64(dest, (juce::uint64)time.toMilliseconds());
+	}
+};
+
+template <>
+struct ConsoleLogArgument<ConsoleNumberFormat::Hex>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 'x';
+
+	static size_t getSize(const ConsoleNumberFormat::Hex&)   { return 10; }
+
+	static void encode(char *&dest, const ConsoleNumberFormat::Hex &number)
+	{
+		ConsoleLogRecord::writeUInt64(dest, number.value);
+		*dest++ = (char)juce::jlimit(0, 127, number.minNumDigits);
+		*dest++ = number.upperCase ? 1 : 0;
+	}
+};
+
+template <>
+struct ConsoleLogArgument<ConsoleNumberFormat::Fixed>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 'F';
+
+	static size_t getSize(const ConsoleNumberFormat::Fixed&) { return 9; }
+
+	static void encode(char *&dest, const ConsoleNumberFormat::Fixed &number)
+	{
+		ConsoleLogArgument<double>::encode(dest, number.value);
+		*dest++ = (char)juce::jlimit(0, 127, number.numDecimalPlaces);
+	}
+};
+
+template <>
+struct ConsoleLogArgument<juce::var>
+{
+	static constexpr bool isSupported = true;
+	static constexpr char typeCode = 'v';
+
+	static size_t getSize(const juce::var &value)
+	{
+		if (value.isInt() || value.isInt64() || value.isDouble())
+			return 9;
+
+		if (value.isBool())
+			return 2;
+
+		return 1 + ConsoleLogArgument<juce::String>::getSize(value.toString());
+	}
+
+	static void encode(char *&dest, const juce::var &value)
+	{
+		if (value.isInt() || value.isInt64())
+		{
+			*dest++ = 'I';
+			ConsoleLogRecord::writeUInt64(dest, (juce::uint64)(juce::int64)value);
+		}
+		else if (value.isDouble())
+		{
+			*dest++ = 'd';
+			ConsoleLogArgument<double>::encode(dest, (double)value);
+		}
+		else if (value.isBool())
+		{
+			*dest++ = 'b';
+			ConsoleLogArgument<bool>::encode(dest, (bool)value);
+		}
+		else
+		{
+			*dest++ = 's';
+			ConsoleLogArgument<juce::String>::encode(dest, value.toString());
+		}
+	}
+};
+
+//==============================================================================
+/** @brief The signature of a format: one type code per argument.
+           格式的签名：每个参数一个类型代码。
+*/
+template <typename... Args>
+struct ConsoleLogSignature
+{
+	static const char* get()
+	{
+		static const char codes[] = { ConsoleLogArgument<Args>::typeCode..., 0 };
+		return codes;
+	}
+};
@@ -0,0 +1,552 @@
+﻿#pragma once
+#define EZ_CONSOLECHUNKBUFFER_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A fixed-size block of memory used to hold console output.
+	       用于保存控制台输出数据的固定大小内存块。
+
+	Chunks are linked into singly linked lists through "next". A list of chunks
+	is how buffered data is passed from a stream to a sink without copying.
+
+	内存块通过"next"连接成单向链表。输出流正是以内存块链表的形式将缓冲的数据
+	无拷贝地交给 Sink。
+
+	@see ConsoleChunkPool, ConsoleChunkBuffer
+*/
+struct ConsoleChunk
+{
+	enum
+	{
+		capacity = 16384 - 2 * sizeof(void*) /**< The number of bytes a chunk can hold.
+		                                          一个内存块能容纳的字节数。 */
+	};
+
+	ConsoleChunk *next;
+	size_t size;
+	char data[capacity];
+
+	//==============================================================================
+	/** @brief Returns the number of bytes held by a whole list of chunks.
+	           返回整个内存块链表中保存的字节数。
+	*/
+	static size_t getTotalSize(const ConsoleChunk *firstChunk)
+	{
+		size_t total = 0;
+
+		for (const ConsoleChunk *c = firstChunk; c != nullptr; c = c->next)
+			total += c->size;
+
+		return total;
+	}
+};
+
+//==============================================================================
+/**
+
+    @brief A process-wide pool that recycles ConsoleChunk objects.
+	       进程范围内回收利用 ConsoleChunk 对象的缓冲池。
+
+	Released chunks are kept on a lock-free free list and handed out again, so a
+	stream that keeps printing does not go back to the heap. The number of idle
+	chunks kept is capped, any chunk released beyond that is deleted.
+
+	被释放的内存块保存在一个无锁的空闲链表中并被再次分配，因此持续输出的输出流不
+	需要反复向堆申请内存。保留的空闲内存块数量有上限，超出上限后释放的内存块会被
+	直接删除。
+
+*/
+class ConsoleChunkPool
+{
+public:
+	//==============================================================================
+	/** @brief Returns the shared pool.
+	           返回共享的缓冲池。
+	*/
+	static ConsoleChunkPool& getInstance()
+	{
+		static ConsoleChunkPool pool;
+		return pool;
+	}
+
+	/** @brief Destructor. Deletes all the idle chunks.
+	           析构函数。删除所有空闲的内存块。
+	*/
+	~ConsoleChunkPool()
+	{
+		ConsoleChunk *chunk;
+
+		while (idleChunks.pop(chunk))
+			delete chunk;
+	}
+
+	//==============================================================================
+	/** @brief Returns an empty chunk, taken from the pool if possible.
+	           返回一个空的内存块，尽可能从缓冲池中获取。
+	*/
+	ConsoleChunk* allocate()
+	{
+		ConsoleChunk *chunk;
+
+		if (!idleChunks.pop(chunk))
+			chunk = new ConsoleChunk();
+
+		chunk->next = nullptr;
+		chunk->size = 0;
+		return chunk;
+	}
+
+	/** @brief Gives a whole list of chunks back to the pool.
+	           将整个内存块链表归还给缓冲池。
+	*/
+	void releaseList(ConsoleChunk *firstChunk)
+	{
+		while (firstChunk != nullptr)
+		{
+			ConsoleChunk *next = firstChunk->next;
+
+			if (!idleChunks.push(firstChunk))
+				delete firstChunk;
+
+			firstChunk = next;
+		}
+	}
+
+	/** @brief Copies a block of data into a new list of chunks.
+	           将一块数据拷贝到一个新的内存块链表中。
+	*/
+	ConsoleChunk* copyToChunks(const void *data, size_t numBytes)
+	{
+		const char *source = static_cast<const char*>(data);
+		ConsoleChunk *first = nullptr, *last = nullptr;
+
+		do
+		{
+			ConsoleChunk *chunk = allocate();
+			chunk->size = juce::jmin(numBytes, (size_t)ConsoleChunk::capacity);
+			memcpy(chunk->data, source, chunk->size);
+
+			if (last != nullptr)
+				last->next = chunk;
+			else
+				first = chunk;
+
+			last = chunk;
+			source += chunk->size;
+			numBytes -= chunk->size;
+		}
+		while (numBytes > 0);
+
+		return first;
+	}
+
+	//==============================================================================
+	/** @brief The maximum number of idle chunks kept by the pool.
+	           缓冲池保留的空闲内存块的最大数量。
+	*/
+	enum
+	{
+		maxIdleChunks = 256
+	};
+
+private:
+	//==============================================================================
+	ConsoleChunkPool()
+		: idleChunks(maxIdleChunks)
+	{
+	}
+
+	LockFreeQueue<ConsoleChunk*> idleChunks;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleChunkPool)
+};
+
+//==============================================================================
+/**
+
+    @brief A growable buffer made of a list of fixed-size chunks.
+	       由固定大小内存块链表构成的可增长缓冲区。
+
+	Appending never moves data that is already in the buffer: when the last chunk
+	is full, a new one is taken from the ConsoleChunkPool and linked to the end.
+	So the cost of an append stays the same however much has been buffered.
+
+	Formatting code that needs a contiguous area can ask for one with
+	"prepareWrite", write into it, and then "commitWrite" what it used.
+
+	追加数据时永远不会移动缓冲区中已有的数据：当最后一个内存块写满时，会从
+	ConsoleChunkPool 中取出一个新的内存块链接到末尾。因此无论已缓冲了多少数据，
+	追加操作的开销都保持不变。
+
+	需要连续内存区域的格式化代码可以通过"prepareWrite"申请一块区域，写入后再通过
+	"commitWrite"提交实际使用的字节数。
+
+*/
+class ConsoleChunkBuffer
+{
+public:
+	//==============================================================================
+	/** @brief Creates an empty buffer.
+	           创建一个空的缓冲区。
+	*/
+	ConsoleChunkBuffer()
+		: pool(ConsoleChunkPool::getInstance())
+	{
+	}
+
+	/** @brief Destructor. Gives all the chunks back to the pool.
+	           析构函数。将所有内存块归还给缓冲池。
+	*/
+	~ConsoleChunkBuffer()
+	{
+		clear();
+	}
+
+	//==============================================================================
+	/** @brief Appends a copy of a block of data.
+	           追加一块数据的拷贝。
+	*/
+	void append(const void *data, size_t numBytes)
+	{
+		const ScopedModification sm(*this);
+		const char *source = static_cast<const char*>(data);
+
+		while (numBytes > 0)
+		{
+			if (lastChunk == nullptr || lastChunk->size == ConsoleChunk::capacity)
+				addChunk();
+
+			const size_t numToCopy = juce::jmin(numBytes, (size_t)ConsoleChunk::capacity - lastChunk->size);
+			memcpy(lastChunk->data + lastChunk->size, source, numToCopy);
+
+			lastChunk->size += numToCopy;
+			totalSize += numToCopy;
+			source += numToCopy;
+			numBytes -= numToCopy;
+		}
+	}
+
+	/** @brief Appends a byte repeated a number of times.
+	           追加若干个重复的字节。
+	*/
+	void appendRepeated(juce::uint8 byte, size_t numTimes)
+	{
+		const ScopedModification sm(*this);
+
+		while (numTimes > 0)
+		{
+			if (lastChunk == nullptr || lastChunk->size == ConsoleChunk::capacity)
+				addChunk();
+
+			const size_t numToSet = juce::jmin(numTimes, (size_t)ConsoleChunk::capacity - lastChunk->size);
+			memset(lastChunk->data + lastChunk->size, byte, numToSet);
+
+			lastChunk->size += numToSet;
+			totalSize += numToSet;
+			numTimes -= numToSet;
+		}
+	}
+
+	/** @brief Returns a contiguous area of at least the given size at the end of the buffer.
+	           返回缓冲区末尾一块至少为指定大小的连续区域。
+
+		Nothing is added to the buffer until "commitWrite" is called.
+
+		在调用"commitWrite"之前，缓冲区的内容不会改变。
+
+		@param numBytes  The size needed, which must not be more than
+		                 ConsoleChunk::capacity.
+		                 需要的大小，不能超过ConsoleChunk::capacity。
+
+		@see commitWrite
+	*/
+	char* prepareWrite(size_t numBytes)
+	{
+		jassert(numBytes <= (size_t)ConsoleChunk::capacity);
+
+		if (lastChunk == nullptr || (size_t)ConsoleChunk::capacity - lastChunk->size < numBytes)
+		{
+			const ScopedModification sm(*this);
+			addChunk();
+		}
+
+		return lastChunk->data + lastChunk->size;
+	}
+
+	/** @brief Adds the bytes written into the area returned by "prepareWrite".
+	           提交写入"prepareWrite"所返回区域中的字节。
+	*/
+	void commitWrite(size_t numBytes)
+	{
+		jassert(lastChunk != nullptr && lastChunk->size + numBytes <= (size_t)ConsoleChunk::capacity);
+
+		const ScopedModification sm(*this);
+		lastChunk->size += numBytes;
+		totalSize += numBytes;
+	}
+
+	//==============================================================================
+	/** @brief Returns the number of bytes in the buffer.
+	           返回缓冲区中的字节数。
+	*/
+	size_t getTotalSize() const
+	{
+		return totalSize;
+	}
+
+	/** @brief Returns the first chunk of the buffer, or nullptr if it is empty.
+	           返回缓冲区的第一个内存块，缓冲区为空时返回nullptr。
+	*/
+	const ConsoleChunk* getFirstChunk() const
+	{
+		return firstChunk;
+	}
+
+	/** @brief Copies the whole content of the buffer to a block of memory.
+	           将缓冲区的全部内容拷贝到一块内存中。
+	*/
+	void copyTo(void *destination) const
+	{
+		char *dest = static_cast<char*>(destination);
+
+		for (const ConsoleChunk *c = firstChunk; c != nullptr; c = c->next)
+		{
+			memcpy(dest, c->data, c->size);
+			dest += c->size;
+		}
+	}
+
+	/** @brief Looks for the last occurrence of a byte in the buffer.
+	           查找某个字节在缓冲区中最后一次出现的位置。
+
+		@returns true if it was found, in which case its position is put in
+		         "index".
+		@returns 找到时返回true，并将其位置存入"index"。
+	*/
+	bool findLast(char byte, size_t &index) const
+	{
+		if (lastChunk == nullptr)
+			return false;
+
+		for (size_t i = lastChunk->size; i > 0; --i)
+		{
+			if (lastChunk->data[i - 1] == byte)
+			{
+				index = totalSize - lastChunk->size + i - 1;
+				return true;
+			}
+		}
+
+		bool found = false;
+		size_t chunkStart = 0;
+
+		for (const ConsoleChunk *c = firstChunk; c != lastChunk; c = c->next)
+		{
+			for (size_t i = c->size; i > 0; --i)
+			{
+				if (c->data[i - 1] == byte)
+				{
+					index = chunkStart + i - 1;
+					found = true;
+					break;
+				}
+			}
+
+			chunkStart += c->size;
+		}
+
+		return found;
+	}
+
+	/** @brief Copies part of the buffer while another thread may be changing it.
+	           在另一个线程可能正在修改缓冲区时，拷贝其中的一部分。
+
+		This takes no lock and allocates nothing, so it can be called from a
+		signal handler. Every change to the buffer moves a counter, which is
+		checked before and after the copy: if the buffer was changed in
+		between, or is being changed right now, the copy is not to be trusted.
+
+		该方法不加锁也不分配内存，因此可以在信号处理函数中调用。每次修改缓冲区都会
+		改变一个计数器，拷贝前后都会检查该计数器：如果缓冲区在此期间被修改过，或者正在
+		被修改，拷贝的结果便不可信。
+
+		@param offset     Where to start in the buffer.
+		                  在缓冲区中开始拷贝的位置。
+
+		@param numCopied  Set to the number of bytes copied, which is 0 past the
+		                  end of the buffer.
+		                  被设置为拷贝的字节数，超出缓冲区末尾时为0。
+
+		@returns true if the copy matches the buffer, false if it was changed.
+		@returns 拷贝结果与缓冲区一致时返回true，缓冲区被修改过时返回false。
+
+		@see ConsoleCrashHandler
+	*/
+	bool copyWhileChanging(size_t offset, void *destination, size_t maxBytes, size_t &numCopied) const
+	{
+		const juce::uint32 countBefore = modificationCount.load(std::memory_order_acquire);
+		char *dest = static_cast<char*>(destination);
+		size_t chunkStart = 0;
+		int numChunksLeft = maxChunksToCopyWhileChanging;
+
+		numCopied = 0;
+
+		if ((countBefore & 1) != 0)
+			return false;
+
+		// A chunk that was taken out meanwhile may already belong to another
+		// buffer, so its size is checked and the walk is bounded.
+		for (const ConsoleChunk *c = firstChunk; c != nullptr && numCopied < maxBytes; c = c->next)
+		{
+			const size_t size = c->size;
+
+			if (size > (size_t)ConsoleChunk::capacity || --numChunksLeft < 0)
+				return false;
+
+			if (chunkStart + size > offset)
+			{
+				const size_t start = offset > chunkStart ? offset - chunkStart : 0;
+				const size_t numToCopy = juce::jmin(size - start, maxBytes - numCopied);
+
+				memcpy(dest + numCopied, c->data + start, numToCopy);
+				numCopied += numToCopy;
+			}
+
+			chunkStart += size;
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return modificationCount.load(std::memory_order_relaxed) == countBefore;
+	}
+
+	//==============================================================================
+	/** @brief Takes all the chunks out of the buffer, leaving it empty.
+	           将所有内存块从缓冲区中取出，使其变为空。
+
+		The caller becomes the owner of the returned list, and must give it
+		back to the ConsoleChunkPool when done with it.
+
+		调用者成为返回链表的所有者，使用完毕后必须将其归还给 ConsoleChunkPool。
+	*/
+	ConsoleChunk* detachChunks()
+	{
+		const ScopedModification sm(*this);
+		ConsoleChunk *first = firstChunk;
+
+		firstChunk = lastChunk = nullptr;
+		totalSize = 0;
+
+		return first;
+	}
+
+	/** @brief Takes the first bytes out of the buffer as a separate list of chunks.
+	           将缓冲区开头的若干字节作为一个独立的内存块链表取出。
+
+		Whole chunks are moved without copying, only the chunk where the split
+		falls is copied in part.
+
+		完整的内存块会被直接移走而不拷贝，只有分割点所在的内存块会被部分拷贝。
+
+		@see detachChunks
+	*/
+	ConsoleChunk* detachFront(size_t numBytes)
+	{
+		jassert(numBytes <= totalSize);
+
+		if (numBytes == totalSize)
+			return detachChunks();
+
+		const ScopedModification sm(*this);
+		ConsoleChunk *first = nullptr, *last = nullptr;
+		totalSize -= numBytes;
+
+		while (numBytes > 0 && firstChunk->size <= numBytes)
+		{
+			ConsoleChunk *chunk = firstChunk;
+			firstChunk = chunk->next;
+			numBytes -= chunk->size;
+
+			chunk->next = nullptr;
+
+			if (last != nullptr)
+				last->next = chunk;
+			else
+				first = chunk;
+
+			last = chunk;
+		}
+
+		if (numBytes > 0)
+		{
+			ConsoleChunk *part = pool.allocate();
+			memcpy(part->data, firstChunk->data, numBytes);
+			part->size = numBytes;
+
+			memmove(firstChunk->data, firstChunk->data + numBytes, firstChunk->size - numBytes);
+			firstChunk->size -= numBytes;
+
+			if (last != nullptr)
+				last->next = part;
+			else
+				first = part;
+		}
+
+		return first;
+	}
+
+	/** @brief Gives all the chunks back to the pool, leaving the buffer empty.
+	           将所有内存块归还给缓冲池，使缓冲区变为空。
+	*/
+	void clear()
+	{
+		pool.releaseList(detachChunks());
+	}
+
+private:
+	//==============================================================================
+	enum
+	{
+		maxChunksToCopyWhileChanging = 1 << 20
+	};
+
+	// The counter is odd while the buffer is being changed. Only the thread
+	// that owns the buffer writes it, so plain stores are enough.
+	struct ScopedModification
+	{
+		explicit ScopedModification(ConsoleChunkBuffer &b)
+			: buffer(b), count(b.modificationCount.load(std::memory_order_relaxed))
+		{
+			buffer.modificationCount.store(count + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		~ScopedModification()
+		{
+			buffer.modificationCount.store(count + 2, std::memory_order_release);
+		}
+
+		ConsoleChunkBuffer &buffer;
+		const juce::uint32 count;
+	};
+
+	void addChunk()
+	{
+		ConsoleChunk *chunk = pool.allocate();
+
+		if (lastChunk != nullptr)
+			lastChunk->next = chunk;
+		else
+			firstChunk = chunk;
+
+		lastChunk = chunk;
+	}
+
+	//==============================================================================
+	ConsoleChunkPool &pool;
+	ConsoleChunk *firstChunk = nullptr, *lastChunk = nullptr;
+	size_t totalSize = 0;
+	std::atomic<juce::uint32> modificationCount { 0 };
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleChunkBuffer)
+};
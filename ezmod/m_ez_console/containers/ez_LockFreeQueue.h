@@ -0,0 +1,155 @@
+﻿#pragma once
+#define EZ_LOCKFREEQUEUE_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A bounded, lock-free queue for any number of producers and consumers.
+	       一个有界的、无锁的、支持任意数量生产者和消费者的队列。
+
+	This is the classic array-based queue where every slot carries a sequence
+	number, so a push or a pop is a single compare-and-swap in the common case
+	and never takes a lock. The capacity is rounded up to a power of two.
+
+	It is meant for small, trivially copyable elements such as pointers.
+
+	这是经典的基于数组的队列，每个槽位都带有一个序号，因此在通常情况下一次入队
+	或出队只需要一次 CAS 操作，并且从不加锁。容量会被向上取整为2的幂。
+
+	该队列适用于指针之类的小型、可平凡拷贝的元素。
+
+*/
+template <typename ElementType>
+class LockFreeQueue
+{
+public:
+	//==============================================================================
+	/** @brief Creates a queue that can hold at least the given number of elements.
+	           创建一个至少能容纳指定数量元素的队列。
+	*/
+	explicit LockFreeQueue(int minimumCapacity)
+	{
+		capacity = 2;
+
+		while (capacity < (size_t)minimumCapacity)
+			capacity <<= 1;
+
+		cells.calloc(capacity);
+
+		for (size_t i = 0; i < capacity; ++i)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+
+		enqueuePosition.store(0, std::memory_order_relaxed);
+		dequeuePosition.store(0, std::memory_order_relaxed);
+	}
+
+	//==============================================================================
+	/** @brief Adds an element to the back of the queue.
+	           在队列尾部添加一个元素。
+
+		@returns false if the queue was full.
+		@returns 队列已满时返回false。
+	*/
+	bool push(const ElementType &element)
+	{
+		Cell *cell;
+		size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			cell = &cells[position & (capacity - 1)];
+			const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+			if (difference == 0)
+			{
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->element = element;
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** @brief Removes the element at the front of the queue.
+	           移除队列头部的元素。
+
+		@returns false if the queue was empty.
+		@returns 队列为空时返回false。
+	*/
+	bool pop(ElementType &result)
+	{
+		Cell *cell;
+		size_t position = dequeuePosition.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			cell = &cells[position & (capacity - 1)];
+			const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+			if (difference == 0)
+			{
+				if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = dequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		result = cell->element;
+		cell->sequence.store(position + capacity, std::memory_order_release);
+		return true;
+	}
+
+	//==============================================================================
+	/** @brief Returns true if the queue looked empty at the moment of the call.
+	           如果队列在调用时看起来为空，返回true。
+	*/
+	bool isEmpty() const
+	{
+		return enqueuePosition.load(std::memory_order_acquire) == dequeuePosition.load(std::memory_order_acquire);
+	}
+
+	/** @brief Returns the number of elements the queue can hold.
+	           返回队列所能容纳的元素数量。
+	*/
+	int getCapacity() const
+	{
+		return (int)capacity;
+	}
+
+private:
+	//==============================================================================
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		ElementType element;
+	};
+
+	juce::HeapBlock<Cell> cells;
+	size_t capacity;
+
+	char paddingBeforeEnqueue[64];
+	std::atomic<size_t> enqueuePosition;
+	char paddingBeforeDequeue[64];
+	std::atomic<size_t> dequeuePosition;
+
+	JUCE_DECLARE_NON_COPYABLE(LockFreeQueue)
+};
@@ -0,0 +1,268 @@
+﻿#pragma once
+#define EZ_CONSOLEFORMATARGUMENT_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Writes one argument of a format string into a chunk buffer.
+	       将格式字符串的一个参数写入内存块缓冲区。
+
+	This is shared by ConsoleOutputStream::print, the text mode of
+	ConsoleOutputStream::log and ConsoleLogReader, so a value reads the same
+	whichever way it was written.
+
+	ConsoleOutputStream::print、ConsoleOutputStream::log 的文本模式以及
+	ConsoleLogReader 共用这些写出函数，因此无论以哪种方式写出，同一个值的文本都相同。
+
+	Numbers, bool, char, C strings, wide C strings, juce::String,
+	juce::StringRef, juce::var, juce::Time, juce::File and the
+	ConsoleNumberFormat wrappers are supported. None of them goes through a
+	temporary String: numbers are formatted in place, strings are copied from
+	their UTF-8 data and wide strings are converted by ConsoleUTF8.
+
+	Specialise this for your own types, with an "isSupported" set to true and
+	a static "write" function.
+
+	支持数字、bool、char、C字符串、宽字符C字符串、juce::String、juce::StringRef、
+	juce::var、juce::Time、juce::File 以及 ConsoleNumberFormat 的包装类型。它们
+	都不会经过临时的String：数字直接在缓冲区中格式化，字符串从其UTF-8数据中拷贝，
+	宽字符串则由 ConsoleUTF8 转换。
+
+	可以为自己的类型特化该模板，将"isSupported"设为true并提供一个静态的"write"
+	函数。
+*/
+template <typename Type>
+struct ConsoleFormatArgument
+{
+	static constexpr bool isSupported = std::is_integral<Type>::value;
+
+	static void write(ConsoleChunkBuffer &buffer, Type value)
+	{
+		writeInteger(buffer, value, std::is_signed<Type>());
+	}
+
+private:
+	static void writeInteger(ConsoleChunkBuffer &buffer, Type value, std::true_type)
+	{
+		buffer.commitWrite((size_t)ConsoleNumberFormat::formatSigned((juce::int64)value, buffer.prepareWrite(ConsoleNumberFormat::maxIntegerChars)));
+	}
+
+	static void writeInteger(ConsoleChunkBuffer &buffer, Type value, std::false_type)
+	{
+		buffer.commitWrite((size_t)ConsoleNumberFormat::formatUnsigned((juce::uint64)value, buffer.prepareWrite(ConsoleNumberFormat::maxIntegerChars)));
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<bool>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, bool value)
+	{
+		if (value)
+			buffer.append("true", 4);
+		else
+			buffer.append("false", 5);
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<char>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, char value)
+	{
+		buffer.append(&value, 1);
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<float>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, float value)
+	{
+		buffer.commitWrite((size_t)ConsoleNumberFormat::formatFloat(value, buffer.prepareWrite(ConsoleNumberFormat::maxFloatChars)));
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<double>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, double value)
+	{
+		buffer.commitWrite((size_t)ConsoleNumberFormat::formatDouble(value, buffer.prepareWrite(ConsoleNumberFormat::maxFloatChars)));
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<long double> : public ConsoleFormatArgument<double>
+{
+	static void write(ConsoleChunkBuffer &buffer, long double value)
+	{
+		ConsoleFormatArgument<double>::write(buffer, (double)value);
+	}
+};
+
+template <size_t size>
+struct ConsoleFormatArgument<char[size]>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const char *text)
+	{
+		buffer.append(text, strlen(text));
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<const char*>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const char *text)
+	{
+		if (text != nullptr)
+			buffer.append(text, strlen(text));
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<char*> : public ConsoleFormatArgument<const char*> {};
+
+template <>
+struct ConsoleFormatArgument<const wchar_t*>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const wchar_t *text)
+	{
+		if (text != nullptr)
+			ConsoleUTF8::appendWide(buffer, text, wcslen(text));
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<wchar_t*> : public ConsoleFormatArgument<const wchar_t*> {};
+
+template <size_t size>
+struct ConsoleFormatArgument<wchar_t[size]> : public ConsoleFormatArgument<const wchar_t*> {};
+
+template <>
+struct ConsoleFormatArgument<juce::String>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const juce::String &text)
+	{
+		buffer.append(text.toRawUTF8(), text.getNumBytesAsUTF8());
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<juce::StringRef>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const juce::StringRef &text)
+	{
+		buffer.append(text.text.getAddress(), text.text.sizeInBytes() - 1);
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<juce::var>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const juce::var &value)
+	{
+		if (value.isInt() || value.isInt64())
+			ConsoleFormatArgument<juce::int64>::write(buffer, (juce::int64)value);
+		else if (value.isDouble())
+			ConsoleFormatArgument<double>::write(buffer, (double)value);
+		else if (value.isBool())
+			ConsoleFormatArgument<bool>::write(buffer, (bool)value);
+		else
+			ConsoleFormatArgument<juce::String>::write(buffer, value.toString());
+	}
+};
+
+/** Times are written in local time as "2017-08-01 13:45:06.789". */
+template <>
+struct ConsoleFormatArgument<juce::Time>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const juce::Time &time)
+	{
+		char *d = buffer.prepareWrite(32);
+		char *start = d;
+
+		d += ConsoleNumberFormat::formatSigned(time.getYear(), d);
+		*d++ = '-';
+		d = writeTwoDigits(d, time.getMonth() + 1);
+		*d++ = '-';
+		d = writeTwoDigits(d, time.getDayOfMonth());
+		*d++ = ' ';
+		d = writeTwoDigits(d, time.getHours());
+		*d++ = ':';
+		d = writeTwoDigits(d, time.getMinutes());
+		*d++ = ':';
+		d = writeTwoDigits(d, time.getSeconds());
+		*d++ = '.';
+
+		const int milliseconds = time.getMilliseconds();
+		*d++ = (char)('0' + milliseconds / 100);
+		d = writeTwoDigits(d, milliseconds % 100);
+
+		buffer.commitWrite((size_t)(d - start));
+	}
+
+	static char* writeTwoDigits(char *dest, int value)
+	{
+		dest[0] = (char)('0' + value / 10);
+		dest[1] = (char)('0' + value % 10);
+		return dest + 2;
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<juce::File>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const juce::File &file)
+	{
+		ConsoleFormatArgument<juce::String>::write(buffer, file.getFullPathName());
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<ConsoleNumberFormat::Hex>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const ConsoleNumberFormat::Hex &number)
+	{
+		buffer.commitWrite((size_t)ConsoleNumberFormat::formatHex(number.value, buffer.prepareWrite(ConsoleNumberFormat::maxIntegerChars),
+		                                                          number.minNumDigits, number.upperCase));
+	}
+};
+
+template <>
+struct ConsoleFormatArgument<ConsoleNumberFormat::Fixed>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const ConsoleNumberFormat::Fixed &number)
+	{
+		buffer.commitWrite((size_t)ConsoleNumberFormat::formatFixed(number.value, number.numDecimalPlaces,
+		                                                            buffer.prepareWrite(ConsoleNumberFormat::maxFixedChars)));
+	}
+};
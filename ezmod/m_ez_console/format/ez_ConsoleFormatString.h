@@ -0,0 +1,159 @@
+﻿#pragma once
+#define EZ_CONSOLEFORMATSTRING_H_INCLUDED
+
+/** Format strings are passed as template arguments, which needs class types as
+	non-type template parameters, so they are only available when compiling as
+	C++20 or later.
+
+	格式字符串以模板参数的形式传入，这需要支持类类型的非类型模板参数，因此只有在以
+	C++20或更高标准编译时才可用。
+*/
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+ #define EZ_CONSOLE_HAS_FORMAT_STRINGS 1
+#else
+ #define EZ_CONSOLE_HAS_FORMAT_STRINGS 0
+#endif
+
+#if EZ_CONSOLE_HAS_FORMAT_STRINGS
+
+//==============================================================================
+/**
+
+    @brief A format string that is checked while compiling.
+	       在编译期进行检查的格式字符串。
+
+	Each "{}" in the text is replaced by the next argument. Use "{{" and "}}"
+	for literal braces. Any other brace is a compile error.
+
+	文本中的每个"{}"都会被下一个参数替换。字面的花括号请使用"{{"和"}}"。其他任何
+	花括号都会导致编译错误。
+
+	@see ConsoleOutputStream::print
+*/
+template <size_t size>
+struct ConsoleFormatString
+{
+	constexpr ConsoleFormatString(const char (&source)[size])
+	{
+		for (size_t i = 0; i < size; ++i)
+			text[i] = source[i];
+	}
+
+	/** @brief Returns the number of placeholders, or -1 if a brace is not matched.
+	           返回占位符的数量，如果有不匹配的花括号则返回-1。
+	*/
+	constexpr int getNumPlaceholders() const
+	{
+		int count = 0;
+
+		for (size_t i = 0; i + 1 < size; ++i)
+		{
+			if (text[i] == '{' && (text[i + 1] == '{' || text[i + 1] == '}'))
+			{
+				count += text[i + 1] == '}' ? 1 : 0;
+				++i;
+			}
+			else if (text[i] == '}' && text[i + 1] == '}')
+			{
+				++i;
+			}
+			else if (text[i] == '{' || text[i] == '}')
+			{
+				return -1;
+			}
+		}
+
+		return count;
+	}
+
+	char text[size] {};
+};
+
+//==============================================================================
+/**
+
+    @brief The literal parts of a format string, split apart while compiling.
+	       在编译期拆分出的格式字符串的字面部分。
+
+	The text between the placeholders is unescaped into one array, so writing
+	a formatted line comes down to a fixed sequence of appends: a literal
+	part, an argument, a literal part, and so on.
+
+	占位符之间的文本被反转义后存放在一个数组中，因此写出一行格式化文本就归结为一个
+	固定的追加序列：字面部分、参数、字面部分，依此类推。
+*/
+template <ConsoleFormatString format>
+class ConsoleCompiledFormat
+{
+public:
+	//==============================================================================
+	static constexpr int numPlaceholders = format.getNumPlaceholders();
+
+	/** @brief Writes the text with each placeholder replaced by an argument.
+	           写出文本，并将每个占位符替换为一个参数。
+	*/
+	template <typename... Args>
+	static void write(ConsoleChunkBuffer &buffer, const Args&... args)
+	{
+		writeParts(buffer, std::index_sequence_for<Args...>(), args...);
+	}
+
+private:
+	//==============================================================================
+	static constexpr size_t textSize = sizeof(format.text);
+	static constexpr size_t numParts = (numPlaceholders > 0 ? (size_t)numPlaceholders : 0) + 1;
+
+	struct Layout
+	{
+		char text[textSize] {};
+		size_t starts[numParts] {};
+		size_t lengths[numParts] {};
+	};
+
+	static constexpr Layout createLayout()
+	{
+		Layout layout;
+		size_t length = 0, part = 0;
+
+		for (size_t i = 0; i + 1 < textSize && part < numParts; ++i)
+		{
+			const char c = format.text[i];
+
+			if (c == '{' && format.text[i + 1] == '}')
+			{
+				layout.lengths[part] = length - layout.starts[part];
+				layout.starts[++part] = length;
+				++i;
+				continue;
+			}
+
+			if ((c == '{' || c == '}') && format.text[i + 1] == c)
+				++i;
+
+			layout.text[length++] = c;
+		}
+
+		if (part < numParts)
+			layout.lengths[part] = length - layout.starts[part];
+
+		return layout;
+	}
+
+	static constexpr Layout layout = createLayout();
+
+	template <size_t index>
+	static void writeLiteral(ConsoleChunkBuffer &buffer)
+	{
+		if constexpr (layout.lengths[index] > 0)
+			buffer.append(layout.text + layout.starts[index], layout.lengths[index]);
+	}
+
+	template <size_t... indices, typename... Args>
+	static void writeParts(ConsoleChunkBuffer &buffer, std::index_sequence<indices...>, const Args&... args)
+	{
+		((writeLiteral<indices>(buffer), ConsoleFormatArgument<Args>::write(buffer, args)), ...);
+		writeLiteral<sizeof...(Args)>(buffer);
+	}
+};
+
+#endif
@@ -0,0 +1,504 @@
+﻿#pragma once
+#define EZ_CONSOLEHEXDUMP_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Writes binary data as a hex dump straight into a chunk buffer.
+	       将二进制数据以十六进制转储的形式直接写入内存块缓冲区。
+
+	By default the layout is the one of "hexdump -C": the offset, the bytes
+	in two groups of eight, and the printable characters between bars. Runs
+	of identical lines are collapsed into a single "*", and the dump ends with
+	the offset just past the data.
+
+	@code
+	00000000  48 65 6c 6c 6f 2c 20 77  6f 72 6c 64 21 0a 00 00  |Hello, world!...|
+	00000010  00 00 00 00 00 00 00 00  00 00 00 00 00 00 00 00  |................|
+	*
+	00000040
+	@endcode
+
+	Each line is formatted into the buffer with "prepareWrite", with no
+	String or temporary copy. The hex digits come from a table of digit pairs;
+	for full lines in the default layout, AVX2 shuffles turn the sixteen bytes
+	into the whole hex column at once, and the text column is made with SSE2,
+	so a large dump goes about as fast as the memory can take it. When a spill
+	function is given it is called each time a block's worth has been written,
+	so the buffer can be printed while the dump goes on.
+
+	Data can be given in several calls to "write", as it is read, and the
+	offsets carry on from one call to the next. Call "finish" at the end.
+
+	默认的排版与"hexdump -C"相同：偏移量、分为两组（每组八个）的字节，以及竖线之间
+	的可打印字符。连续相同的行会被折叠为一个"*"，转储以数据末尾之后的偏移量结束。
+
+	@code
+	00000000  48 65 6c 6c 6f 2c 20 77  6f 72 6c 64 21 0a 00 00  |Hello, world!...|
+	00000010  00 00 00 00 00 00 00 00  00 00 00 00 00 00 00 00  |................|
+	*
+	00000040
+	@endcode
+
+	每一行都通过"prepareWrite"直接格式化到缓冲区中，不会构建String或产生临时拷贝。
+	十六进制数字取自一张数字对表；对于默认排版下的完整行，AVX2 洗牌指令会一次性将
+	十六个字节转换为整个十六进制列，文本列则使用 SSE2 生成，因此大量数据的转储速度
+	几乎只受内存带宽的限制。如果提供了溢出函数，每写满一个数据块就会调用它一次，
+	因此可以在转储进行的同时输出缓冲区。
+
+	数据可以在读取的同时分多次传给"write"，偏移量会在各次调用之间延续。结束时请调用
+	"finish"。
+
+	@see ConsoleOutputStream::writeHexDump
+*/
+class ConsoleHexDump
+{
+public:
+	//==============================================================================
+	/** @brief What the dump shows, to be combined with "|".
+	           转储显示的内容，可以用"|"组合。
+	*/
+	enum Flags
+	{
+		showOffsets     = 1,   /**< The offset at the start of each line, and at the end.
+		                            每行开头以及末尾的偏移量。 */
+		showText        = 2,   /**< The bytes as characters, between bars.
+		                            竖线之间以字符形式显示的字节。 */
+		utf8Text        = 4,   /**< Show UTF-8 sequences as characters in the text
+		                            column, instead of only printable ASCII.
+		                            在文本列中将UTF-8序列显示为字符，而不是只显示可打印的ASCII字符。 */
+		collapseRepeats = 8,   /**< Show a run of identical lines as "*".
+		                            将连续相同的行显示为"*"。 */
+		upperCase       = 16,  /**< Use "A" to "F" instead of "a" to "f".
+		                            使用"A"到"F"，而不是"a"到"f"。 */
+
+		defaultFlags    = showOffsets | showText | collapseRepeats
+	};
+
+	/** @brief How the dump is laid out.
+	           转储的排版方式。
+	*/
+	struct Options
+	{
+		/** @brief The layout of "hexdump -C".
+		           "hexdump -C"的排版方式。
+		*/
+		Options()
+			: flags(defaultFlags), bytesPerLine(16), groupSize(8), startOffset(0)
+		{
+		}
+
+		int flags;                /**< A combination of Flags. Flags 的组合。 */
+		int bytesPerLine;         /**< From 1 to 256. 取值范围为1到256。 */
+		int groupSize;            /**< An extra space is put after each group of this many
+		                               bytes, or 0 for none.
+		                               每隔这么多个字节多加一个空格，设为0则不加。 */
+		juce::uint64 startOffset; /**< The offset shown for the first byte.
+		                               第一个字节所显示的偏移量。 */
+	};
+
+	/** @brief The function called when a block's worth of the dump has been written.
+	           写满一个数据块的转储时调用的函数。
+	*/
+	typedef std::function<void (ConsoleChunkBuffer&)> SpillFunction;
+
+	//==============================================================================
+	/** @brief Creates a dump that appends to a buffer.
+	           创建一个向缓冲区追加数据的转储。
+
+		@param destination  The buffer to append to.
+		                    要追加数据的缓冲区。
+
+		@param options      The layout.
+		                    排版方式。
+
+		@param spill        Called between lines whenever the buffer holds at least
+		                    "blockSize" bytes. It would normally print the buffer.
+		                    It may be nullptr.
+		                    每当行与行之间缓冲区中至少有"blockSize"个字节时调用。
+		                    它通常会输出缓冲区。可以为nullptr。
+
+		@param blockSize    See "spill". The default value is 64 KB.
+		                    参见"spill"。默认值是64 KB。
+	*/
+	explicit ConsoleHexDump(ConsoleChunkBuffer &destination, const Options &options = Options(),
+		SpillFunction spill = nullptr, size_t blockSize = 64 * 1024)
+		: buffer(destination),
+		  flags(options.flags),
+		  bytesPerLine(juce::jlimit(1, 256, options.bytesPerLine)),
+		  groupSize(juce::jlimit(0, bytesPerLine, options.groupSize)),
+		  offset(options.startOffset),
+		  hexPairs(getHexPairs((options.flags & upperCase) != 0)),
+		  isStandardLayout(bytesPerLine == 16 && groupSize == 8),
+		  lineChars((size_t)(ConsoleNumberFormat::maxIntegerChars + 2 + bytesPerLine * 3 + (groupSize > 0 ? bytesPerLine / groupSize : 0)
+		                     + 2 + bytesPerLine * ((options.flags & utf8Text) != 0 ? 2 : 1) + 2)),
+		  spillFunction(std::move(spill)),
+		  spillSize(blockSize),
+		  pendingLine((size_t)bytesPerLine),
+		  previousLine((size_t)bytesPerLine)
+	{
+		jassert(options.bytesPerLine >= 1 && options.bytesPerLine <= 256);
+	}
+
+	//==============================================================================
+	/** @brief Dumps the next part of the data.
+	           转储数据的下一部分。
+
+		A line that is not full yet is kept until more data comes, or until
+		"finish".
+
+		尚未写满的行会被保留，直到更多的数据到来，或者调用"finish"为止。
+	*/
+	void write(const void *data, size_t numBytes)
+	{
+		if (numBytes == 0)
+			return;
+
+		const juce::uint8 *bytes = static_cast<const juce::uint8*>(data);
+		const size_t lineSize = (size_t)bytesPerLine;
+
+		if (numPendingBytes > 0)
+		{
+			const size_t numToCopy = juce::jmin(lineSize - numPendingBytes, numBytes);
+			memcpy(pendingLine + numPendingBytes, bytes, numToCopy);
+			numPendingBytes += numToCopy;
+			bytes += numToCopy;
+			numBytes -= numToCopy;
+
+			if (numPendingBytes < lineSize)
+				return;
+
+			numPendingBytes = 0;
+
+			const juce::uint8 *previous = hasPreviousLine ? previousLine.getData() : nullptr;
+			writeFullLines(pendingLine, 1, previous);
+			memcpy(previousLine, pendingLine, lineSize);
+		}
+
+		if (numBytes >= lineSize)
+		{
+			const juce::uint8 *previous = hasPreviousLine ? previousLine.getData() : nullptr;
+			const size_t numLines = numBytes / lineSize;
+
+			writeFullLines(bytes, numLines, previous);
+			memcpy(previousLine, previous, lineSize);
+
+			bytes += numLines * lineSize;
+			numBytes -= numLines * lineSize;
+		}
+
+		memcpy(pendingLine, bytes, numBytes);
+		numPendingBytes = numBytes;
+	}
+
+	/** @brief Writes the last line, if it is not full, and the final offset.
+	           写出最后一行（如果它不完整）以及最终的偏移量。
+	*/
+	void finish()
+	{
+		char *const dest = buffer.prepareWrite(lineChars + ConsoleNumberFormat::maxIntegerChars + 1);
+		char *d = dest;
+
+		if (numPendingBytes > 0)
+		{
+			d = writeLine(d, pendingLine, (int)numPendingBytes);
+			offset += numPendingBytes;
+			numPendingBytes = 0;
+		}
+
+		if ((flags & showOffsets) != 0)
+		{
+			d = writeOffset(d, offset);
+			*d++ = '\n';
+		}
+
+		buffer.commitWrite((size_t)(d - dest));
+
+		hasPreviousLine = false;
+		isCollapsing = false;
+	}
+
+private:
+	//==============================================================================
+	struct HexPairs
+	{
+		explicit HexPairs(const char *digits)
+		{
+			for (int i = 0; i < 256; ++i)
+			{
+				pairs[i * 2] = digits[i >> 4];
+				pairs[i * 2 + 1] = digits[i & 15];
+			}
+		}
+
+		char pairs[512];
+	};
+
+	static const char* getHexPairs(bool useUpperCase)
+	{
+		static const HexPairs lower("0123456789abcdef"), upper("0123456789ABCDEF");
+		return useUpperCase ? upper.pairs : lower.pairs;
+	}
+
+	//==============================================================================
+	// Lines are formatted in batches of about 2 KB, each in a single
+	// "prepareWrite", so the cost of reserving room is shared. Once a line is
+	// the same as the one before, it and those after it that are also the same
+	// are replaced by a single "*".
+	void writeFullLines(const juce::uint8 *lines, size_t numLines, const juce::uint8 *&previous)
+	{
+		const size_t lineSize = (size_t)bytesPerLine;
+		const size_t numLinesPerBatch = juce::jmax((size_t)1, (size_t)2048 / lineChars);
+		const bool shouldCollapse = (flags & collapseRepeats) != 0;
+
+		while (numLines > 0)
+		{
+			const size_t numInBatch = juce::jmin(numLines, numLinesPerBatch);
+			char *const dest = buffer.prepareWrite(numInBatch * lineChars);
+			char *d = dest;
+
+			for (size_t i = 0; i < numInBatch; ++i, lines += lineSize)
+			{
+				if (shouldCollapse && previous != nullptr && memcmp(lines, previous, lineSize) == 0)
+				{
+					if (!isCollapsing)
+					{
+						isCollapsing = true;
+						*d++ = '*';
+						*d++ = '\n';
+					}
+				}
+				else
+				{
+					isCollapsing = false;
+					d = writeLine(d, lines, bytesPerLine);
+				}
+
+				previous = lines;
+				offset += lineSize;
+			}
+
+			buffer.commitWrite((size_t)(d - dest));
+			numLines -= numInBatch;
+			hasPreviousLine = true;
+
+			if (spillFunction != nullptr && buffer.getTotalSize() >= spillSize)
+				spillFunction(buffer);
+		}
+	}
+
+	char* writeLine(char *d, const juce::uint8 *line, int numBytes) const
+	{
+		if ((flags & showOffsets) != 0)
+		{
+			d = writeOffset(d, offset);
+			*d++ = ' ';
+			*d++ = ' ';
+		}
+
+		char *const hexStart = d;
+
+		if (isStandardLayout && numBytes == 16)
+		{
+			static const StandardHexWriter writer = ConsoleSIMD::chooseKernel(writeStandardHexScalar, writeStandardHexAVX2);
+			d = writer(d, line, hexPairs);
+		}
+		else
+		{
+			d = writeHex(d, line, numBytes);
+		}
+
+		if ((flags & showText) != 0)
+		{
+			*d++ = ' ';
+			*d++ = '|';
+			d = (flags & utf8Text) != 0 ? writeUTF8Text(d, line, numBytes) : writeAsciiText(d, line, numBytes);
+			*d++ = '|';
+		}
+		else
+		{
+			while (d > hexStart && d[-1] == ' ')
+				--d;
+		}
+
+		*d++ = '\n';
+		return d;
+	}
+
+	// Offsets are written with 8 digits, or more when they need them.
+	char* writeOffset(char *dest, juce::uint64 value) const
+	{
+		if (value > 0xffffffffu)
+			return dest + ConsoleNumberFormat::formatHex(value, dest, 8, (flags & upperCase) != 0);
+
+		for (int i = 3; i >= 0; --i)
+		{
+			memcpy(dest + i * 2, hexPairs + (value & 0xff) * 2, 2);
+			value >>= 8;
+		}
+
+		return dest + 8;
+	}
+
+	// Each byte takes "hh ", and each group is followed by one more space. The
+	// bytes missing from a short last line are left blank, so that its text
+	// column lines up with the others.
+	char* writeHex(char *d, const juce::uint8 *line, int numBytes) const
+	{
+		for (int i = 0; i < bytesPerLine; ++i)
+		{
+			if (groupSize > 0 && i > 0 && i % groupSize == 0)
+				*d++ = ' ';
+
+			if (i < numBytes)
+			{
+				memcpy(d, hexPairs + line[i] * 2, 2);
+			}
+			else
+			{
+				d[0] = ' ';
+				d[1] = ' ';
+			}
+
+			d[2] = ' ';
+			d += 3;
+		}
+
+		return d;
+	}
+
+	static char* writeAsciiText(char *d, const juce::uint8 *line, int numBytes)
+	{
+		int i = 0;
+
+	#if EZ_CONSOLE_USE_SSE2
+		const __m128i firstPrintable = _mm_set1_epi8(0x1f), lastPrintable = _mm_set1_epi8(0x7f), dot = _mm_set1_epi8('.');
+
+		for (; i + 16 <= numBytes; i += 16)
+		{
+			// Bytes from 0x80 up are negative, so the signed compare rules them out.
+			const __m128i block = _mm_loadu_si128((const __m128i*)(line + i));
+			const __m128i isPrintable = _mm_and_si128(_mm_cmpgt_epi8(block, firstPrintable), _mm_cmplt_epi8(block, lastPrintable));
+			_mm_storeu_si128((__m128i*)(d + i), _mm_or_si128(_mm_and_si128(isPrintable, block), _mm_andnot_si128(isPrintable, dot)));
+		}
+	#endif
+
+		for (; i < numBytes; ++i)
+			d[i] = line[i] >= 0x20 && line[i] < 0x7f ? (char)line[i] : '.';
+
+		return d + numBytes;
+	}
+
+	// A character takes as many columns as it has bytes, so that the column
+	// lines up: it is written at its first byte and padded with spaces.
+	// Characters that are cut by the end of the line, or take no room, show
+	// as dots.
+	static char* writeUTF8Text(char *d, const juce::uint8 *line, int numBytes)
+	{
+		for (int i = 0; i < numBytes;)
+		{
+			const int length = line[i] < 0x80 ? 1 : ConsoleUTF8::getSequenceLength(line + i, (size_t)(numBytes - i));
+
+			if (length > 1)
+			{
+				juce::uint32 c = line[i] & (0x7f >> length);
+
+				for (int j = 1; j < length; ++j)
+					c = (c << 6) | (line[i + j] & 0x3f);
+
+				const int width = ConsoleDisplayWidth::getCharacterWidth(c);
+
+				if (width > 0)
+				{
+					memcpy(d, line + i, (size_t)length);
+					d += length;
+
+					for (int j = width; j < length; ++j)
+						*d++ = ' ';
+
+					i += length;
+					continue;
+				}
+			}
+
+			*d++ = line[i] >= 0x20 && line[i] < 0x7f ? (char)line[i] : '.';
+			++i;
+		}
+
+		return d;
+	}
+
+	//==============================================================================
+	typedef char* (*StandardHexWriter) (char*, const juce::uint8*, const char*);
+
+	// The default layout of a full line: two groups of eight "hh ", with an
+	// extra space between them, 49 characters in all.
+	static char* writeStandardHexScalar(char *d, const juce::uint8 *line, const char *pairs)
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			char *const p = d + i * 3 + (i >> 3);
+			memcpy(p, pairs + line[i] * 2, 2);
+			p[2] = ' ';
+		}
+
+		d[24] = ' ';
+		return d + 49;
+	}
+
+#if EZ_CONSOLE_USE_AVX2
+	// The nibbles are looked up in a 16-entry table with a shuffle, and three
+	// more shuffles spread the 32 digits out to their places in the line, with
+	// spaces in between.
+	EZ_CONSOLE_AVX2_TARGET
+	static char* writeStandardHexAVX2(char *d, const juce::uint8 *line, const char *pairs)
+	{
+		const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+		const __m128i digits = _mm_setr_epi8(pairs[1], pairs[3], pairs[5], pairs[7], pairs[9], pairs[11], pairs[13], pairs[15],
+		                                     pairs[17], pairs[19], pairs[21], pairs[23], pairs[25], pairs[27], pairs[29], pairs[31]);
+
+		const __m128i block = _mm_loadu_si128((const __m128i*)line);
+		const __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(block, 4), nibbleMask));
+		const __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(block, nibbleMask));
+		const __m128i first = _mm_unpacklo_epi8(high, low);   // the digits of bytes 0 to 7
+		const __m128i second = _mm_unpackhi_epi8(high, low);  // the digits of bytes 8 to 15
+
+		// An index of -1 gives a zero byte, which the OR with the spaces fills in.
+		const __m128i spaces0 = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+		const __m128i spaces1 = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', ' ', 0, 0, ' ', 0, 0, ' ', 0);
+		const __m128i spaces2 = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0);
+
+		const __m128i out0 = _mm_or_si128(_mm_shuffle_epi8(first, _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10)), spaces0);
+		const __m128i out1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(first, _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+		                                               _mm_shuffle_epi8(second, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4))),
+		                                  spaces1);
+		const __m128i out2 = _mm_or_si128(_mm_shuffle_epi8(second, _mm_setr_epi8(5, -1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15)), spaces2);
+
+		_mm_storeu_si128((__m128i*)d, out0);
+		_mm_storeu_si128((__m128i*)(d + 16), out1);
+		_mm_storeu_si128((__m128i*)(d + 32), out2);
+		d[48] = ' ';
+
+		return d + 49;
+	}
+#else
+	static char* writeStandardHexAVX2(char*, const juce::uint8*, const char*)   { return nullptr; }
+#endif
+
+	//==============================================================================
+	ConsoleChunkBuffer &buffer;
+	const int flags, bytesPerLine, groupSize;
+	juce::uint64 offset;
+	const char *const hexPairs;
+	const bool isStandardLayout;
+	const size_t lineChars;  // The longest line of this layout: offset, hex, text and new line.
+
+	SpillFunction spillFunction;
+	const size_t spillSize;
+
+	juce::HeapBlock<juce::uint8> pendingLine, previousLine;
+	size_t numPendingBytes = 0;
+	bool hasPreviousLine = false, isCollapsing = false;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleHexDump)
+};
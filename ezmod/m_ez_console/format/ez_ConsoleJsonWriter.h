@@ -0,0 +1,501 @@
+﻿#pragma once
+#define EZ_CONSOLEJSONWRITER_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Writes values as JSON straight into a chunk buffer.
+	       将值以JSON格式直接写入内存块缓冲区。
+
+	juce::JSON::toString builds the whole text in a String before it can be
+	written anywhere. This writer walks the value instead and appends the
+	escaped text to the buffer as it goes, and when a spill function is given
+	it is called each time a block's worth has been written, so the buffer can
+	be printed before the value is finished. Apart from the buffer, the memory
+	used only grows with how deeply the value is nested.
+
+	juce::var (with DynamicObject, arrays and binary data, which becomes a
+	Base64 string), DynamicObject, StringArray, juce::Array of any of these,
+	strings, numbers and bool can be written. Numbers use ConsoleNumberFormat;
+	NaN and infinity, which JSON cannot show, are written as null, and so are
+	methods and other objects.
+
+	Strings are scanned with SSE2 or AVX2 for the next byte that needs
+	escaping, and the runs in between are copied as they are. With the
+	asciiOnly flag, every non-ASCII character is escaped as "\uXXXX" as well,
+	so the output is pure ASCII.
+
+	juce::JSON::toString 必须先在一个String中构建完整的文本，之后才能写出到别处。
+	而该写出器遍历值本身，边遍历边将转义后的文本追加到缓冲区中；如果提供了溢出
+	函数，每写满一个数据块就会调用它一次，因此可以在值写完之前就输出缓冲区。除缓冲
+	区之外，占用的内存只随值的嵌套深度增长。
+
+	可以写出 juce::var（包括 DynamicObject、数组以及二进制数据，后者会写为Base64
+	字符串）、DynamicObject、StringArray、由上述任意类型组成的 juce::Array、字符串、
+	数字和bool。数字使用 ConsoleNumberFormat 写出；JSON无法表示的NaN和无穷大会被写为
+	null，方法和其他对象也是如此。
+
+	字符串使用 SSE2 或 AVX2 扫描下一个需要转义的字节，两者之间的片段则原样拷贝。
+	使用asciiOnly标志时，每个非ASCII字符也会被转义为"\uXXXX"，因此输出是纯ASCII。
+
+	@see ConsoleOutputStream::json, ConsoleOutputStream::writeJson
+*/
+class ConsoleJsonWriter
+{
+public:
+	//==============================================================================
+	/** @brief How the JSON is laid out, to be combined with "|".
+	           JSON的排版方式，可以用"|"组合。
+	*/
+	enum Flags
+	{
+		compact   = 0,  /**< No spaces or new lines at all. This is the default.
+		                     完全没有空格和换行。这是默认值。 */
+		pretty    = 1,  /**< One value per line, indented by two spaces per level.
+		                     每行一个值，每一层缩进两个空格。 */
+		asciiOnly = 2   /**< Escape every non-ASCII character as "\uXXXX".
+		                     将每个非ASCII字符转义为"\uXXXX"。 */
+	};
+
+	/** @brief A value to be written into a stream as JSON.
+	           要以JSON格式写入输出流的值。
+
+		@see ConsoleOutputStream::json
+	*/
+	template <typename ValueType>
+	struct Json
+	{
+		const ValueType &value;
+		int flags;
+	};
+
+	/** @brief The function called when a block's worth of JSON has been written.
+	           写满一个数据块的JSON时调用的函数。
+	*/
+	typedef std::function<void (ConsoleChunkBuffer&)> SpillFunction;
+
+	//==============================================================================
+	/** @brief Creates a writer that appends to a buffer.
+	           创建一个向缓冲区追加数据的写出器。
+
+		@param destination  The buffer to append to.
+		                    要追加数据的缓冲区。
+
+		@param flags        A combination of Flags.
+		                    Flags 的组合。
+
+		@param spill        Called between values whenever the buffer holds at
+		                    least "blockSize" bytes. It would normally print the
+		                    buffer. It may be nullptr.
+		                    每当值与值之间缓冲区中至少有"blockSize"个字节时调用。
+		                    它通常会输出缓冲区。可以为nullptr。
+
+		@param blockSize    See "spill". The default value is 64 KB.
+		                    参见"spill"。默认值是64 KB。
+	*/
+	explicit ConsoleJsonWriter(ConsoleChunkBuffer &destination, int flags = compact,
+		SpillFunction spill = nullptr, size_t blockSize = 64 * 1024)
+		: buffer(destination),
+		  isPretty((flags & pretty) != 0),
+		  escapeNonAscii((flags & asciiOnly) != 0),
+		  spillFunction(std::move(spill)),
+		  spillSize(blockSize)
+	{
+	}
+
+	//==============================================================================
+	/** @brief Writes a var, and everything it holds.
+	           写出一个var及其包含的所有内容。
+	*/
+	void write(const juce::var &value)
+	{
+		if (value.isBool())
+			write((bool)value);
+		else if (value.isInt() || value.isInt64())
+			write((juce::int64)value);
+		else if (value.isDouble())
+			write((double)value);
+		else if (value.isString())
+			write(value.toString());
+		else if (const juce::Array<juce::var> *array = value.getArray())
+			write(*array);
+		else if (const juce::DynamicObject *object = value.getDynamicObject())
+			write(*object);
+		else if (const juce::MemoryBlock *data = value.getBinaryData())
+			writeBase64(static_cast<const juce::uint8*>(data->getData()), data->getSize());
+		else
+			writeNull();
+	}
+
+	/** @brief Writes the properties of an object.
+	           写出一个对象的属性。
+	*/
+	void write(const juce::DynamicObject &object)
+	{
+		const juce::NamedValueSet &properties = object.getProperties();
+		const int numProperties = properties.size();
+
+		openContainer('{', numProperties);
+
+		for (int i = 0; i < numProperties; ++i)
+		{
+			startElement(i);
+			write(properties.getName(i).toString());
+			buffer.append(isPretty ? ": " : ":", isPretty ? 2 : 1);
+			write(properties.getValueAt(i));
+		}
+
+		closeContainer('}', numProperties);
+	}
+
+	/** @brief Writes an array of strings.
+	           写出一个字符串数组。
+	*/
+	void write(const juce::StringArray &strings)
+	{
+		const int numStrings = strings.size();
+
+		openContainer('[', numStrings);
+
+		for (int i = 0; i < numStrings; ++i)
+		{
+			startElement(i);
+			write(strings[i]);
+		}
+
+		closeContainer(']', numStrings);
+	}
+
+	/** @brief Writes an array of anything else that can be written.
+	           写出由其他任何可写出的值组成的数组。
+	*/
+	template <typename ElementType>
+	void write(const juce::Array<ElementType> &array)
+	{
+		const int numElements = array.size();
+
+		openContainer('[', numElements);
+
+		for (int i = 0; i < numElements; ++i)
+		{
+			startElement(i);
+			write(array.getReference(i));
+		}
+
+		closeContainer(']', numElements);
+	}
+
+	/** @brief Writes a string, escaped and in double quotes.
+	           写出一个经过转义并带有双引号的字符串。
+	*/
+	void write(juce::StringRef text)
+	{
+		writeString(text.text.getAddress(), strlen(text.text.getAddress()));
+	}
+
+	void write(const juce::String &text)   { writeString(text.toRawUTF8(), text.getNumBytesAsUTF8()); }
+	void write(const char *text)           { writeString(text, text != nullptr ? strlen(text) : 0); }
+
+	void write(bool value)
+	{
+		buffer.append(value ? "true" : "false", value ? 4 : 5);
+	}
+
+	template <typename IntegerType>
+	auto write(IntegerType value) -> typename std::enable_if<std::is_integral<IntegerType>::value>::type
+	{
+		ConsoleFormatArgument<IntegerType>::write(buffer, value);
+	}
+
+	void write(double value)
+	{
+		if (std::isfinite(value))
+			ConsoleFormatArgument<double>::write(buffer, value);
+		else
+			writeNull();
+	}
+
+	void write(float value)
+	{
+		if (std::isfinite(value))
+			ConsoleFormatArgument<float>::write(buffer, value);
+		else
+			writeNull();
+	}
+
+	//==============================================================================
+	/** @brief Returns the offset of the first byte that must be escaped in a
+	           JSON string, or numBytes if there is none.
+	           返回JSON字符串中第一个必须转义的字节的偏移量，如果没有则返回numBytes。
+
+		These are the double quote, the backslash and the control characters,
+		and also every byte from 0x80 up if "escapeNonAscii" is true.
+
+		这些字节包括双引号、反斜杠和控制字符；如果"escapeNonAscii"为true，还包括
+		从0x80开始的所有字节。
+	*/
+	static size_t findFirstToEscape(const char *data, size_t numBytes, bool escapeNonAscii)
+	{
+		static const EscapeFinder finder = ConsoleSIMD::chooseKernel(findFirstToEscapeScalar, findFirstToEscapeSSE2, findFirstToEscapeAVX2);
+		return finder(data, numBytes, escapeNonAscii);
+	}
+
+private:
+	//==============================================================================
+	typedef size_t (*EscapeFinder) (const char*, size_t, bool);
+
+	//==============================================================================
+	void writeNull()
+	{
+		buffer.append("null", 4);
+	}
+
+	void openContainer(char bracket, int numElements)
+	{
+		buffer.append(&bracket, 1);
+
+		if (numElements > 0)
+			++depth;
+	}
+
+	void startElement(int index)
+	{
+		if (index > 0)
+		{
+			buffer.append(",", 1);
+
+			if (spillFunction != nullptr && buffer.getTotalSize() >= spillSize)
+				spillFunction(buffer);
+		}
+
+		if (isPretty)
+			writeNewLine();
+	}
+
+	void closeContainer(char bracket, int numElements)
+	{
+		if (numElements > 0)
+		{
+			--depth;
+
+			if (isPretty)
+				writeNewLine();
+		}
+
+		buffer.append(&bracket, 1);
+	}
+
+	void writeNewLine()
+	{
+		buffer.append("\n", 1);
+		buffer.appendRepeated(' ', (size_t)depth * 2);
+	}
+
+	//==============================================================================
+	void writeString(const char *text, size_t numBytes)
+	{
+		buffer.append("\"", 1);
+
+		for (size_t i = 0; i < numBytes;)
+		{
+			const size_t runLength = findFirstToEscape(text + i, numBytes - i, escapeNonAscii);
+
+			buffer.append(text + i, runLength);
+			i += runLength;
+
+			if (i < numBytes)
+				i += writeEscaped(text + i, numBytes - i);
+		}
+
+		buffer.append("\"", 1);
+	}
+
+	size_t writeEscaped(const char *text, size_t numAvailable)
+	{
+		const juce::uint8 c = (juce::uint8)text[0];
+		char escaped[12] = { '\\' };
+
+		switch (c)
+		{
+		case '"':  escaped[1] = '"';  break;
+		case '\\': escaped[1] = '\\'; break;
+		case '\b': escaped[1] = 'b';  break;
+		case '\f': escaped[1] = 'f';  break;
+		case '\n': escaped[1] = 'n';  break;
+		case '\r': escaped[1] = 'r';  break;
+		case '\t': escaped[1] = 't';  break;
+
+		default:
+			if (c < 0x80)
+			{
+				buffer.append(escaped, (size_t)writeUnicodeEscape(c, escaped));
+				return 1;
+			}
+
+			return writeNonAscii((const juce::uint8*)text, numAvailable);
+		}
+
+		buffer.append(escaped, 2);
+		return 1;
+	}
+
+	// Invalid sequences become U+FFFD, one byte at a time, as ConsoleUTF8 does.
+	size_t writeNonAscii(const juce::uint8 *bytes, size_t numAvailable)
+	{
+		const int length = ConsoleUTF8::getSequenceLength(bytes, numAvailable);
+		char escaped[12];
+		juce::uint32 codePoint = 0xfffd;
+
+		if (length > 1)
+		{
+			codePoint = bytes[0] & (0x7f >> length);
+
+			for (int i = 1; i < length; ++i)
+				codePoint = (codePoint << 6) | (bytes[i] & 0x3f);
+		}
+
+		if (codePoint >= 0x10000)
+		{
+			codePoint -= 0x10000;
+
+			const int numHigh = writeUnicodeEscape(0xd800 + (codePoint >> 10), escaped);
+			buffer.append(escaped, (size_t)(numHigh + writeUnicodeEscape(0xdc00 + (codePoint & 0x3ff), escaped + numHigh)));
+		}
+		else
+		{
+			buffer.append(escaped, (size_t)writeUnicodeEscape(codePoint, escaped));
+		}
+
+		return length > 1 ? (size_t)length : 1;
+	}
+
+	static int writeUnicodeEscape(juce::uint32 unit, char *dest)
+	{
+		static const char hexDigits[] = "0123456789abcdef";
+
+		dest[0] = '\\';
+		dest[1] = 'u';
+
+		for (int i = 5; i >= 2; --i)
+		{
+			dest[i] = hexDigits[unit & 15];
+			unit >>= 4;
+		}
+
+		return 6;
+	}
+
+	void writeBase64(const juce::uint8 *data, size_t numBytes)
+	{
+		static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+		buffer.append("\"", 1);
+
+		for (size_t i = 0; i < numBytes; i += 3)
+		{
+			const size_t numInGroup = juce::jmin(numBytes - i, (size_t)3);
+			juce::uint32 group = (juce::uint32)data[i] << 16;
+
+			if (numInGroup > 1) group |= (juce::uint32)data[i + 1] << 8;
+			if (numInGroup > 2) group |= (juce::uint32)data[i + 2];
+
+			const char encoded[4] = { digits[(group >> 18) & 63], digits[(group >> 12) & 63],
+			                          numInGroup > 1 ? digits[(group >> 6) & 63] : '=',
+			                          numInGroup > 2 ? digits[group & 63] : '=' };
+			buffer.append(encoded, 4);
+		}
+
+		buffer.append("\"", 1);
+	}
+
+	//==============================================================================
+	static bool needsEscape(juce::uint8 c, bool escapeNonAscii)
+	{
+		return c < 0x20 || c == '"' || c == '\\' || (escapeNonAscii && c >= 0x80);
+	}
+
+	static size_t findFirstToEscapeScalar(const char *data, size_t numBytes, bool escapeNonAscii)
+	{
+		const juce::uint8 *bytes = (const juce::uint8*)data;
+
+		for (size_t i = 0; i < numBytes; ++i)
+			if (needsEscape(bytes[i], escapeNonAscii))
+				return i;
+
+		return numBytes;
+	}
+
+#if EZ_CONSOLE_USE_SSE2
+	static size_t findFirstToEscapeSSE2(const char *data, size_t numBytes, bool escapeNonAscii)
+	{
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i lastControl = _mm_set1_epi8(0x1f);
+		const int highBits = escapeNonAscii ? 0xffff : 0;
+		size_t i = 0;
+
+		for (; i + 16 <= numBytes; i += 16)
+		{
+			const __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+			const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+			                                     _mm_cmpeq_epi8(_mm_min_epu8(block, lastControl), block));
+			const int mask = _mm_movemask_epi8(special) | (_mm_movemask_epi8(block) & highBits);
+
+			if (mask != 0)
+				return i + (size_t)ConsoleSIMD::findLowestSetBit((juce::uint32)mask);
+		}
+
+		return i + findFirstToEscapeScalar(data + i, numBytes - i, escapeNonAscii);
+	}
+#else
+	static size_t findFirstToEscapeSSE2(const char*, size_t, bool)   { return 0; }
+#endif
+
+#if EZ_CONSOLE_USE_AVX2
+	EZ_CONSOLE_AVX2_TARGET
+	static size_t findFirstToEscapeAVX2(const char *data, size_t numBytes, bool escapeNonAscii)
+	{
+		const __m256i quote = _mm256_set1_epi8('"');
+		const __m256i backslash = _mm256_set1_epi8('\\');
+		const __m256i lastControl = _mm256_set1_epi8(0x1f);
+		const juce::uint32 highBits = escapeNonAscii ? 0xffffffffu : 0;
+		size_t i = 0;
+
+		for (; i + 32 <= numBytes; i += 32)
+		{
+			const __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+			const __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)),
+			                                        _mm256_cmpeq_epi8(_mm256_min_epu8(block, lastControl), block));
+			const juce::uint32 mask = (juce::uint32)_mm256_movemask_epi8(special) | ((juce::uint32)_mm256_movemask_epi8(block) & highBits);
+
+			if (mask != 0)
+				return i + (size_t)ConsoleSIMD::findLowestSetBit(mask);
+		}
+
+		return i + findFirstToEscapeScalar(data + i, numBytes - i, escapeNonAscii);
+	}
+#else
+	static size_t findFirstToEscapeAVX2(const char*, size_t, bool)   { return 0; }
+#endif
+
+	//==============================================================================
+	ConsoleChunkBuffer &buffer;
+	const bool isPretty, escapeNonAscii;
+	const SpillFunction spillFunction;
+	const size_t spillSize;
+	int depth = 0;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleJsonWriter)
+};
+
+//==============================================================================
+template <typename ValueType>
+struct ConsoleFormatArgument<ConsoleJsonWriter::Json<ValueType>>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const ConsoleJsonWriter::Json<ValueType> &json)
+	{
+		ConsoleJsonWriter(buffer, json.flags).write(json.value);
+	}
+};
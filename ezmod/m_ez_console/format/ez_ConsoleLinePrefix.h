@@ -0,0 +1,280 @@
+﻿#pragma once
+#define EZ_CONSOLELINEPREFIX_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Writes the timestamp, thread and level prefix of a log line.
+	       写出日志行的时间戳、线程和级别前缀。
+
+	A prefix looks like this, with each part optional:
+
+	@code
+	2026-10-17 14:03:05.123 [48213] WARN
+	@endcode
+
+	Formatting a date with juce::Time::toString looks up the time zone and
+	builds several Strings on every call. Here, each thread keeps the text of
+	the last second it wrote, so most prefixes only patch in the sub-second
+	digits; a new second within the same minute only patches two more digits,
+	and the local time is worked out again once a minute. The thread tag is
+	rendered the first time a thread writes a prefix, and the level tags are
+	constant, so a prefix is a few copies into the buffer with no allocation.
+
+	The thread is shown by its OS thread ID, the same number that debuggers
+	and system tools show.
+
+	前缀的格式如下，其中每一部分都是可选的：
+
+	@code
+	2026-10-17 14:03:05.123 [48213] WARN
+	@endcode
+
+	使用 juce::Time::toString 格式化日期时，每次调用都会查询时区并构建多个String。
+	而在这里，每个线程都会保存其上一次写出的那一秒的文本，因此大多数前缀只需填入
+	秒以下的数字；同一分钟内的新的一秒只需再多填入两位数字，本地时间每分钟才重新
+	计算一次。线程标签在线程第一次写出前缀时生成，级别标签则是常量，因此写出一个
+	前缀只是向缓冲区中进行几次拷贝，不会分配内存。
+
+	线程以其操作系统线程ID表示，与调试器和系统工具中显示的数字相同。
+
+	@see ConsoleOutputStream::prefix
+*/
+class ConsoleLinePrefix
+{
+public:
+	//==============================================================================
+	/** @brief The parts of a prefix, to be combined with "|".
+	           前缀的各个部分，可以用"|"组合。
+	*/
+	enum Fields
+	{
+		date          = 1,   /**< "2026-10-17" */
+		time          = 2,   /**< "14:03:05" */
+		milliseconds  = 4,   /**< ".123" after the time. 在时间之后。 */
+		microseconds  = 8,   /**< ".123456" after the time. 在时间之后。 */
+		threadId      = 16,  /**< "[48213]" */
+		levelName     = 32,  /**< "WARN" */
+
+		defaultFields = date | time | milliseconds | threadId | levelName
+	};
+
+	enum
+	{
+		maxChars = 64  /**< The longest output of "format". "format"的最长输出。 */
+	};
+
+	/** @brief A prefix to be written into a stream.
+	           要写入输出流的前缀。
+
+		@see ConsoleOutputStream::prefix
+	*/
+	struct Tag
+	{
+		TeeSink::Level level;
+		int fields;
+	};
+
+	//==============================================================================
+	/** @brief Writes a prefix for the current time and thread.
+	           写出当前时间和线程的前缀。
+
+		Each part that is present is followed by a space. No terminating null
+		character is added.
+
+		每个出现的部分之后都跟有一个空格。不会添加结尾的空字符。
+
+		@param dest    Where to write, with room for at least maxChars characters.
+		               写入的位置，至少要能容纳maxChars个字符。
+
+		@param level   The level to show.
+		               要显示的级别。
+
+		@param fields  The parts to write, a combination of Fields.
+		               要写出的部分，为 Fields 的组合。
+
+		@returns the number of characters written.
+		@returns 写入的字符数。
+	*/
+	static int format(char *dest, TeeSink::Level level, int fields = defaultFields)
+	{
+		char *d = dest;
+
+		if ((fields & (date | time)) != 0)
+		{
+			const juce::int64 now = (juce::int64)std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count();
+			const juce::int64 second = now / 1000000;
+			const int subSecond = (int)(now - second * 1000000);
+			const char *text = getSecondText(second);
+
+			if ((fields & date) != 0)
+			{
+				memcpy(d, text, 11);
+				d += 11;
+			}
+
+			if ((fields & time) != 0)
+			{
+				memcpy(d, text + 11, 8);
+				d += 8;
+
+				if ((fields & microseconds) != 0)
+					d = writeFraction(d, subSecond, 6);
+				else if ((fields & milliseconds) != 0)
+					d = writeFraction(d, subSecond / 1000, 3);
+
+				*d++ = ' ';
+			}
+		}
+
+		if ((fields & threadId) != 0)
+		{
+			const ThreadTag &tag = getThreadTag();
+			memcpy(d, tag.text, (size_t)tag.length);
+			d += tag.length;
+		}
+
+		if ((fields & levelName) != 0)
+		{
+			jassert(level >= 0 && level < TeeSink::numLevels);
+			memcpy(d, getLevelTags()[level], levelTagLength);
+			d += levelTagLength;
+		}
+
+		return (int)(d - dest);
+	}
+
+private:
+	//==============================================================================
+	enum
+	{
+		levelTagLength = 6
+	};
+
+	struct SecondCache
+	{
+		juce::int64 second, minuteStart;
+		char text[20];  // "YYYY-MM-DD HH:MM:SS"
+	};
+
+	struct ThreadTag
+	{
+		int length;
+		char text[32];
+	};
+
+	static const char* const* getLevelTags()
+	{
+		static const char *const tags[TeeSink::numLevels] = { "DEBUG ", "INFO  ", "WARN  ", "ERROR ", "FATAL " };
+		return tags;
+	}
+
+	// A new second in the cached minute only changes the last two digits. Time
+	// zone and daylight saving changes happen on whole minutes, so the local
+	// time is only worked out again when the minute changes.
+	static const char* getSecondText(juce::int64 second)
+	{
+		static thread_local SecondCache cache = { -1, -1, { 0 } };
+
+		if (second == cache.second)
+			return cache.text;
+
+		if (cache.minuteStart >= 0 && second >= cache.minuteStart && second < cache.minuteStart + 60)
+		{
+			writeTwoDigits(cache.text + 17, (int)(second - cache.minuteStart));
+		}
+		else
+		{
+			const time_t t = (time_t)second;
+			struct tm local;
+
+#ifdef JUCE_WINDOWS
+			localtime_s(&local, &t);
+#else
+			localtime_r(&t, &local);
+#endif
+			const int year = local.tm_year + 1900;
+
+			writeTwoDigits(cache.text, year / 100);
+			writeTwoDigits(cache.text + 2, year % 100);
+			cache.text[4] = '-';
+			writeTwoDigits(cache.text + 5, local.tm_mon + 1);
+			cache.text[7] = '-';
+			writeTwoDigits(cache.text + 8, local.tm_mday);
+			cache.text[10] = ' ';
+			writeTwoDigits(cache.text + 11, local.tm_hour);
+			cache.text[13] = ':';
+			writeTwoDigits(cache.text + 14, local.tm_min);
+			cache.text[16] = ':';
+			writeTwoDigits(cache.text + 17, local.tm_sec);
+
+			// A leap second shows as 60 and belongs to the minute before.
+			cache.minuteStart = second - juce::jmin(local.tm_sec, 59);
+		}
+
+		cache.second = second;
+		return cache.text;
+	}
+
+	static const ThreadTag& getThreadTag()
+	{
+		static thread_local ThreadTag tag = { 0, { 0 } };
+
+		if (tag.length == 0)
+		{
+			tag.text[0] = '[';
+			tag.length = 1 + ConsoleNumberFormat::formatUnsigned(getOSThreadId(), tag.text + 1);
+			tag.text[tag.length++] = ']';
+			tag.text[tag.length++] = ' ';
+		}
+
+		return tag;
+	}
+
+	static juce::uint64 getOSThreadId()
+	{
+#ifdef JUCE_WINDOWS
+		return (juce::uint64)GetCurrentThreadId();
+#elif JUCE_MAC || JUCE_IOS
+		uint64_t id = 0;
+		pthread_threadid_np(nullptr, &id);
+		return (juce::uint64)id;
+#elif defined (SYS_gettid)
+		return (juce::uint64)::syscall(SYS_gettid);
+#else
+		return (juce::uint64)(juce::pointer_sized_uint)juce::Thread::getCurrentThreadId();
+#endif
+	}
+
+	static void writeTwoDigits(char *dest, int value)
+	{
+		dest[0] = (char)('0' + value / 10);
+		dest[1] = (char)('0' + value % 10);
+	}
+
+	static char* writeFraction(char *dest, int value, int numDigits)
+	{
+		*dest = '.';
+
+		for (int i = numDigits; i > 0; --i)
+		{
+			dest[i] = (char)('0' + value % 10);
+			value /= 10;
+		}
+
+		return dest + numDigits + 1;
+	}
+};
+
+//==============================================================================
+template <>
+struct ConsoleFormatArgument<ConsoleLinePrefix::Tag>
+{
+	static constexpr bool isSupported = true;
+
+	static void write(ConsoleChunkBuffer &buffer, const ConsoleLinePrefix::Tag &tag)
+	{
+		buffer.commitWrite((size_t)ConsoleLinePrefix::format(buffer.prepareWrite(ConsoleLinePrefix::maxChars), tag.level, tag.fields));
+	}
+};
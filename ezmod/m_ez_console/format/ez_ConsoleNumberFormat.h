@@ -0,0 +1,586 @@
+﻿#pragma once
+#define EZ_CONSOLENUMBERFORMAT_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Formats numbers as text into a caller-supplied buffer.
+	       将数字格式化为文本并写入调用者提供的缓冲区。
+
+	None of these functions allocate memory. Each one writes the characters
+	into "dest", which must have room for at least the matching "max...Chars"
+	value, and returns how many characters it wrote. No terminating null
+	character is added.
+
+	Integers are written two digits at a time from a table of digit pairs.
+	Floating point values are written in the shortest form that reads back to
+	exactly the same value, using the Grisu2 algorithm (Florian Loitsch,
+	"Printing Floating-Point Numbers Quickly and Accurately with Integers").
+
+	所有函数都不会分配内存。每个函数都将字符写入"dest"，"dest"至少要能容纳对应的
+	"max...Chars"个字符，函数返回写入的字符数。不会添加结尾的空字符。
+
+	整数借助一张两位数字表每次写出两位。浮点数使用 Grisu2 算法（Florian Loitsch，
+	"Printing Floating-Point Numbers Quickly and Accurately with Integers"）以能够
+	精确读回原值的最短形式写出。
+
+	@see ConsoleOutputStream
+*/
+class ConsoleNumberFormat
+{
+public:
+	//==============================================================================
+	enum
+	{
+		maxIntegerChars  = 20,  /**< The longest output of formatSigned, formatUnsigned and formatHex. */
+		maxFloatChars    = 32,  /**< The longest output of formatDouble and formatFloat. */
+		maxDecimalPlaces = 20,  /**< The most decimal places that formatFixed will write. */
+		maxFixedChars    = 340  /**< The longest output of formatFixed. */
+	};
+
+	//==============================================================================
+	/** @brief A number to be written in hexadecimal.
+	           以十六进制写出的数字。
+
+		@see ConsoleOutputStream::hex
+	*/
+	struct Hex
+	{
+		juce::uint64 value;
+		int minNumDigits;
+		bool upperCase;
+	};
+
+	/** @brief A number to be written with a fixed number of decimal places.
+	           以固定小数位数写出的数字。
+
+		@see ConsoleOutputStream::fixed
+	*/
+	struct Fixed
+	{
+		double value;
+		int numDecimalPlaces;
+	};
+
+	//==============================================================================
+	/** @brief Writes an unsigned integer in decimal.
+	           以十进制写出一个无符号整数。
+	*/
+	static int formatUnsigned(juce::uint64 value, char *dest)
+	{
+		const int numDigits = countDecimalDigits(value);
+		char *d = dest + numDigits;
+
+		while (value >= 100)
+		{
+			const char *pair = getDigitPairs() + (value % 100) * 2;
+			value /= 100;
+			*--d = pair[1];
+			*--d = pair[0];
+		}
+
+		if (value >= 10)
+		{
+			const char *pair = getDigitPairs() + value * 2;
+			*--d = pair[1];
+			*--d = pair[0];
+		}
+		else
+		{
+			*--d = (char)('0' + value);
+		}
+
+		return numDigits;
+	}
+
+	/** @brief Writes a signed integer in decimal.
+	           以十进制写出一个有符号整数。
+	*/
+	static int formatSigned(juce::int64 value, char *dest)
+	{
+		if (value >= 0)
+			return formatUnsigned((juce::uint64)value, dest);
+
+		*dest = '-';
+		return 1 + formatUnsigned(0 - (juce::uint64)value, dest + 1);
+	}
+
+	/** @brief Writes an unsigned integer in hexadecimal, without any prefix.
+	           以十六进制写出一个无符号整数，不带任何前缀。
+
+		@param minNumDigits  Leading zeros are added up to this many digits
+		                     (at most 16).
+		                     不足该位数时补前导零（最多16位）。
+
+		@param upperCase     True to use "A" to "F" instead of "a" to "f".
+		                     设为true则使用"A"到"F"，而不是"a"到"f"。
+	*/
+	static int formatHex(juce::uint64 value, char *dest, int minNumDigits = 1, bool upperCase = false)
+	{
+		const char *digits = upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+
+		int numDigits = 1;
+
+		while (numDigits < 16 && (value >> (numDigits * 4)) != 0)
+			++numDigits;
+
+		numDigits = juce::jlimit(numDigits, 16, minNumDigits);
+
+		for (int i = numDigits; --i >= 0;)
+		{
+			dest[i] = digits[value & 15];
+			value >>= 4;
+		}
+
+		return numDigits;
+	}
+
+	//==============================================================================
+	/** @brief Writes a double in the shortest form that reads back to the same value.
+	           以能够读回原值的最短形式写出一个double。
+
+		Whole numbers keep a ".0", very large and very small values use an
+		exponent ("1.5e300"), and NaN and infinities are written as "nan",
+		"inf" and "-inf".
+
+		整数值保留".0"，极大或极小的值使用指数形式（"1.5e300"），NaN 和无穷大分别
+		写为"nan"、"inf"和"-inf"。
+	*/
+	static int formatDouble(double value, char *dest)
+	{
+		juce::uint64 bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		const int biasedExponent = (int)((bits >> 52) & 0x7ff);
+		const juce::uint64 significand = bits & 0xfffffffffffffULL;
+
+		if (biasedExponent != 0)
+			return formatBinary(dest, (bits >> 63) != 0, biasedExponent == 0x7ff, significand,
+			                    significand | (1ULL << 52), biasedExponent - 1075, significand == 0 && biasedExponent > 1);
+
+		return formatBinary(dest, (bits >> 63) != 0, false, significand, significand, -1074, false);
+	}
+
+	/** @brief Writes a float in the shortest form that reads back to the same float.
+	           以能够读回同一float值的最短形式写出一个float。
+
+		This gives "0.1" for 0.1f, where going through a double would give
+		"0.10000000149011612".
+
+		对于0.1f会写出"0.1"，而先转换为double则会写出"0.10000000149011612"。
+	*/
+	static int formatFloat(float value, char *dest)
+	{
+		juce::uint32 bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		const int biasedExponent = (int)((bits >> 23) & 0xff);
+		const juce::uint32 significand = bits & 0x7fffff;
+
+		if (biasedExponent != 0)
+			return formatBinary(dest, (bits >> 31) != 0, biasedExponent == 0xff, significand,
+			                    significand | (1u << 23), biasedExponent - 150, significand == 0 && biasedExponent > 1);
+
+		return formatBinary(dest, (bits >> 31) != 0, false, significand, significand, -149, false);
+	}
+
+	/** @brief Writes a double with a fixed number of decimal places, like printf's "%.*f".
+	           以固定的小数位数写出一个double，效果同printf的"%.*f"。
+
+		Values that can be scaled to a whole number exactly enough are written
+		with integer arithmetic. The rest, such as huge values or values that
+		sit right between two results, fall back to "snprintf" on the caller's
+		buffer, so the output is always the same as printf's.
+
+		能够足够精确地缩放为整数的值使用整数运算写出。其余的值（例如极大的值，或
+		恰好位于两个结果正中间的值）会退回到在调用者缓冲区上调用"snprintf"，因此
+		输出始终与printf相同。
+
+		@param numDecimalPlaces  The number of digits after the decimal point,
+		                         from 0 to maxDecimalPlaces.
+		                         小数点后的位数，从0到maxDecimalPlaces。
+	*/
+	static int formatFixed(double value, int numDecimalPlaces, char *dest)
+	{
+		numDecimalPlaces = juce::jlimit(0, (int)maxDecimalPlaces, numDecimalPlaces);
+
+		if (value != value)
+			return copyText(dest, "nan");
+
+		const bool isNegative = std::signbit(value);
+		const double magnitude = isNegative ? -value : value;
+		const double scaled = magnitude * getPowerOfTen(numDecimalPlaces);
+
+		if (numDecimalPlaces <= 15 && scaled < 1.0e12)
+		{
+			juce::uint64 whole = (juce::uint64)scaled;
+			const double fraction = scaled - (double)whole;
+
+			if (std::abs(fraction - 0.5) > 1.0e-3)
+			{
+				if (fraction > 0.5)
+					++whole;
+
+				char *d = dest;
+
+				if (isNegative)
+					*d++ = '-';
+
+				const juce::uint64 divisor = (juce::uint64)getPowerOfTen(numDecimalPlaces);
+				d += formatUnsigned(whole / divisor, d);
+
+				if (numDecimalPlaces > 0)
+				{
+					*d++ = '.';
+
+					juce::uint64 decimals = whole % divisor;
+
+					for (int i = numDecimalPlaces; --i >= 0;)
+					{
+						d[i] = (char)('0' + decimals % 10);
+						decimals /= 10;
+					}
+
+					d += numDecimalPlaces;
+				}
+
+				return (int)(d - dest);
+			}
+		}
+
+		if (magnitude > std::numeric_limits<double>::max())
+			return copyText(dest, isNegative ? "-inf" : "inf");
+
+		return snprintf(dest, maxFixedChars, "%.*f", numDecimalPlaces, value);
+	}
+
+private:
+	//==============================================================================
+	struct DiyFp
+	{
+		juce::uint64 f;
+		int e;
+
+		DiyFp operator- (const DiyFp &other) const
+		{
+			const DiyFp result = { f - other.f, e };
+			return result;
+		}
+
+		DiyFp operator* (const DiyFp &other) const
+		{
+			const juce::uint64 mask = 0xffffffffULL;
+			const juce::uint64 a = f >> 32, b = f & mask;
+			const juce::uint64 c = other.f >> 32, d = other.f & mask;
+			const juce::uint64 ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+
+			juce::uint64 middle = (bd >> 32) + (ad & mask) + (bc & mask);
+			middle += 1ULL << 31;
+
+			const DiyFp result = { ac + (ad >> 32) + (bc >> 32) + (middle >> 32), e + other.e + 64 };
+			return result;
+		}
+
+		DiyFp normalized() const
+		{
+			DiyFp result = *this;
+
+			while ((result.f & (1ULL << 63)) == 0)
+			{
+				result.f <<= 1;
+				--result.e;
+			}
+
+			return result;
+		}
+	};
+
+	//==============================================================================
+	static int formatBinary(char *dest, bool isNegative, bool isSpecial, juce::uint64 significandBits,
+	                        juce::uint64 significand, int exponent, bool lowerBoundaryIsCloser)
+	{
+		char *d = dest;
+
+		if (isSpecial)
+			return copyText(dest, significandBits != 0 ? "nan" : (isNegative ? "-inf" : "inf"));
+
+		if (isNegative)
+			*d++ = '-';
+
+		if (significand == 0)
+			return (int)(d - dest) + copyText(d, "0.0");
+
+		int length, decimalExponent;
+		grisu2(significand, exponent, lowerBoundaryIsCloser, d, length, decimalExponent);
+
+		return (int)(d - dest) + prettify(d, length, decimalExponent);
+	}
+
+	static void grisu2(juce::uint64 significand, int exponent, bool lowerBoundaryIsCloser,
+	                   char *digits, int &length, int &decimalExponent)
+	{
+		const DiyFp v = { significand, exponent };
+
+		DiyFp upper = { (significand << 1) + 1, exponent - 1 };
+		upper = upper.normalized();
+
+		DiyFp lower = { (significand << 1) - 1, exponent - 1 };
+
+		if (lowerBoundaryIsCloser)
+		{
+			lower.f = (significand << 2) - 1;
+			lower.e = exponent - 2;
+		}
+
+		lower.f <<= lower.e - upper.e;
+		lower.e = upper.e;
+
+		const DiyFp cachedPower = getCachedPower(upper.e, decimalExponent);
+		const DiyFp w = v.normalized() * cachedPower;
+		DiyFp wPlus = upper * cachedPower;
+		DiyFp wMinus = lower * cachedPower;
+		++wMinus.f;
+		--wPlus.f;
+
+		generateDigits(w, wPlus, wPlus.f - wMinus.f, digits, length, decimalExponent);
+	}
+
+	static void generateDigits(const DiyFp &w, const DiyFp &upper, juce::uint64 delta,
+	                           char *digits, int &length, int &decimalExponent)
+	{
+		const DiyFp one = { 1ULL << -upper.e, upper.e };
+		const DiyFp distance = upper - w;
+
+		juce::uint32 integral = (juce::uint32)(upper.f >> -one.e);
+		juce::uint64 fractional = upper.f & (one.f - 1);
+
+		int kappa = countDecimalDigits(integral);
+		length = 0;
+
+		while (kappa > 0)
+		{
+			const juce::uint32 divisor = (juce::uint32)getPowerOfTen(kappa - 1);
+			const juce::uint32 digit = integral / divisor;
+			integral %= divisor;
+
+			if (digit != 0 || length != 0)
+				digits[length++] = (char)('0' + digit);
+
+			--kappa;
+
+			const juce::uint64 rest = ((juce::uint64)integral << -one.e) + fractional;
+
+			if (rest <= delta)
+			{
+				decimalExponent += kappa;
+				roundWeed(digits, length, delta, rest, (juce::uint64)getPowerOfTen(kappa) << -one.e, distance.f);
+				return;
+			}
+		}
+
+		for (;;)
+		{
+			fractional *= 10;
+			delta *= 10;
+
+			const char digit = (char)(fractional >> -one.e);
+
+			if (digit != 0 || length != 0)
+				digits[length++] = (char)('0' + digit);
+
+			fractional &= one.f - 1;
+			--kappa;
+
+			if (fractional < delta)
+			{
+				decimalExponent += kappa;
+				roundWeed(digits, length, delta, fractional, one.f,
+				          -kappa < 20 ? distance.f * (juce::uint64)getPowerOfTen(-kappa) : 0);
+				return;
+			}
+		}
+	}
+
+	static void roundWeed(char *digits, int length, juce::uint64 delta, juce::uint64 rest,
+	                      juce::uint64 tenKappa, juce::uint64 distance)
+	{
+		while (rest < distance && delta - rest >= tenKappa
+		       && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance))
+		{
+			--digits[length - 1];
+			rest += tenKappa;
+		}
+	}
+
+	static int prettify(char *digits, int length, int decimalExponent)
+	{
+		// The value is digits * 10^decimalExponent, with 10^(point-1) <= value < 10^point
+		const int point = length + decimalExponent;
+
+		if (decimalExponent >= 0 && point <= 21)
+		{
+			for (int i = length; i < point; ++i)
+				digits[i] = '0';
+
+			digits[point] = '.';
+			digits[point + 1] = '0';
+			return point + 2;
+		}
+
+		if (point > 0 && point <= 21)
+		{
+			memmove(digits + point + 1, digits + point, (size_t)(length - point));
+			digits[point] = '.';
+			return length + 1;
+		}
+
+		if (point > -6 && point <= 0)
+		{
+			const int offset = 2 - point;
+			memmove(digits + offset, digits, (size_t)length);
+			digits[0] = '0';
+			digits[1] = '.';
+
+			for (int i = 2; i < offset; ++i)
+				digits[i] = '0';
+
+			return length + offset;
+		}
+
+		int end;
+
+		if (length == 1)
+		{
+			end = 1;
+		}
+		else
+		{
+			memmove(digits + 2, digits + 1, (size_t)(length - 1));
+			digits[1] = '.';
+			end = length + 1;
+		}
+
+		digits[end++] = 'e';
+
+		int exponent = point - 1;
+
+		if (exponent < 0)
+		{
+			digits[end++] = '-';
+			exponent = -exponent;
+		}
+
+		return end + formatUnsigned((juce::uint64)exponent, digits + end);
+	}
+
+	//==============================================================================
+	static DiyFp getCachedPower(int binaryExponent, int &decimalExponent)
+	{
+		// Normalised 64-bit approximations of 10^-348, 10^-340, ..., 10^340
+		static const juce::uint64 significands[] =
+		{
+			0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+			0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+			0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+			0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+			0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+			0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+			0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+			0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+			0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+			0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+			0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+			0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+			0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+			0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+			0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+			0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+			0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+			0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+			0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+			0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+			0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+			0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+			0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+			0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+			0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+			0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+			0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+			0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+			0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+		};
+
+		static const short exponents[] =
+		{
+			-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954,
+			-927, -901, -874, -847, -821, -794, -768, -741, -715, -688, -661,
+			-635, -608, -582, -555, -529, -502, -475, -449, -422, -396, -369,
+			-343, -316, -289, -263, -236, -210, -183, -157, -130, -103, -77,
+			-50, -24, 3, 30, 56, 83, 109, 136, 162, 189, 216,
+			242, 269, 295, 322, 348, 375, 402, 428, 455, 481, 508,
+			534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800,
+			827, 853, 880, 907, 933, 960, 986, 1013, 1039, 1066
+		};
+
+		// Picks the power that brings the scaled exponent into [-60, -32]
+		const double k = (-61 - binaryExponent) * 0.30102999566398114 + 347;
+		int ik = (int)k;
+
+		if (k - ik > 0.0)
+			++ik;
+
+		const int index = (ik >> 3) + 1;
+		decimalExponent = -(-348 + index * 8);
+
+		const DiyFp result = { significands[index], exponents[index] };
+		return result;
+	}
+
+	static double getPowerOfTen(int power)
+	{
+		static const double powers[] =
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+			1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20
+		};
+
+		return powers[power];
+	}
+
+	static int countDecimalDigits(juce::uint64 value)
+	{
+		int numDigits = 1;
+
+		for (;;)
+		{
+			if (value < 10)     return numDigits;
+			if (value < 100)    return numDigits + 1;
+			if (value < 1000)   return numDigits + 2;
+			if (value < 10000)  return numDigits + 3;
+
+			value /= 10000;
+			numDigits += 4;
+		}
+	}
+
+	static const char* getDigitPairs()
+	{
+		return "00010203040506070809"
+		       "10111213141516171819"
+		       "20212223242526272829"
+		       "30313233343536373839"
+		       "40414243444546474849"
+		       "50515253545556575859"
+		       "60616263646566676869"
+		       "70717273747576777879"
+		       "80818283848586878889"
+		       "90919293949596979899";
+	}
+
+	static int copyText(char *dest, const char *text)
+	{
+		const int length = (int)strlen(text);
+		memcpy(dest, text, (size_t)length);
+		return length;
+	}
+};
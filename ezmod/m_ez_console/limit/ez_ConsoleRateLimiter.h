@@ -0,0 +1,158 @@
+﻿#pragma once
+#define EZ_CONSOLERATELIMITER_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Decides which messages may be written, by rate and by sampling.
+	       按速率和采样决定哪些消息可以被写出。
+
+	Each message asks "admit" first. With sampling, only one message in every
+	N is considered at all. Then a token bucket lets through a burst of
+	messages at once and, after that, no more than the given rate. Whatever
+	is not admitted is counted, so the loss can be reported.
+
+	The bucket is kept as a single atomic time stamp (the "generic cell rate
+	algorithm"), so the limiter can be shared between threads without a lock,
+	and rejecting a message is one load and one compare, with nothing written
+	but the counter.
+
+	每条消息都先询问"admit"。使用采样时，每N条消息中只有一条会被考虑。然后，令牌桶
+	允许一次通过一批突发的消息，在那之后则不超过给定的速率。未被准许的消息都会被
+	计数，以便报告丢失的数量。
+
+	令牌桶以单个原子时间戳的形式保存（即"通用信元速率算法"），因此该限制器可以在
+	多个线程之间无锁共享，拒绝一条消息只需一次读取和一次比较，除计数器外不写入任何
+	数据。
+
+	@see ConsoleOutputStream::admit, EZ_CONSOLE_LIMITED
+*/
+class ConsoleRateLimiter
+{
+public:
+	//==============================================================================
+	/** @brief Creates a limiter.
+	           创建一个限制器。
+
+		@param messagesPerSecond  The rate that messages are admitted at once the
+		                          burst is used up, or 0 for no limit.
+		                          突发额度用完后准许消息的速率，设为0则不限制。
+
+		@param burstSize          How many messages may be admitted at once.
+		                          The default value is 1.
+		                          一次最多可以准许的消息数量。默认值是1。
+
+		@param sampleEvery        Only one message in this many is considered, or
+		                          1 to consider them all. The default value is 1.
+		                          每这么多条消息中只考虑一条，设为1则考虑全部消息。
+		                          默认值是1。
+	*/
+	explicit ConsoleRateLimiter(double messagesPerSecond, int burstSize = 1, int sampleEvery = 1)
+		: sampleInterval((juce::uint64)juce::jmax(1, sampleEvery))
+	{
+		if (messagesPerSecond > 0.0)
+		{
+			emissionInterval = juce::jmax((juce::int64)1,
+				(juce::int64)((double)juce::Time::getHighResolutionTicksPerSecond() / messagesPerSecond));
+
+			burstWindow = emissionInterval * juce::jmax(1, burstSize);
+		}
+	}
+
+	//==============================================================================
+	/** @brief Returns true if the next message may be written.
+	           如果下一条消息可以被写出，返回true。
+
+		Each call stands for one message, and a message that is refused is
+		counted as suppressed.
+
+		每次调用代表一条消息，被拒绝的消息会被计为已抑制。
+	*/
+	bool admit()
+	{
+		if (sampleInterval > 1 && sampleCounter.fetch_add(1, std::memory_order_relaxed) % sampleInterval != 0)
+			return suppress();
+
+		if (emissionInterval > 0)
+		{
+			const juce::int64 now = juce::Time::getHighResolutionTicks();
+			juce::int64 arrival = theoreticalArrival.load(std::memory_order_relaxed);
+
+			for (;;)
+			{
+				const juce::int64 nextArrival = juce::jmax(arrival, now) + emissionInterval;
+
+				if (nextArrival - now > burstWindow)
+					return suppress();
+
+				if (theoreticalArrival.compare_exchange_weak(arrival, nextArrival, std::memory_order_relaxed))
+					break;
+			}
+		}
+
+		numAdmitted.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	/** @brief Gives back the place of a message that "admit" let through but that
+	           was not written after all, for example because another limit refused it.
+	           归还一条被"admit"准许但最终没有写出的消息所占的名额，例如因为另一个限制
+	           拒绝了它。
+
+		Only the rate is given back. With sampling, the message still counts
+		as the one in N that was considered.
+
+		只归还速率上的名额。使用采样时，该消息仍被算作N条中被考虑的那一条。
+	*/
+	void refund()
+	{
+		if (emissionInterval > 0)
+			theoreticalArrival.fetch_sub(emissionInterval, std::memory_order_relaxed);
+
+		numAdmitted.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	//==============================================================================
+	/** @brief Returns how many messages have been admitted.
+	           返回已被准许的消息数量。
+	*/
+	juce::uint64 getNumAdmitted() const
+	{
+		return numAdmitted.load(std::memory_order_relaxed);
+	}
+
+	/** @brief Returns how many messages have been suppressed since the last call to
+	           "takeNumSuppressed".
+	           返回自上次调用"takeNumSuppressed"以来被抑制的消息数量。
+	*/
+	juce::uint64 getNumSuppressed() const
+	{
+		return numSuppressed.load(std::memory_order_relaxed);
+	}
+
+	/** @brief Returns how many messages have been suppressed and sets the count back
+	           to zero, for reporting them periodically.
+	           返回被抑制的消息数量并将其归零，用于定期报告。
+	*/
+	juce::uint64 takeNumSuppressed()
+	{
+		return numSuppressed.exchange(0, std::memory_order_relaxed);
+	}
+
+private:
+	//==============================================================================
+	bool suppress()
+	{
+		numSuppressed.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	//==============================================================================
+	const juce::uint64 sampleInterval;
+	juce::int64 emissionInterval = 0, burstWindow = 0;
+
+	std::atomic<juce::uint64> sampleCounter { 0 }, numAdmitted { 0 }, numSuppressed { 0 };
+	std::atomic<juce::int64> theoreticalArrival { 0 };
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleRateLimiter)
+};
@@ -25,163 +25,97 @@ END_JUCE_MODULE_DECLARATION
 
 #include <juce_core/juce_core.h>
 
-#ifdef JUCE_WINDOWS
-#include <Windows.h>
-
-#else
-#include <iostream>
-#endif
-
 //==============================================================================
-/**
-
-    @brief Writes data to standard output stream.
-	       向标准输出流输出数据。
-
-	This is use to take over the "cout" object in the stardard library.
-
-	The usage of this class is somewhat like the "MemoryOutputStream" in JUCE.
-
-	By using this class, you can have a strong compatibility to the build-in
-	JUCE data types.
-
-	And, you can output UTF-8 strings by using this class in whatever compiling
-	environment, which is not possible using cout in VC compiler.
-
-	We also provide a "command" method, which have the same function as "system".
-
-	Important: Be sure to call "InitUTF8Console" before any UTF-8 outputs.
-
-	Note that we only support UTF-8 outputs in Windows in current version.
-
-	该类被用于取代C++标准库里的传统"cout"对象。
-
-	该类的使用方法与 JUCE 的 MemoryOutputStream 类很相似。
-
-	该类与 JUCE 的内置数据类型具有很强的兼容性。
-
-	使用该类，您可以在任何编译环境下输出UTF-8字符串。这是使用cout在VC编译器中
-	无法实现的。
-
-	同时，我们还提供了了一个"command"方法，该方法与"system"函数作用相同。
-
-	重要！请在输出任何UTF-8数据之前调用"InitUTF8Console"。
-
-	注意：当前版本的UTF-8数据输出功能暂时只支持Windows系统。
+/** Config: EZ_CONSOLE_ENABLE_STATS
 
+	Enables the counters and the print latency histogram of ConsoleOutputStream,
+	see ConsoleOutputStream::getStats. When disabled, they cost nothing.
 */
-class ConsoleOutputStream : public juce::MemoryOutputStream
-{
-public:
-	//==============================================================================
-	/** @brief Creates an empty console output stream, ready to be written into.
-	           创建一个空的控制台输出流。
-	*/
-	ConsoleOutputStream()
-	{
-		reset();
-	}
-
-	/** @brief Destructor.
-	           析构函数。
-	*/
-	~ConsoleOutputStream()
-	{
-		reset();
-	}
-
-	//==============================================================================
-	/** @brief Initialize console for UTF-8 data outputs (Windows only method). 
-	           为UTF-8输出初始化控制台。（该方法只在Windows环境下有效）
-
-		Call this before any UTF-8 outputs!
-
-		在输出UTF-8数据之前请务必先调用此方法！
-
-		@returns the BOOL result of setting console font action in Windows in order
-		         to support UTF-8 display, or a 0 in other operating system. 
-	    @returns 返回Windows控制台用来支持UTF-8数据显示的修改字体操作的 BOOL 类型
-				 结果，或者当编译环境为非Windows的其他系统时返回0。
-	*/
-	int InitUTF8Console()
-	{
-#ifdef JUCE_WINDOWS
-		hConsoleOutput = GetStdHandle(STD_OUTPUT_HANDLE);
-
-		system("chcp 65001");
-
-		CONSOLE_FONT_INFOEX info = { 0 };
-		info.cbSize = sizeof(info);
-		info.dwFontSize.Y = 16;
-		info.FontWeight = FW_NORMAL;
-		wcscpy(info.FaceName, L"Consolas");
-
-		return SetCurrentConsoleFontEx(hConsoleOutput, NULL, &info);
-#else
-		return 0;
+#ifndef EZ_CONSOLE_ENABLE_STATS
+ #define EZ_CONSOLE_ENABLE_STATS 0
 #endif
-	}
-
-	/** @brief Print the data in the OutputStram to the console.
-	           向控制台中输出OutputStream（输出流）中的数据。
-
-		Remember to call "InitUTF8Console" before calling this if
-		you have UTF-8 encoded data inserted in your output stream.
-
-		In other OS, this method will use the standard "cout" to
-		output the data stored in the output stream.
-
-		如果您的输出内容中有UTF-8编码的数据，请在调用本方法之前先调用
-		"InitUTF8Console"方法。
 
-		在非Windows的其他系统中，该方法会使用传统的"cout"来输出输出流
-		中的数据。
-
-		@returns the BOOL result of "WriteConsole" function in Windows,
-		         or a 0 in other operating system.
-		@returns 返回Windows API "WriteConsole"的BOOL结果，或者当编译
-				 环境为非Windows的其他系统时返回0。
-
-		@see InitUTF8Console
-	*/
-	int printData()
-	{
 #ifdef JUCE_WINDOWS
-		DWORD dw;
-		BOOL bResult;
-
-		if (hConsoleOutput == nullptr) hConsoleOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+#include <Windows.h>
 
-		bResult = WriteConsole(hConsoleOutput, getData(), getDataSize(), &dw, NULL);
 #else
-		std::cout << toString();
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #endif
 
-		reset();
-
-#ifdef JUCE_WINDOWS
-		return bResult;
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <ctime>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <utility>
+
+#if JUCE_INTEL && (defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+ #define EZ_CONSOLE_USE_SSE2 1
+ #include <immintrin.h>
 #else
-		return 0;
+ #define EZ_CONSOLE_USE_SSE2 0
 #endif
-	}
-
-	//==============================================================================
-	/** @brief Same as "system" function. Do nothing but returns 0 in other os.
-	           作用同"system"函数。非Windows的其他系统下无任何动作并返回0。
-	*/
-	int command(char *cmd)
-	{
-#ifdef JUCE_WINDOWS
-		return system(cmd);
+
+#if EZ_CONSOLE_USE_SSE2 && (defined (_MSC_VER) || defined (__clang__) || defined (__GNUC__))
+ #define EZ_CONSOLE_USE_AVX2 1
+ #ifdef _MSC_VER
+  #define EZ_CONSOLE_AVX2_TARGET
+ #else
+  #define EZ_CONSOLE_AVX2_TARGET __attribute__ ((target ("avx2")))
+ #endif
 #else
-		return 0;
+ #define EZ_CONSOLE_USE_AVX2 0
 #endif
-	}
 
-private:
-	//==============================================================================
-#ifdef JUCE_WINDOWS
-	HANDLE hConsoleOutput;
-#endif
-};
+#include "containers/ez_LockFreeQueue.h"
+#include "buffer/ez_ConsoleChunkBuffer.h"
+#include "simd/ez_ConsoleSIMD.h"
+#include "text/ez_ConsoleUTF8.h"
+#include "text/ez_ConsoleDisplayWidth.h"
+#include "format/ez_ConsoleNumberFormat.h"
+#include "format/ez_ConsoleFormatArgument.h"
+#include "format/ez_ConsoleFormatString.h"
+#include "format/ez_ConsoleJsonWriter.h"
+#include "format/ez_ConsoleHexDump.h"
+#include "binlog/ez_ConsoleLogFormat.h"
+#include "binlog/ez_ConsoleLogRecord.h"
+#include "binlog/ez_ConsoleLogReader.h"
+#include "limit/ez_ConsoleRateLimiter.h"
+#include "stats/ez_ConsoleLatencyHistogram.h"
+#include "stats/ez_ConsoleStreamStats.h"
+#include "terminal/ez_ConsoleCapabilities.h"
+#include "sinks/ez_ConsoleSink.h"
+#include "sinks/ez_SynchronisedSink.h"
+#include "sinks/ez_FileSink.h"
+#include "sinks/ez_MappedFileSink.h"
+#include "sinks/ez_RotatingFileSink.h"
+#include "sinks/ez_MemoryRingSink.h"
+#include "sinks/ez_CallbackSink.h"
+#include "stream/ez_ConsoleAsyncWriter.h"
+#include "sinks/ez_TeeSink.h"
+#include "format/ez_ConsoleLinePrefix.h"
+#include "process/ez_ConsoleProcess.h"
+#include "process/ez_ConsoleProcessRunner.h"
+#include "stream/ez_ConsoleFlushTimer.h"
+#include "stream/ez_ConsoleCrashHandler.h"
+#include "stream/ez_ConsoleAwaitable.h"
+#include "stream/ez_ConsoleOutputStream.h"
+#include "stream/ez_ConcurrentConsoleStream.h"
+#include "stream/ez_ConsoleInputStream.h"
+#include "terminal/ez_ConsoleLiveRegion.h"
+#include "terminal/ez_ConsoleTable.h"
@@ -0,0 +1,639 @@
+﻿#pragma once
+#define EZ_CONSOLEPROCESS_H_INCLUDED
+
+#ifndef JUCE_WINDOWS
+extern char **environ;
+#endif
+
+//==============================================================================
+/**
+
+    @brief Launches a child process and streams its output as it arrives.
+	       启动一个子进程，并在其输出到达时以流的方式传递出来。
+
+	The program is started directly, without a shell: with "posix_spawn" in
+	POSIX systems and "CreateProcess" in Windows. Its standard output and
+	standard error go into pipes that a thread of this object reads, and each
+	piece of data is passed to a callback as soon as it is read, so the caller
+	never has to wait for the child to exit to see its output. The standard
+	input is inherited.
+
+	When the child exits, the exit code becomes available through a future, so
+	it can be waited for with or without a time limit, or just checked. A
+	timeout given to "start" kills the child if it runs for longer.
+
+	Each object runs one process. The destructor waits for the process to exit,
+	so call "kill" first if it should not.
+
+	程序被直接启动，不经过shell：在POSIX系统中使用"posix_spawn"，在Windows中使用
+	"CreateProcess"。其标准输出和标准错误输出进入管道，由该对象的一个线程读取，每段
+	数据一经读取就被交给回调函数，因此调用者永远不需要等待子进程退出才能看到它的
+	输出。标准输入则被继承。
+
+	子进程退出后，其退出码可以通过一个 future 取得，因此可以有时限或无时限地等待，
+	也可以只是检查一下。传给"start"的超时时间会在子进程运行过久时将其终止。
+
+	每个对象只运行一个进程。析构函数会等待进程退出，如果不希望等待，请先调用
+	"kill"。
+
+	@see ConsoleProcessRunner, ConsoleOutputStream::command
+*/
+class ConsoleProcess : private juce::Thread
+{
+public:
+	//==============================================================================
+	/** @brief Which output of the child a piece of data comes from.
+	           一段数据来自子进程的哪个输出。
+	*/
+	enum OutputChannel
+	{
+		standardOutput, /**< The child's standard output.
+		                     子进程的标准输出。 */
+		standardError   /**< The child's standard error.
+		                     子进程的标准错误输出。 */
+	};
+
+	/** @brief Receives the output of the child, on the thread of the ConsoleProcess.
+	           在 ConsoleProcess 的线程上接收子进程的输出。
+	*/
+	typedef std::function<void(OutputChannel channel, const char *data, size_t numBytes)> OutputCallback;
+
+	//==============================================================================
+	/** @brief Creates an object that is ready to start a process.
+	           创建一个准备启动进程的对象。
+	*/
+	ConsoleProcess()
+		: juce::Thread("ConsoleProcess"),
+		  exitCode(exitCodePromise.get_future().share())
+	{
+	}
+
+	/** @brief Destructor. Waits for the process to exit.
+	           析构函数。等待进程退出。
+	*/
+	~ConsoleProcess()
+	{
+		waitForThreadToExit(-1);
+	}
+
+	//==============================================================================
+	/** @brief Starts a program with a list of arguments.
+	           以一个参数列表启动一个程序。
+
+		@param arguments            The program, then its arguments. The program is
+		                            looked for in the PATH if it has no directory.
+		                            程序，然后是它的参数。如果程序没有目录，则在PATH中
+		                            查找。
+
+		@param callback             Receives the output as it arrives, or nullptr to
+		                            throw the output away.
+		                            在输出到达时接收输出，设为nullptr则丢弃输出。
+
+		@param timeoutMilliseconds  How long the process may run before it is killed,
+		                            or -1 to let it run. The default value is -1.
+		                            进程在被终止之前最多可以运行多久，设为-1则不限制。
+		                            默认值是-1。
+
+		@returns false if the program could not be started, in which case the exit
+		         code is -1.
+		@returns 程序无法启动时返回false，此时退出码为-1。
+	*/
+	bool start(const juce::StringArray &arguments, OutputCallback callback = nullptr, int timeoutMilliseconds = -1)
+	{
+		// Each ConsoleProcess runs one process only.
+		jassert(!hasStarted);
+
+		if (hasStarted || arguments.size() == 0)
+			return false;
+
+		hasStarted = true;
+		outputCallback = callback;
+
+#ifdef JUCE_WINDOWS
+		const bool launched = launch(buildCommandLine(arguments));
+#else
+		const bool launched = launch(arguments);
+#endif
+
+		return startThreadIfLaunched(launched, timeoutMilliseconds);
+	}
+
+	/** @brief Starts a program from a command line.
+	           从一个命令行启动一个程序。
+
+		In Windows, the command line is passed to "CreateProcess" as it is. In
+		other OS, it is split into arguments at the spaces, keeping quoted
+		strings together, as juce::ChildProcess does. Either way no shell is
+		involved, so use "cmd /c" or "/bin/sh -c" for shell commands.
+
+		在Windows中，命令行被原样传给"CreateProcess"。在其他系统中，它按空格被拆分为
+		参数，引号中的字符串保持完整，与 juce::ChildProcess 的做法相同。无论哪种情况
+		都不经过shell，因此执行shell命令时请使用"cmd /c"或"/bin/sh -c"。
+
+		@see start
+	*/
+	bool start(const juce::String &commandLine, OutputCallback callback = nullptr, int timeoutMilliseconds = -1)
+	{
+#ifdef JUCE_WINDOWS
+		jassert(!hasStarted);
+
+		if (hasStarted || commandLine.trim().isEmpty())
+			return false;
+
+		hasStarted = true;
+		outputCallback = callback;
+
+		return startThreadIfLaunched(launch(commandLine), timeoutMilliseconds);
+#else
+		juce::StringArray arguments;
+		arguments.addTokens(commandLine, true);
+		arguments.removeEmptyStrings(true);
+
+		for (int i = 0; i < arguments.size(); ++i)
+			arguments.set(i, arguments[i].unquoted());
+
+		return start(arguments, callback, timeoutMilliseconds);
+#endif
+	}
+
+	//==============================================================================
+	/** @brief Returns a callback that writes all the output into a stream.
+	           返回一个将所有输出写入一个输出流的回调函数。
+
+		The stream is written from the thread of the ConsoleProcess, so no other
+		thread should write to it while the process runs.
+
+		输出流会在 ConsoleProcess 的线程中被写入，因此在进程运行期间不应有其他线程
+		写入该输出流。
+	*/
+	static OutputCallback writeTo(juce::OutputStream &destination)
+	{
+		return [&destination] (OutputChannel, const char *data, size_t numBytes)
+		{
+			destination.write(data, numBytes);
+		};
+	}
+
+	//==============================================================================
+	/** @brief Returns true if the process has been started and has not finished.
+	           如果进程已启动且尚未结束，返回true。
+	*/
+	bool isRunning() const
+	{
+		return hasStarted && !hasFinished.load();
+	}
+
+	/** @brief Returns the future exit code of the process.
+	           返回进程未来的退出码。
+
+		A process killed by a signal has an exit code of 128 plus the signal
+		number, as in a shell. If the process could not be started, the exit
+		code is -1.
+
+		被信号终止的进程，其退出码为128加上信号编号，与shell相同。如果进程无法启动，
+		退出码为-1。
+	*/
+	std::shared_future<int> getExitCode() const
+	{
+		return exitCode;
+	}
+
+	/** @brief Waits for the process to exit.
+	           等待进程退出。
+
+		@param timeoutMilliseconds  How long to wait, or -1 to wait for as long as
+		                            it takes.
+		                            等待的时长，设为-1则一直等待。
+
+		@returns true if the process has exited.
+		@returns 进程已退出时返回true。
+	*/
+	bool waitForExit(int timeoutMilliseconds = -1) const
+	{
+		if (timeoutMilliseconds < 0)
+		{
+			exitCode.wait();
+			return true;
+		}
+
+		return exitCode.wait_for(std::chrono::milliseconds(timeoutMilliseconds)) == std::future_status::ready;
+	}
+
+	/** @brief Kills the process if it is still running.
+	           如果进程仍在运行，将其终止。
+
+		@returns false if the process was not running.
+		@returns 进程不在运行时返回false。
+	*/
+	bool kill()
+	{
+		if (!isRunning())
+			return false;
+
+		killRequested = true;
+		killProcess();
+		return true;
+	}
+
+	/** @brief Returns true if the process was killed because it ran out of time.
+	           如果进程因超时而被终止，返回true。
+	*/
+	bool hasTimedOut() const
+	{
+		return timedOut.load();
+	}
+
+private:
+	//==============================================================================
+	bool startThreadIfLaunched(bool launched, int timeoutMilliseconds)
+	{
+		if (!launched)
+		{
+			finish(-1);
+			return false;
+		}
+
+		hasDeadline = timeoutMilliseconds >= 0;
+		deadline = juce::Time::getMillisecondCounter() + (juce::uint32)juce::jmax(0, timeoutMilliseconds);
+
+		startThread();
+		return true;
+	}
+
+	void deliver(OutputChannel channel, const char *data, size_t numBytes)
+	{
+		if (outputCallback != nullptr)
+			outputCallback(channel, data, numBytes);
+	}
+
+	void finish(int code)
+	{
+		hasFinished = true;
+		exitCodePromise.set_value(code);
+	}
+
+	bool isPastDeadline() const
+	{
+		return hasDeadline && (juce::int32)(juce::Time::getMillisecondCounter() - deadline) >= 0;
+	}
+
+	void killForTimeout()
+	{
+		timedOut = true;
+		killProcess();
+	}
+
+#ifdef JUCE_WINDOWS
+	//==============================================================================
+	static juce::String quoteArgument(const juce::String &argument)
+	{
+		if (argument.isNotEmpty() && !argument.containsAnyOf(" \t\""))
+			return argument;
+
+		juce::String result("\"");
+		int numBackslashes = 0;
+
+		for (juce::String::CharPointerType p(argument.getCharPointer()); !p.isEmpty(); ++p)
+		{
+			const juce::juce_wchar c = *p;
+
+			if (c == '\\')
+			{
+				++numBackslashes;
+				continue;
+			}
+
+			result << juce::String::repeatedString("\\", c == '"' ? numBackslashes * 2 + 1 : numBackslashes);
+			result << juce::String::charToString(c);
+			numBackslashes = 0;
+		}
+
+		return result + juce::String::repeatedString("\\", numBackslashes * 2) + "\"";
+	}
+
+	static juce::String buildCommandLine(const juce::StringArray &arguments)
+	{
+		juce::StringArray quoted;
+
+		for (int i = 0; i < arguments.size(); ++i)
+			quoted.add(quoteArgument(arguments[i]));
+
+		return quoted.joinIntoString(" ");
+	}
+
+	bool launch(const juce::String &commandLine)
+	{
+		SECURITY_ATTRIBUTES security = { sizeof(security), NULL, TRUE };
+		HANDLE writeEnds[2] = { NULL, NULL };
+
+		for (int i = 0; i < 2; ++i)
+		{
+			if (!CreatePipe(&pipes[i], &writeEnds[i], &security, 0))
+			{
+				closePipes(writeEnds);
+				closePipes(pipes);
+				return false;
+			}
+
+			SetHandleInformation(pipes[i], HANDLE_FLAG_INHERIT, 0);
+		}
+
+		STARTUPINFOW startupInfo = { 0 };
+		startupInfo.cb = sizeof(startupInfo);
+		startupInfo.dwFlags = STARTF_USESTDHANDLES;
+		startupInfo.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+		startupInfo.hStdOutput = writeEnds[0];
+		startupInfo.hStdError = writeEnds[1];
+
+		// CreateProcessW may write into the command line, so it needs a copy.
+		const size_t numChars = wcslen(commandLine.toWideCharPointer()) + 1;
+		juce::HeapBlock<wchar_t> commandLineCopy(numChars);
+		memcpy(commandLineCopy, commandLine.toWideCharPointer(), numChars * sizeof(wchar_t));
+
+		PROCESS_INFORMATION processInfo;
+		const BOOL created = CreateProcessW(NULL, commandLineCopy, NULL, NULL, TRUE, 0, NULL, NULL,
+			&startupInfo, &processInfo);
+
+		closePipes(writeEnds);
+
+		if (!created)
+		{
+			closePipes(pipes);
+			return false;
+		}
+
+		CloseHandle(processInfo.hThread);
+
+		const juce::ScopedLock sl(processLock);
+		hProcess = processInfo.hProcess;
+		return true;
+	}
+
+	static void closePipes(HANDLE *handles)
+	{
+		for (int i = 0; i < 2; ++i)
+		{
+			if (handles[i] != NULL)
+				CloseHandle(handles[i]);
+
+			handles[i] = NULL;
+		}
+	}
+
+	void killProcess()
+	{
+		const juce::ScopedLock sl(processLock);
+
+		if (hProcess != NULL)
+			TerminateProcess(hProcess, 1);
+	}
+
+	void run() override
+	{
+		char data[65536];
+
+		while (pipes[0] != NULL || pipes[1] != NULL)
+		{
+			bool readAnything = false;
+
+			for (int i = 0; i < 2; ++i)
+			{
+				DWORD numAvailable = 0, numRead = 0;
+
+				if (pipes[i] == NULL)
+					continue;
+
+				if (!PeekNamedPipe(pipes[i], NULL, 0, NULL, &numAvailable, NULL))
+				{
+					CloseHandle(pipes[i]);
+					pipes[i] = NULL;
+				}
+				else if (numAvailable > 0 && ReadFile(pipes[i], data, juce::jmin(numAvailable, (DWORD)sizeof(data)), &numRead, NULL) && numRead > 0)
+				{
+					deliver(i == 0 ? standardOutput : standardError, data, numRead);
+					readAnything = true;
+				}
+			}
+
+			if (killRequested.load())
+				break;
+
+			if (isPastDeadline())
+			{
+				killForTimeout();
+				break;
+			}
+
+			if (!readAnything)
+				wait(1);
+		}
+
+		closePipes(pipes);
+
+		WaitForSingleObject(hProcess, INFINITE);
+
+		DWORD code = 0;
+		GetExitCodeProcess(hProcess, &code);
+
+		{
+			const juce::ScopedLock sl(processLock);
+			CloseHandle(hProcess);
+			hProcess = NULL;
+		}
+
+		finish((int)code);
+	}
+
+	//==============================================================================
+	HANDLE pipes[2] = { NULL, NULL };
+	HANDLE hProcess = NULL;
+#else
+	//==============================================================================
+	static bool createPipe(int *fds)
+	{
+ #if JUCE_LINUX
+		return ::pipe2(fds, O_CLOEXEC) == 0;
+ #else
+		if (::pipe(fds) != 0)
+			return false;
+
+		::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+		::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+		return true;
+ #endif
+	}
+
+	static void closePipes(int *fds)
+	{
+		for (int i = 0; i < 2; ++i)
+		{
+			if (fds[i] >= 0)
+				::close(fds[i]);
+
+			fds[i] = -1;
+		}
+	}
+
+	bool launch(const juce::StringArray &arguments)
+	{
+		int outputPipe[2] = { -1, -1 }, errorPipe[2] = { -1, -1 };
+
+		if (!createPipe(outputPipe) || !createPipe(errorPipe))
+		{
+			closePipes(outputPipe);
+			closePipes(errorPipe);
+			return false;
+		}
+
+		// Both pipes are close-on-exec, the copies that dup2 makes are not.
+		posix_spawn_file_actions_t actions;
+		posix_spawn_file_actions_init(&actions);
+		posix_spawn_file_actions_adddup2(&actions, outputPipe[1], STDOUT_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, errorPipe[1], STDERR_FILENO);
+
+		juce::Array<char*> argv;
+
+		for (int i = 0; i < arguments.size(); ++i)
+			argv.add(const_cast<char*>(arguments[i].toRawUTF8()));
+
+		argv.add(nullptr);
+
+		pid_t newProcessId = 0;
+		const int result = ::posix_spawnp(&newProcessId, argv[0], &actions, nullptr, argv.getRawDataPointer(), environ);
+
+		posix_spawn_file_actions_destroy(&actions);
+		::close(outputPipe[1]);
+		::close(errorPipe[1]);
+
+		pipes[0] = outputPipe[0];
+		pipes[1] = errorPipe[0];
+
+		if (result != 0)
+		{
+			closePipes(pipes);
+			return false;
+		}
+
+		const juce::ScopedLock sl(processLock);
+		processId = newProcessId;
+		return true;
+	}
+
+	// The lock keeps "run" from reaping the child while it is being signalled.
+	// Once reaped, its pid may belong to another process.
+	void killProcess()
+	{
+		const juce::ScopedLock sl(processLock);
+
+		if (processId > 0)
+			::kill(processId, SIGKILL);
+	}
+
+	void run() override
+	{
+		char data[65536];
+
+		while (pipes[0] >= 0 || pipes[1] >= 0)
+		{
+			pollfd fds[2];
+			int indexes[2], numFds = 0;
+
+			for (int i = 0; i < 2; ++i)
+			{
+				if (pipes[i] >= 0)
+				{
+					fds[numFds].fd = pipes[i];
+					fds[numFds].events = POLLIN;
+					fds[numFds].revents = 0;
+					indexes[numFds++] = i;
+				}
+			}
+
+			// Wakes up now and then, so that "kill" is noticed even if the output
+			// pipes are held open by children of the child.
+			int timeout = 100;
+
+			if (hasDeadline)
+				timeout = juce::jlimit(0, timeout, (int)(juce::int32)(deadline - juce::Time::getMillisecondCounter()));
+
+			if (::poll(fds, (nfds_t)numFds, timeout) < 0 && errno != EINTR)
+				break;
+
+			for (int i = 0; i < numFds; ++i)
+			{
+				if (fds[i].revents == 0)
+					continue;
+
+				const ssize_t numRead = ::read(fds[i].fd, data, sizeof(data));
+
+				if (numRead > 0)
+				{
+					deliver(indexes[i] == 0 ? standardOutput : standardError, data, (size_t)numRead);
+				}
+				else if (numRead == 0 || (errno != EINTR && errno != EAGAIN))
+				{
+					::close(pipes[indexes[i]]);
+					pipes[indexes[i]] = -1;
+				}
+			}
+
+			if (killRequested.load())
+				break;
+
+			if (isPastDeadline())
+			{
+				killForTimeout();
+				break;
+			}
+		}
+
+		closePipes(pipes);
+
+		// Waits for the child to exit without reaping it, so that its pid stays
+		// taken until "processId" is cleared and nothing can signal it any more.
+		siginfo_t info;
+
+		while (::waitid(P_PID, (id_t)processId, &info, WEXITED | WNOWAIT) < 0 && errno == EINTR)
+		{
+		}
+
+		pid_t exitedProcessId;
+
+		{
+			const juce::ScopedLock sl(processLock);
+			exitedProcessId = processId;
+			processId = 0;
+		}
+
+		int status = 0;
+
+		while (::waitpid(exitedProcessId, &status, 0) < 0 && errno == EINTR)
+		{
+		}
+
+		if (WIFEXITED(status))
+			finish(WEXITSTATUS(status));
+		else if (WIFSIGNALED(status))
+			finish(128 + WTERMSIG(status));
+		else
+			finish(-1);
+	}
+
+	//==============================================================================
+	int pipes[2] = { -1, -1 };
+	pid_t processId = 0;
+#endif
+
+	//==============================================================================
+	OutputCallback outputCallback;
+	juce::CriticalSection processLock;
+
+	bool hasStarted = false, hasDeadline = false;
+	juce::uint32 deadline = 0;
+	std::atomic<bool> hasFinished { false }, killRequested { false }, timedOut { false };
+
+	std::promise<int> exitCodePromise;
+	std::shared_future<int> exitCode;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleProcess)
+};
@@ -0,0 +1,139 @@
+﻿#pragma once
+#define EZ_CONSOLEPROCESSRUNNER_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Runs many processes, no more than a given number of them at a time.
+	       运行多个进程，同时运行的数量不超过给定的上限。
+
+	Each call to "run" queues a process and returns the future of its exit
+	code at once. The processes start in the order they were queued, as soon
+	as fewer than the limit are running, and their output is streamed to their
+	callbacks as with ConsoleProcess. The callbacks of processes running at the
+	same time are called from different threads.
+
+	The destructor waits for every queued process to finish.
+
+	每次调用"run"都会将一个进程加入队列，并立即返回其退出码的 future。只要正在运行
+	的进程少于上限，进程就会按照加入队列的顺序启动，其输出与 ConsoleProcess 一样以
+	流的方式传给各自的回调函数。同时运行的进程的回调函数会在不同的线程中被调用。
+
+	析构函数会等待所有已加入队列的进程结束。
+
+	@see ConsoleProcess
+*/
+class ConsoleProcessRunner
+{
+public:
+	//==============================================================================
+	/** @brief Creates a runner.
+	           创建一个运行器。
+
+		@param maxConcurrentProcesses  How many processes may run at the same time.
+		                               The default value is the number of CPU cores.
+		                               可以同时运行的进程数量。默认值是CPU核心数。
+	*/
+	explicit ConsoleProcessRunner(int maxConcurrentProcesses = juce::SystemStats::getNumCpus())
+		: pool(juce::jmax(1, maxConcurrentProcesses))
+	{
+	}
+
+	/** @brief Destructor. Waits for all the processes to finish.
+	           析构函数。等待所有进程结束。
+	*/
+	~ConsoleProcessRunner()
+	{
+		waitForAll();
+	}
+
+	//==============================================================================
+	/** @brief Queues a program to be run.
+	           将一个程序加入运行队列。
+
+		The arguments are the same as those of ConsoleProcess::start, and the
+		timeout counts from the moment the process starts, not from this call.
+
+		参数与 ConsoleProcess::start 相同，超时时间从进程启动时开始计算，而不是从本次
+		调用开始。
+
+		@returns The future exit code of the process, which is -1 if it could not
+		         be started.
+		@returns 进程未来的退出码。如果进程无法启动，退出码为-1。
+	*/
+	std::shared_future<int> run(const juce::StringArray &arguments,
+		ConsoleProcess::OutputCallback callback = nullptr, int timeoutMilliseconds = -1)
+	{
+		ProcessJob *job = new ProcessJob(*this, arguments, callback, timeoutMilliseconds);
+		std::shared_future<int> exitCode(job->getExitCode());
+
+		++numUnfinished;
+		pool.addJob(job, true);
+
+		return exitCode;
+	}
+
+	//==============================================================================
+	/** @brief Waits until every queued process has finished.
+	           等待直到所有已加入队列的进程都已结束。
+	*/
+	void waitForAll()
+	{
+		while (numUnfinished.load() > 0)
+			allFinished.wait(50);
+	}
+
+	/** @brief Returns how many processes are queued or running.
+	           返回正在排队或正在运行的进程数量。
+	*/
+	int getNumUnfinished() const
+	{
+		return numUnfinished.load();
+	}
+
+private:
+	//==============================================================================
+	class ProcessJob : public juce::ThreadPoolJob
+	{
+	public:
+		ProcessJob(ConsoleProcessRunner &r, const juce::StringArray &a,
+			ConsoleProcess::OutputCallback c, int timeout)
+			: juce::ThreadPoolJob("ConsoleProcessJob"),
+			  runner(r), arguments(a), callback(c), timeoutMilliseconds(timeout)
+		{
+		}
+
+		std::shared_future<int> getExitCode()
+		{
+			return exitCodePromise.get_future().share();
+		}
+
+		JobStatus runJob() override
+		{
+			{
+				ConsoleProcess process;
+				process.start(arguments, callback, timeoutMilliseconds);
+				exitCodePromise.set_value(process.getExitCode().get());
+			}
+
+			if (--runner.numUnfinished == 0)
+				runner.allFinished.signal();
+
+			return jobHasFinished;
+		}
+
+	private:
+		ConsoleProcessRunner &runner;
+		juce::StringArray arguments;
+		ConsoleProcess::OutputCallback callback;
+		int timeoutMilliseconds;
+		std::promise<int> exitCodePromise;
+	};
+
+	//==============================================================================
+	std::atomic<int> numUnfinished { 0 };
+	juce::WaitableEvent allFinished;
+	juce::ThreadPool pool;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleProcessRunner)
+};
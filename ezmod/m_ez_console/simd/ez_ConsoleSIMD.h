@@ -0,0 +1,76 @@
+﻿#pragma once
+#define EZ_CONSOLESIMD_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief The helpers shared by the SIMD kernels of the module.
+	       本模块各 SIMD 内核共用的辅助函数。
+
+	Each kernel comes as a scalar, an SSE2 and an AVX2 function, and the one
+	to use is chosen once, the first time it is needed, with "chooseKernel".
+	SSE2 is used whenever the module was built with it, and AVX2 only when
+	"juce::SystemStats::hasAVX2" says the CPU has it.
+
+	每个内核都有标量、SSE2 和 AVX2 三个版本的函数，在第一次需要时通过
+	"chooseKernel"选定一次。只要编译模块时启用了 SSE2 就会使用 SSE2；只有当
+	"juce::SystemStats::hasAVX2"表明 CPU 支持时才会使用 AVX2。
+*/
+class ConsoleSIMD
+{
+public:
+	//==============================================================================
+	/** @brief Picks the best of three versions of a kernel for this CPU.
+	           为当前 CPU 从内核的三个版本中选出最合适的一个。
+	*/
+	template <typename FunctionType>
+	static FunctionType chooseKernel(FunctionType scalar, FunctionType sse2, FunctionType avx2)
+	{
+		juce::ignoreUnused(scalar, sse2, avx2);
+
+	#if EZ_CONSOLE_USE_AVX2
+		if (juce::SystemStats::hasAVX2())
+			return avx2;
+	#endif
+
+	#if EZ_CONSOLE_USE_SSE2
+		return sse2;
+	#else
+		return scalar;
+	#endif
+	}
+
+	/** @brief Picks the AVX2 version of a kernel if the CPU has it, for kernels
+	           that have no SSE2 version.
+	           对于没有 SSE2 版本的内核，在 CPU 支持时选用其 AVX2 版本。
+	*/
+	template <typename FunctionType>
+	static FunctionType chooseKernel(FunctionType scalar, FunctionType avx2)
+	{
+		juce::ignoreUnused(scalar, avx2);
+
+	#if EZ_CONSOLE_USE_AVX2
+		if (juce::SystemStats::hasAVX2())
+			return avx2;
+	#endif
+
+		return scalar;
+	}
+
+	//==============================================================================
+	/** @brief Returns the index of the lowest bit set in a mask, which must not be 0.
+	           返回掩码中最低的置位比特的索引，掩码不能为0。
+	*/
+	static int findLowestSetBit(juce::uint32 mask)
+	{
+		jassert(mask != 0);
+
+	#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (int)index;
+	#else
+		return __builtin_ctz(mask);
+	#endif
+	}
+};
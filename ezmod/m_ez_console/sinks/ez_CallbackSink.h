@@ -0,0 +1,60 @@
+﻿#pragma once
+#define EZ_CALLBACKSINK_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A sink that hands the data to a function.
+	       将数据交给一个函数的 Sink。
+
+	This is the quickest way to send output somewhere the module knows nothing
+	about, such as a GUI log window or a network connection. The function gets
+	the bytes as they are; it must not keep the pointer after it returns.
+
+	这是将输出发送到本模块所不了解的目标（例如GUI日志窗口或网络连接）的最简便方法。
+	函数会原样拿到这些字节；在函数返回之后，不能继续保留该指针。
+
+	@see TeeSink
+*/
+class CallbackSink : public ConsoleSink
+{
+public:
+	/** @brief The function that receives the data. It returns false on error.
+	           接收数据的函数。出错时返回false。
+	*/
+	typedef std::function<bool (const void *data, size_t numBytes)> Callback;
+
+	//==============================================================================
+	/** @brief Creates a sink that calls the given function for each write.
+	           创建一个在每次写入时调用指定函数的 Sink。
+
+		@param callback     The function to call.
+		                    要调用的函数。
+
+		@param interactive  What "isInteractive" returns. The default value is false.
+		                    "isInteractive"的返回值。默认值是false。
+	*/
+	explicit CallbackSink(Callback callback, bool interactive = false)
+		: function(std::move(callback)), interactiveOutput(interactive)
+	{
+		jassert(function != nullptr);
+	}
+
+	//==============================================================================
+	bool write(const void *data, size_t numBytes) override
+	{
+		return function(data, numBytes);
+	}
+
+	bool isInteractive() const override
+	{
+		return interactiveOutput;
+	}
+
+private:
+	//==============================================================================
+	const Callback function;
+	const bool interactiveOutput;
+
+	JUCE_DECLARE_NON_COPYABLE(CallbackSink)
+};
@@ -0,0 +1,584 @@
+﻿#pragma once
+#define EZ_CONSOLESINK_H_INCLUDED
+
+//==============================================================================
+/** @brief A pointer and a size, describing one piece of a larger write.
+           一个指针和一个大小，描述一次较大写入中的一段数据。
+
+	@see ConsoleSink::writeBlocks
+*/
+struct ConsoleDataBlock
+{
+	const void *data;
+	size_t size;
+};
+
+//==============================================================================
+/**
+
+    @brief The destination that a ConsoleOutputStream sends its data to.
+	       ConsoleOutputStream 输出数据的目的地。
+
+	A sink receives raw bytes that have already been formatted by the stream,
+	and is responsible for getting them to the device, file or whatever else
+	is behind it.
+
+	Sinks never see a juce::String, they are handed the stream's buffer as it
+	is, so no extra copy or conversion is made on the way out.
+
+	Sink 接收已经由输出流格式化好的原始字节，并负责将其送往背后的设备、文件或
+	其他目标。
+
+	Sink 不会接触 juce::String，它直接拿到输出流的缓冲区，因此在输出过程中不会
+	产生额外的拷贝或转换。
+
+*/
+class ConsoleSink
+{
+public:
+	/** @brief A file descriptor, or a HANDLE in Windows.
+	           文件描述符，在Windows系统中为 HANDLE。
+	*/
+#ifdef JUCE_WINDOWS
+	typedef HANDLE NativeHandle;
+#else
+	typedef int NativeHandle;
+#endif
+
+	/** @brief What a call to "consumeChunksAsync" or "flushAsync" did.
+	           调用"consumeChunksAsync"或"flushAsync"的结果。
+	*/
+	enum AsyncResult
+	{
+		asyncFailed,  /**< Finished, and failed. The callback is not called.
+		                   已完成，但失败了。不会调用回调函数。 */
+		asyncDone,    /**< Finished, and succeeded. The callback is not called.
+		                   已完成，并且成功了。不会调用回调函数。 */
+		asyncPending  /**< Not finished yet. The callback will be called later,
+		                   from another thread.
+		                   尚未完成。回调函数稍后会在另一个线程中被调用。 */
+	};
+
+	/** @brief Called when an asynchronous operation finishes, with true on success.
+	           异步操作完成时调用，成功时参数为true。
+	*/
+	typedef std::function<void (bool succeeded)> AsyncCallback;
+
+	/** @brief Destructor.
+	           析构函数。
+	*/
+	virtual ~ConsoleSink() {}
+
+	//==============================================================================
+	/** @brief Writes a block of bytes to the sink.
+	           向 Sink 写入一块数据。
+
+		This must either write all of the data or fail.
+
+		该方法要么写入全部数据，要么返回失败。
+
+		@returns true if all the data was written, false on error.
+		@returns 全部数据写入成功时返回true，出错时返回false。
+	*/
+	virtual bool write(const void *data, size_t numBytes) = 0;
+
+	/** @brief Writes several blocks of bytes, one after the other.
+	           依次写入多块数据。
+
+		The default implementation calls "write" for each block. Sinks that
+		can do better, such as with a single "writev" call, should override it.
+
+		默认实现对每一块数据调用一次"write"。能做得更好的 Sink（例如使用一次
+		"writev"调用）应当重写该方法。
+
+		@returns true if all the data was written, false on error.
+		@returns 全部数据写入成功时返回true，出错时返回false。
+	*/
+	virtual bool writeBlocks(const ConsoleDataBlock *blocks, int numBlocks)
+	{
+		for (int i = 0; i < numBlocks; ++i)
+			if (!write(blocks[i].data, blocks[i].size))
+				return false;
+
+		return true;
+	}
+
+	/** @brief Writes a list of chunks and takes ownership of it.
+	           写入一个内存块链表并取得其所有权。
+
+		This is how a ConsoleOutputStream hands its buffer over. The default
+		implementation passes the chunks to "writeChunks", then gives them back
+		to the ConsoleChunkPool. Sinks that want to keep the data for later,
+		such as ConsoleAsyncWriter, override it to avoid copying.
+
+		ConsoleOutputStream 正是通过该方法交出其缓冲区。默认实现会将内存块交给
+		"writeChunks"，然后将其归还给 ConsoleChunkPool。需要将数据留待之后处理的
+		Sink（例如 ConsoleAsyncWriter）会重写该方法以避免拷贝。
+
+		@returns true if all the data was written, false on error.
+		@returns 全部数据写入成功时返回true，出错时返回false。
+	*/
+	virtual bool consumeChunks(ConsoleChunk *firstChunk)
+	{
+		const bool result = writeChunks(firstChunk);
+
+		ConsoleChunkPool::getInstance().releaseList(firstChunk);
+		return result;
+	}
+
+	/** @brief Writes a list of chunks without taking ownership of it.
+	           写入一个内存块链表，但不取得其所有权。
+
+		The chunks are passed to "writeBlocks" in batches. This lets a list that
+		is shared by several sinks, as TeeSink does, be written by each of them.
+		Sinks that must keep the whole list together, such as SynchronisedSink,
+		override it.
+
+		内存块会被分批交给"writeBlocks"。这使得一个由多个 Sink 共享的链表（例如
+		TeeSink 中的情况）可以被它们各自写出。必须将整个链表作为一个整体写出的 Sink
+		（例如 SynchronisedSink）会重写该方法。
+
+		@returns true if all the data was written, false on error.
+		@returns 全部数据写入成功时返回true，出错时返回false。
+	*/
+	virtual bool writeChunks(const ConsoleChunk *firstChunk)
+	{
+		const int maxBlocksPerCall = 64;
+		ConsoleDataBlock blocks[maxBlocksPerCall];
+		bool result = true;
+
+		for (const ConsoleChunk *c = firstChunk; c != nullptr;)
+		{
+			int numBlocks = 0;
+
+			for (; c != nullptr && numBlocks < maxBlocksPerCall; c = c->next)
+			{
+				blocks[numBlocks].data = c->data;
+				blocks[numBlocks].size = c->size;
+				++numBlocks;
+			}
+
+			result = writeBlocks(blocks, numBlocks) && result;
+		}
+
+		return result;
+	}
+
+	/** @brief Makes sure all the data written so far has reached the destination.
+	           确保之前写入的所有数据都已到达目的地。
+
+		The default implementation does nothing, which is right for sinks that
+		write straight through.
+
+		默认实现不做任何事，这适用于直接写穿的 Sink。
+	*/
+	virtual bool flush()
+	{
+		return true;
+	}
+
+	//==============================================================================
+	/** @brief Takes a list of chunks like "consumeChunks", but never waits for
+	           room to put it.
+	           像"consumeChunks"一样接收一个内存块链表，但永远不等待空间来存放它。
+
+		This is for callers that must not block, such as coroutines. If the
+		sink cannot take the chunks at once, it keeps them aside, returns
+		asyncPending, and calls the callback from another thread once it has
+		taken them. The callback must be quick, as it runs on that thread.
+
+		The default implementation calls "consumeChunks", which may block. Only
+		sinks that have somewhere to keep the chunks, such as ConsoleAsyncWriter,
+		can do better.
+
+		该方法供不能阻塞的调用者（例如协程）使用。如果 Sink 无法立即接收这些内存块，
+		它会将其暂存起来并返回asyncPending，在接收之后于另一个线程中调用回调函数。
+		回调函数运行在那个线程上，因此必须尽快返回。
+
+		默认实现调用"consumeChunks"，可能会阻塞。只有能够暂存内存块的 Sink（例如
+		ConsoleAsyncWriter）才能做得更好。
+
+		@param firstChunk    The chunks, which the sink takes ownership of.
+		                     内存块链表，Sink 会取得其所有权。
+
+		@param whenConsumed  Called if asyncPending is returned. It may be nullptr.
+		                     返回asyncPending时调用。可以为nullptr。
+	*/
+	virtual AsyncResult consumeChunksAsync(ConsoleChunk *firstChunk, AsyncCallback whenConsumed)
+	{
+		juce::ignoreUnused(whenConsumed);
+		return consumeChunks(firstChunk) ? asyncDone : asyncFailed;
+	}
+
+	/** @brief Starts a "flush" without waiting for it to finish.
+	           开始一次"flush"，但不等待其完成。
+
+		If the data written so far has not all reached the destination yet,
+		this returns asyncPending and calls the callback from another thread
+		once it has. The default implementation calls "flush", which may block.
+
+		如果之前写入的数据尚未全部到达目的地，该方法返回asyncPending，并在数据到达
+		之后于另一个线程中调用回调函数。默认实现调用"flush"，可能会阻塞。
+
+		@param whenFlushed  Called if asyncPending is returned. It may be nullptr.
+		                    返回asyncPending时调用。可以为nullptr。
+	*/
+	virtual AsyncResult flushAsync(AsyncCallback whenFlushed)
+	{
+		juce::ignoreUnused(whenFlushed);
+		return flush() ? asyncDone : asyncFailed;
+	}
+
+	/** @brief Returns true if the data goes to an interactive terminal.
+	           如果数据被输出到交互式终端，返回true。
+
+		This is used to pick a flush policy automatically. The default
+		implementation returns false, which suits files, pipes and memory.
+
+		该方法用于自动选择刷新策略。默认实现返回false，适用于文件、管道和内存。
+
+		@see ConsoleOutputStream::flushAutomatically
+	*/
+	virtual bool isInteractive() const
+	{
+		return false;
+	}
+
+	/** @brief Gets the file descriptor (the HANDLE in Windows) that the data ends
+	           up in, if there is one.
+	           获取数据最终写入的文件描述符（在Windows系统中为 HANDLE），如果有的话。
+
+		ConsoleCrashHandler asks for it when a stream is added to its table, or
+		changes its sink, and writes to it directly after a crash, when calling
+		the sink is no longer safe. So the handle must stay valid for as long as
+		the sink lives, even if the sink moves on to another file. The default
+		implementation returns false.
+
+		ConsoleCrashHandler 会在输出流被加入其表中或更换 Sink 时获取它，并在程序崩溃后
+		（此时调用 Sink 已不再安全）直接写入它。因此该句柄必须在 Sink 的整个生命周期内
+		保持有效，即使 Sink 改为写入另一个文件也是如此。默认实现返回false。
+
+		@see ConsoleCrashHandler
+	*/
+	virtual bool getNativeHandle(NativeHandle &handle) const
+	{
+		juce::ignoreUnused(handle);
+		return false;
+	}
+};
+
+//==============================================================================
+/**
+
+    @brief A sink that writes to the process's standard output or standard error.
+	       向进程的标准输出或标准错误输出写入数据的 Sink。
+
+	In Windows, the data is converted to UTF-16 and passed to "WriteConsoleW"
+	when the handle is a console, and passed to "WriteFile" as it is when the
+	output is redirected to a file or a pipe, where "WriteConsoleW" would fail.
+
+	In other OS, the data is passed to the file descriptor with "write", without
+	going through the C or C++ standard library buffers. Partial writes and
+	interrupted calls are retried until everything is written. Note that this
+	means the data is not ordered with anything still sitting in the "stdout"
+	or "cout" buffers, so flush those first if you mix them.
+
+	The first sink that is created sets the console up through
+	ConsoleCapabilities, which in Windows switches it to UTF-8, and
+	"isInteractive" answers from what it found then.
+
+	在Windows系统中，如果句柄是控制台，数据会被转换为UTF-16并通过"WriteConsoleW"
+	输出；如果输出被重定向到文件或管道（此时"WriteConsoleW"会失败），数据会原样
+	通过"WriteFile"输出。
+
+	在其他系统中，数据通过"write"直接写入文件描述符，不经过C或C++标准库的缓冲区。
+	部分写入和被信号中断的调用会被重试，直到所有数据都写完为止。注意这意味着数据
+	与仍留在"stdout"或"cout"缓冲区中的内容之间没有先后顺序的保证，如果您混合使用
+	它们，请先刷新那些缓冲区。
+
+	第一个被创建的 Sink 会通过 ConsoleCapabilities 设置控制台（在Windows系统中会将其
+	切换为UTF-8），之后"isInteractive"将根据当时的检测结果作答。
+
+	@see ConsoleCapabilities
+*/
+class StandardOutputSink : public ConsoleSink
+{
+public:
+	//==============================================================================
+	/** @brief Creates a sink for standard output, or standard error.
+	           创建一个标准输出或标准错误输出的 Sink。
+
+		@param useStandardError True to write to standard error instead of standard
+		                        output. The default value is false.
+		                        设为true则写入标准错误输出而非标准输出。默认值是false。
+	*/
+	explicit StandardOutputSink(bool useStandardError = false)
+		: capabilities(ConsoleCapabilities::getInstance()),
+		  standardStream(useStandardError ? ConsoleCapabilities::standardError : ConsoleCapabilities::standardOutput)
+	{
+#ifdef JUCE_WINDOWS
+		hConsoleOutput = GetStdHandle(useStandardError ? STD_ERROR_HANDLE : STD_OUTPUT_HANDLE);
+
+		DWORD mode;
+		writesToConsole = GetFileType(hConsoleOutput) == FILE_TYPE_CHAR && GetConsoleMode(hConsoleOutput, &mode) != 0;
+#else
+		fileDescriptor = useStandardError ? STDERR_FILENO : STDOUT_FILENO;
+#endif
+	}
+
+	//==============================================================================
+	bool write(const void *data, size_t numBytes) override
+	{
+#ifdef JUCE_WINDOWS
+		if (writesToConsole)
+			return writeToConsole(static_cast<const char*>(data), numBytes);
+
+		return writeToFileHandle(hConsoleOutput, data, numBytes);
+#else
+		return writeToFileDescriptor(fileDescriptor, data, numBytes);
+#endif
+	}
+
+	bool writeBlocks(const ConsoleDataBlock *blocks, int numBlocks) override
+	{
+#ifdef JUCE_WINDOWS
+		return ConsoleSink::writeBlocks(blocks, numBlocks);
+#else
+		return writeBlocksToFileDescriptor(fileDescriptor, blocks, numBlocks);
+#endif
+	}
+
+	bool isInteractive() const override
+	{
+		return capabilities.isTerminal(standardStream);
+	}
+
+	bool getNativeHandle(NativeHandle &handle) const override
+	{
+#ifdef JUCE_WINDOWS
+		handle = hConsoleOutput;
+#else
+		handle = fileDescriptor;
+#endif
+		return true;
+	}
+
+#ifdef JUCE_WINDOWS
+	//==============================================================================
+	/** @brief Writes all the bytes to a file, pipe or console handle with
+	           "WriteFile" (Windows only method).
+	           使用"WriteFile"将全部数据写入一个文件、管道或控制台句柄。（该方法只在
+	           Windows环境下有效）
+
+		Keeps calling "WriteFile" until everything is written.
+
+		持续调用"WriteFile"直到所有数据写完为止。
+
+		@returns true if all the data was written, false on error.
+		@returns 全部数据写入成功时返回true，出错时返回false。
+	*/
+	static bool writeToFileHandle(HANDLE handle, const void *data, size_t numBytes)
+	{
+		const char *p = static_cast<const char*>(data);
+
+		while (numBytes > 0)
+		{
+			DWORD dw;
+			const DWORD numToWrite = (DWORD)juce::jmin(numBytes, (size_t)0x40000000);
+
+			if (WriteFile(handle, p, numToWrite, &dw, NULL) == 0)
+				return false;
+
+			p += dw;
+			numBytes -= dw;
+		}
+
+		return true;
+	}
+
+#else
+	//==============================================================================
+	/** @brief Writes all the bytes to a file descriptor (non-Windows only method).
+	           将全部数据写入一个文件描述符。（该方法只在非Windows环境下有效）
+
+		Keeps calling "write" until everything is written, retrying on EINTR and
+		waiting for the descriptor to become writable again on EAGAIN.
+
+		持续调用"write"直到所有数据写完为止，遇到 EINTR 时重试，遇到 EAGAIN 时等待
+		文件描述符重新变为可写。
+
+		@returns true if all the data was written, false on error.
+		@returns 全部数据写入成功时返回true，出错时返回false。
+	*/
+	static bool writeToFileDescriptor(int fd, const void *data, size_t numBytes)
+	{
+		const char *p = static_cast<const char*>(data);
+
+		while (numBytes > 0)
+		{
+			const ssize_t numWritten = ::write(fd, p, numBytes);
+
+			if (numWritten < 0)
+			{
+				if (errno == EINTR)
+					continue;
+
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+				{
+					pollfd pfd = { fd, POLLOUT, 0 };
+					::poll(&pfd, 1, -1);
+					continue;
+				}
+
+				return false;
+			}
+
+			p += numWritten;
+			numBytes -= (size_t)numWritten;
+		}
+
+		return true;
+	}
+
+	/** @brief Writes several blocks to a file descriptor with "writev" (non-Windows only method).
+	           使用"writev"将多块数据写入一个文件描述符。（该方法只在非Windows环境下有效）
+
+		Up to 64 blocks are gathered into each "writev" call. Partial writes,
+		EINTR and EAGAIN are handled the same way as "writeToFileDescriptor".
+
+		每次"writev"调用最多合并64块数据。部分写入、EINTR和EAGAIN的处理方式与
+		"writeToFileDescriptor"相同。
+
+		@returns true if all the data was written, false on error.
+		@returns 全部数据写入成功时返回true，出错时返回false。
+	*/
+	static bool writeBlocksToFileDescriptor(int fd, const ConsoleDataBlock *blocks, int numBlocks)
+	{
+		const int maxBlocksPerCall = 64;
+		iovec vectors[maxBlocksPerCall];
+
+		while (numBlocks > 0)
+		{
+			const int numVectors = juce::jmin(numBlocks, maxBlocksPerCall);
+
+			for (int i = 0; i < numVectors; ++i)
+			{
+				vectors[i].iov_base = const_cast<void*>(blocks[i].data);
+				vectors[i].iov_len = blocks[i].size;
+			}
+
+			int first = 0;
+
+			while (first < numVectors)
+			{
+				const ssize_t numWritten = ::writev(fd, vectors + first, numVectors - first);
+
+				if (numWritten < 0)
+				{
+					if (errno == EINTR)
+						continue;
+
+					if (errno == EAGAIN || errno == EWOULDBLOCK)
+					{
+						pollfd pfd = { fd, POLLOUT, 0 };
+						::poll(&pfd, 1, -1);
+						continue;
+					}
+
+					return false;
+				}
+
+				size_t remaining = (size_t)numWritten;
+
+				while (first < numVectors && remaining >= vectors[first].iov_len)
+					remaining -= vectors[first++].iov_len;
+
+				if (first < numVectors)
+				{
+					vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + remaining;
+					vectors[first].iov_len -= remaining;
+				}
+			}
+
+			blocks += numVectors;
+			numBlocks -= numVectors;
+		}
+
+		return true;
+	}
+#endif
+
+private:
+#ifdef JUCE_WINDOWS
+	//==============================================================================
+	// A character can be split between two writes, as the stream cuts its
+	// chunks anywhere, so its first bytes wait in "pendingBytes" until the
+	// rest arrives. A UTF-8 byte never becomes more than one UTF-16 unit.
+	bool writeToConsole(const char *data, size_t numBytes)
+	{
+		const size_t pieceSize = 4096;
+		char piece[pieceSize + 4];
+		wchar_t wide[pieceSize + 4];
+
+		while (numBytes > 0)
+		{
+			size_t pieceLength = numPendingBytes;
+			memcpy(piece, pendingBytes, numPendingBytes);
+
+			const size_t numToTake = juce::jmin(numBytes, pieceSize);
+			memcpy(piece + pieceLength, data, numToTake);
+			pieceLength += numToTake;
+			data += numToTake;
+			numBytes -= numToTake;
+
+			const size_t completeLength = findCompleteLength(piece, pieceLength);
+			numPendingBytes = pieceLength - completeLength;
+			memcpy(pendingBytes, piece + completeLength, numPendingBytes);
+
+			const int numUnits = MultiByteToWideChar(CP_UTF8, 0, piece, (int)completeLength, wide, (int)pieceSize + 4);
+			const wchar_t *w = wide;
+			DWORD numLeft = (DWORD)numUnits;
+
+			while (numLeft > 0)
+			{
+				DWORD dw;
+
+				if (WriteConsoleW(hConsoleOutput, w, numLeft, &dw, NULL) == 0 || dw == 0)
+					return false;
+
+				w += dw;
+				numLeft -= dw;
+			}
+		}
+
+		return true;
+	}
+
+	// Leaves out a sequence at the end that is a valid start, but not complete.
+	static size_t findCompleteLength(const char *data, size_t numBytes)
+	{
+		const juce::uint8 *bytes = reinterpret_cast<const juce::uint8*>(data);
+
+		for (size_t i = numBytes; i > 0 && numBytes - i < 3; --i)
+		{
+			if ((bytes[i - 1] & 0xc0) != 0x80)
+				return ConsoleUTF8::getSequenceLength(bytes + i - 1, numBytes - i + 1) < 0 ? i - 1 : numBytes;
+		}
+
+		return numBytes;
+	}
+
+#endif
+	//==============================================================================
+	const ConsoleCapabilities &capabilities;
+	const ConsoleCapabilities::StandardStream standardStream;
+
+#ifdef JUCE_WINDOWS
+	HANDLE hConsoleOutput;
+	bool writesToConsole;
+	char pendingBytes[4];
+	size_t numPendingBytes = 0;
+#else
+	int fileDescriptor;
+#endif
+};
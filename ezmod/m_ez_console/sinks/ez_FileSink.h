@@ -0,0 +1,136 @@
+﻿#pragma once
+#define EZ_FILESINK_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A sink that writes to a file.
+	       向文件写入数据的 Sink。
+
+	The file is opened in the constructor and kept open until the sink is
+	deleted. Data goes straight to the OS with no buffering of its own, as the
+	stream in front of it already buffers. When appending, each write goes to
+	the current end of the file, even if another process appends to it too.
+
+	This is the usual destination of a stream in record mode.
+
+	文件在构造函数中打开，直到 Sink 被删除时才关闭。数据直接交给操作系统，Sink 本身
+	不做缓冲，因为其前面的输出流已经做了缓冲。追加写入时，即使有其他进程同时追加，
+	每次写入也都会写到文件当前的末尾。
+
+	这是记录模式下输出流通常使用的目的地。
+
+	@see ConsoleOutputStream::setRecordMode
+*/
+class FileSink : public ConsoleSink
+{
+public:
+	//==============================================================================
+	/** @brief Opens a file for writing, creating it if needed.
+	           打开一个文件用于写入，必要时创建该文件。
+
+		@param file                  The file to write to.
+		                             要写入的文件。
+
+		@param appendToExistingFile  If true, the data is added to the end of an
+		                             existing file, otherwise the file is emptied
+		                             first. The default value is true.
+		                             设为true则在已有文件的末尾追加数据，否则先清空
+		                             文件。默认值是true。
+	*/
+	explicit FileSink(const juce::File &file, bool appendToExistingFile = true)
+		: targetFile(file)
+	{
+		file.getParentDirectory().createDirectory();
+
+#ifdef JUCE_WINDOWS
+		hFile = CreateFileW(file.getFullPathName().toWideCharPointer(),
+			appendToExistingFile ? FILE_APPEND_DATA : GENERIC_WRITE,
+			FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+			appendToExistingFile ? OPEN_ALWAYS : CREATE_ALWAYS,
+			FILE_ATTRIBUTE_NORMAL, NULL);
+#else
+		fileDescriptor = ::open(file.getFullPathName().toRawUTF8(),
+			O_WRONLY | O_CREAT | O_CLOEXEC | (appendToExistingFile ? O_APPEND : O_TRUNC), 0644);
+#endif
+	}
+
+	/** @brief Destructor. Closes the file.
+	           析构函数。关闭文件。
+	*/
+	~FileSink()
+	{
+#ifdef JUCE_WINDOWS
+		if (hFile != INVALID_HANDLE_VALUE)
+			CloseHandle(hFile);
+#else
+		if (fileDescriptor >= 0)
+			::close(fileDescriptor);
+#endif
+	}
+
+	//==============================================================================
+	/** @brief Returns true if the file was opened in the constructor.
+	           如果文件在构造函数中成功打开，返回true。
+	*/
+	bool openedOk() const
+	{
+#ifdef JUCE_WINDOWS
+		return hFile != INVALID_HANDLE_VALUE;
+#else
+		return fileDescriptor >= 0;
+#endif
+	}
+
+	/** @brief Returns the file given in the constructor.
+	           返回构造函数中指定的文件。
+	*/
+	const juce::File& getFile() const
+	{
+		return targetFile;
+	}
+
+	//==============================================================================
+	bool write(const void *data, size_t numBytes) override
+	{
+		if (!openedOk())
+			return false;
+
+#ifdef JUCE_WINDOWS
+		return StandardOutputSink::writeToFileHandle(hFile, data, numBytes);
+#else
+		return StandardOutputSink::writeToFileDescriptor(fileDescriptor, data, numBytes);
+#endif
+	}
+
+	bool writeBlocks(const ConsoleDataBlock *blocks, int numBlocks) override
+	{
+#ifdef JUCE_WINDOWS
+		return ConsoleSink::writeBlocks(blocks, numBlocks);
+#else
+		return openedOk() && StandardOutputSink::writeBlocksToFileDescriptor(fileDescriptor, blocks, numBlocks);
+#endif
+	}
+
+	bool getNativeHandle(NativeHandle &handle) const override
+	{
+#ifdef JUCE_WINDOWS
+		handle = hFile;
+#else
+		handle = fileDescriptor;
+#endif
+		return openedOk();
+	}
+
+private:
+	//==============================================================================
+	juce::File targetFile;
+
+#ifdef JUCE_WINDOWS
+	HANDLE hFile;
+#else
+	int fileDescriptor;
+#endif
+
+	JUCE_DECLARE_NON_COPYABLE(FileSink)
+};
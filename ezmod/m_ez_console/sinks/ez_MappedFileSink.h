@@ -0,0 +1,335 @@
+﻿#pragma once
+#define EZ_MAPPEDFILESINK_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A sink that copies its data into a memory-mapped log file.
+	       将数据拷贝到内存映射的日志文件中的 Sink。
+
+	The file is grown ahead of the data in large steps, and the step that is
+	being written is mapped into memory, so writing is a plain memory copy:
+	there is no system call per write or per flush, only one per step.
+
+	The mapping is shared with the OS file cache, so whatever has been copied
+	into it belongs to the file at once and survives a crash of the process.
+	When the sink is deleted, the file is cut back to the size of the data.
+	If the process dies first, the file keeps the zeros of the unused part of
+	the last step; opening it again to append removes them. This assumes that
+	the data never ends with zero bytes, which holds for text but not for
+	binary logs, so use FileSink for those.
+
+	"flush" leaves the data to the OS, which is enough for other processes to
+	read it. Call "sync" when it has to reach the disk, for example before a
+	machine could lose power.
+
+	文件以较大的步长提前于数据增长，当前正在写入的那一段被映射到内存中，因此写入
+	就是一次普通的内存拷贝：每次写入或刷新都不需要系统调用，每一段只需要一次。
+
+	该映射与操作系统的文件缓存共享，因此拷贝进去的数据立即属于该文件，即使进程崩溃
+	也不会丢失。删除 Sink 时，文件会被截断为数据的实际大小。如果进程先行终止，文件
+	会保留最后一段中未使用部分的零字节；再次以追加方式打开时会将其去除。这假定数据
+	不会以零字节结尾，对文本成立，但对二进制日志不成立，因此二进制日志请使用
+	FileSink。
+
+	"flush"将数据交给操作系统即止，这足以让其他进程读到这些数据。需要确保数据写入
+	磁盘时（例如机器可能断电时）请调用"sync"。
+
+	@see FileSink
+*/
+class MappedFileSink : public ConsoleSink
+{
+public:
+	//==============================================================================
+	/** @brief Opens a file and maps its first step, creating the file if needed.
+	           打开一个文件并映射其第一段，必要时创建该文件。
+
+		@param file                  The file to write to.
+		                             要写入的文件。
+
+		@param appendToExistingFile  If true, the data is added to the end of an
+		                             existing file, otherwise the file is emptied
+		                             first. The default value is true.
+		                             设为true则在已有文件的末尾追加数据，否则先清空
+		                             文件。默认值是true。
+
+		@param growthStep            How many bytes the file grows by at a time. It is
+		                             rounded up to the mapping granularity of the OS.
+		                             The default value is 16 MB.
+		                             文件每次增长的字节数。会向上取整为操作系统映射
+		                             粒度的整数倍。默认值是16 MB。
+	*/
+	explicit MappedFileSink(const juce::File &file, bool appendToExistingFile = true,
+		size_t growthStep = 16 * 1024 * 1024)
+		: targetFile(file)
+	{
+		const size_t granularity = getMappingGranularity();
+		stepSize = juce::jmax((size_t)1, (growthStep + granularity - 1) / granularity) * granularity;
+
+		file.getParentDirectory().createDirectory();
+
+		juce::int64 dataSize = 0;
+
+		if (appendToExistingFile && file.existsAsFile())
+			dataSize = findEndOfData(file, file.getSize(), stepSize);
+
+#ifdef JUCE_WINDOWS
+		hFile = CreateFileW(file.getFullPathName().toWideCharPointer(), GENERIC_READ | GENERIC_WRITE,
+			FILE_SHARE_READ, NULL, appendToExistingFile ? OPEN_ALWAYS : CREATE_ALWAYS,
+			FILE_ATTRIBUTE_NORMAL, NULL);
+
+		if (hFile == INVALID_HANDLE_VALUE)
+			return;
+#else
+		fileDescriptor = ::open(file.getFullPathName().toRawUTF8(),
+			O_RDWR | O_CREAT | O_CLOEXEC | (appendToExistingFile ? 0 : O_TRUNC), 0644);
+
+		if (fileDescriptor < 0)
+			return;
+#endif
+
+		windowStart = dataSize - dataSize % (juce::int64)stepSize;
+		windowPosition = (size_t)(dataSize - windowStart);
+
+		if (!mapWindow())
+			closeFile(dataSize);
+	}
+
+	/** @brief Destructor. Unmaps the file and cuts it back to the size of the data.
+	           析构函数。解除文件映射并将其截断为数据的实际大小。
+	*/
+	~MappedFileSink()
+	{
+		closeFile(getSize());
+	}
+
+	//==============================================================================
+	/** @brief Returns true if the file was opened and mapped in the constructor.
+	           如果文件在构造函数中成功打开并映射，返回true。
+	*/
+	bool openedOk() const
+	{
+		return window != nullptr;
+	}
+
+	/** @brief Returns the file given in the constructor.
+	           返回构造函数中指定的文件。
+	*/
+	const juce::File& getFile() const
+	{
+		return targetFile;
+	}
+
+	/** @brief Returns the size of the data in the file, which is less than the size
+	           of the file itself until the sink is deleted.
+	           返回文件中数据的大小。在 Sink 被删除之前，它小于文件本身的大小。
+	*/
+	juce::int64 getSize() const
+	{
+		return windowStart + (juce::int64)windowPosition;
+	}
+
+	/** @brief Returns the growth step, after rounding.
+	           返回取整之后的增长步长。
+	*/
+	size_t getGrowthStep() const
+	{
+		return stepSize;
+	}
+
+	//==============================================================================
+	bool write(const void *data, size_t numBytes) override
+	{
+		const char *p = static_cast<const char*>(data);
+
+		while (numBytes > 0)
+		{
+			if (window == nullptr)
+				return false;
+
+			if (windowPosition == stepSize)
+			{
+				unmapWindow();
+				windowStart += (juce::int64)stepSize;
+				windowPosition = 0;
+
+				if (!mapWindow())
+					return false;
+			}
+
+			const size_t numToCopy = juce::jmin(numBytes, stepSize - windowPosition);
+			memcpy(window + windowPosition, p, numToCopy);
+
+			windowPosition += numToCopy;
+			p += numToCopy;
+			numBytes -= numToCopy;
+		}
+
+		return true;
+	}
+
+	/** @brief Waits until the data written so far has reached the disk.
+	           等待直到此前写入的数据都已写入磁盘。
+
+		@returns false if the OS reported an error.
+		@returns 操作系统报告错误时返回false。
+	*/
+	bool sync()
+	{
+		if (window == nullptr)
+			return false;
+
+#ifdef JUCE_WINDOWS
+		return FlushViewOfFile(window, windowPosition) != 0 && FlushFileBuffers(hFile) != 0;
+#else
+		return ::msync(window, stepSize, MS_SYNC) == 0 && ::fsync(fileDescriptor) == 0;
+#endif
+	}
+
+private:
+	//==============================================================================
+	static size_t getMappingGranularity()
+	{
+#ifdef JUCE_WINDOWS
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return (size_t)info.dwAllocationGranularity;
+#else
+		return (size_t)::sysconf(_SC_PAGESIZE);
+#endif
+	}
+
+	// Skips the zeros that a crash left after the data. They can only be in the
+	// last step, so no more than that is read.
+	static juce::int64 findEndOfData(const juce::File &file, juce::int64 fileSize, size_t maxBytesToScan)
+	{
+		juce::FileInputStream in(file);
+
+		if (!in.openedOk() || fileSize == 0)
+			return fileSize;
+
+		const int blockSize = 64 * 1024;
+		juce::HeapBlock<char> block(blockSize);
+		juce::int64 end = fileSize;
+		const juce::int64 limit = juce::jmax((juce::int64)0, fileSize - (juce::int64)maxBytesToScan);
+
+		while (end > limit)
+		{
+			const int numToRead = (int)juce::jmin((juce::int64)blockSize, end - limit);
+
+			if (!in.setPosition(end - numToRead) || in.read(block, numToRead) != numToRead)
+				return fileSize;
+
+			for (int i = numToRead; i > 0; --i)
+				if (block[i - 1] != 0)
+					return end - numToRead + i;
+
+			end -= numToRead;
+		}
+
+		return end;
+	}
+
+	bool mapWindow()
+	{
+		const juce::int64 windowEnd = windowStart + (juce::int64)stepSize;
+
+#ifdef JUCE_WINDOWS
+		HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READWRITE,
+			(DWORD)(windowEnd >> 32), (DWORD)windowEnd, NULL);
+
+		if (hMapping == NULL)
+			return false;
+
+		window = static_cast<char*>(MapViewOfFile(hMapping, FILE_MAP_WRITE,
+			(DWORD)(windowStart >> 32), (DWORD)windowStart, stepSize));
+
+		CloseHandle(hMapping);
+#else
+		struct stat info;
+
+		if (::fstat(fileDescriptor, &info) != 0)
+			return false;
+
+		if ((juce::int64)info.st_size < windowEnd)
+		{
+			// Reserving the blocks up front means a full disk fails here, rather
+			// than with a SIGBUS when a write touches a page that has no block.
+ #if JUCE_LINUX
+			const int result = ::posix_fallocate(fileDescriptor, (off_t)info.st_size, (off_t)(windowEnd - info.st_size));
+
+			if (result != 0 && result != EINVAL && result != EOPNOTSUPP)
+				return false;
+
+			if (result != 0 && ::ftruncate(fileDescriptor, (off_t)windowEnd) != 0)
+				return false;
+ #else
+			if (::ftruncate(fileDescriptor, (off_t)windowEnd) != 0)
+				return false;
+ #endif
+		}
+
+		void *address = ::mmap(nullptr, stepSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, (off_t)windowStart);
+		window = address != MAP_FAILED ? static_cast<char*>(address) : nullptr;
+#endif
+
+		return window != nullptr;
+	}
+
+	void unmapWindow()
+	{
+		if (window == nullptr)
+			return;
+
+#ifdef JUCE_WINDOWS
+		UnmapViewOfFile(window);
+#else
+		::munmap(window, stepSize);
+#endif
+
+		window = nullptr;
+	}
+
+	void closeFile(juce::int64 dataSize)
+	{
+		unmapWindow();
+
+#ifdef JUCE_WINDOWS
+		if (hFile != INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER position;
+			position.QuadPart = dataSize;
+
+			if (SetFilePointerEx(hFile, position, NULL, FILE_BEGIN))
+				SetEndOfFile(hFile);
+
+			CloseHandle(hFile);
+			hFile = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (fileDescriptor >= 0)
+		{
+			(void)::ftruncate(fileDescriptor, (off_t)dataSize);
+
+			::close(fileDescriptor);
+			fileDescriptor = -1;
+		}
+#endif
+	}
+
+	//==============================================================================
+	juce::File targetFile;
+	size_t stepSize;
+
+	char *window = nullptr;
+	juce::int64 windowStart = 0;
+	size_t windowPosition = 0;
+
+#ifdef JUCE_WINDOWS
+	HANDLE hFile = INVALID_HANDLE_VALUE;
+#else
+	int fileDescriptor = -1;
+#endif
+
+	JUCE_DECLARE_NON_COPYABLE(MappedFileSink)
+};
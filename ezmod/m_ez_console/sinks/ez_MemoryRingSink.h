@@ -0,0 +1,151 @@
+﻿#pragma once
+#define EZ_MEMORYRINGSINK_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A sink that keeps the most recent output in a fixed-size ring in memory.
+	       在内存中一个固定大小的环形缓冲区里保存最近输出的 Sink。
+
+	Once the ring is full, each write overwrites the oldest bytes, so the sink
+	always holds the last "capacity" bytes that went through it. This is meant
+	for crash reporters and diagnostics that want to attach the recent output
+	without keeping a log file.
+
+	Writes and reads are guarded by a lock, so the contents can be read from
+	any thread while another one writes.
+
+	环形缓冲区写满之后，每次写入都会覆盖最早的字节，因此该 Sink 总是保存着经过它的
+	最后"capacity"个字节。它适用于希望附带最近输出、但又不想保留日志文件的崩溃
+	报告工具和诊断功能。
+
+	写入和读取都受锁保护，因此可以在一个线程写入的同时从任何线程读取其内容。
+
+	@see TeeSink
+*/
+class MemoryRingSink : public ConsoleSink
+{
+public:
+	//==============================================================================
+	/** @brief Creates a sink that keeps the given number of bytes.
+	           创建一个保存指定字节数的 Sink。
+
+		@param capacity  The size of the ring in bytes. The default value is 1 MB.
+		                 环形缓冲区的大小（以字节计）。默认值是1 MB。
+	*/
+	explicit MemoryRingSink(size_t capacity = 1024 * 1024)
+		: ring(capacity), ringSize(capacity)
+	{
+		jassert(capacity > 0);
+	}
+
+	//==============================================================================
+	bool write(const void *data, size_t numBytes) override
+	{
+		const char *source = static_cast<const char*>(data);
+		const juce::ScopedLock sl(lock);
+
+		numBytesWritten += (juce::int64)numBytes;
+
+		// Only the tail of a write that is larger than the ring can survive it.
+		if (numBytes > ringSize)
+		{
+			source += numBytes - ringSize;
+			numBytes = ringSize;
+		}
+
+		const size_t numToEnd = juce::jmin(numBytes, ringSize - writePosition);
+
+		memcpy(ring + writePosition, source, numToEnd);
+		memcpy(ring, source + numToEnd, numBytes - numToEnd);
+
+		writePosition = (writePosition + numBytes) % ringSize;
+		numStored = juce::jmin(numStored + numBytes, ringSize);
+		return true;
+	}
+
+	//==============================================================================
+	/** @brief Returns a copy of the bytes held, oldest first.
+	           返回所保存字节的拷贝，最早的在前。
+	*/
+	juce::MemoryBlock getContents() const
+	{
+		const juce::ScopedLock sl(lock);
+
+		juce::MemoryBlock contents(numStored);
+		const size_t start = (writePosition + ringSize - numStored) % ringSize;
+		const size_t numToEnd = juce::jmin(numStored, ringSize - start);
+
+		memcpy(contents.getData(), ring + start, numToEnd);
+		memcpy(static_cast<char*>(contents.getData()) + numToEnd, ring, numStored - numToEnd);
+		return contents;
+	}
+
+	/** @brief Returns the bytes held as a string, oldest first.
+	           以字符串形式返回所保存的字节，最早的在前。
+
+		If the oldest bytes were cut in the middle of a UTF-8 character, that
+		partial character is left out.
+
+		如果最早的字节是从一个UTF-8字符的中间截断的，该不完整的字符会被略去。
+	*/
+	juce::String getContentsAsString() const
+	{
+		const juce::MemoryBlock contents(getContents());
+		const char *data = static_cast<const char*>(contents.getData());
+		size_t start = 0;
+
+		while (start < contents.getSize() && (data[start] & 0xc0) == 0x80)
+			++start;
+
+		return juce::String::fromUTF8(data + start, (int)(contents.getSize() - start));
+	}
+
+	/** @brief Returns the number of bytes held, at most the capacity.
+	           返回所保存的字节数，最多为容量大小。
+	*/
+	size_t getNumBytesStored() const
+	{
+		const juce::ScopedLock sl(lock);
+		return numStored;
+	}
+
+	/** @brief Returns the number of bytes written since the sink was created or cleared.
+	           返回自 Sink 创建或被清空以来写入的字节数。
+	*/
+	juce::int64 getNumBytesWritten() const
+	{
+		const juce::ScopedLock sl(lock);
+		return numBytesWritten;
+	}
+
+	/** @brief Returns the size of the ring given in the constructor.
+	           返回构造函数中指定的环形缓冲区大小。
+	*/
+	size_t getCapacity() const
+	{
+		return ringSize;
+	}
+
+	/** @brief Throws away everything held.
+	           丢弃所保存的全部数据。
+	*/
+	void clear()
+	{
+		const juce::ScopedLock sl(lock);
+
+		writePosition = 0;
+		numStored = 0;
+		numBytesWritten = 0;
+	}
+
+private:
+	//==============================================================================
+	juce::HeapBlock<char> ring;
+	const size_t ringSize;
+	size_t writePosition = 0, numStored = 0;
+	juce::int64 numBytesWritten = 0;
+	juce::CriticalSection lock;
+
+	JUCE_DECLARE_NON_COPYABLE(MemoryRingSink)
+};
@@ -0,0 +1,498 @@
+﻿#pragma once
+#define EZ_ROTATINGFILESINK_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A sink that writes to a log file, starts a new one when it grows too
+	       large or too old, and compresses the old ones in the background.
+	       写入日志文件的 Sink，当文件过大或过旧时开始写入新文件，并在后台压缩旧文件。
+
+	The data goes to the given file through a FileSink. When a write would
+	take the file over the size limit, or the file is older than the age
+	limit, the file is renamed to a segment named after the time, such as
+	"app.20261017-153012.345.log", and a new, empty file takes its place.
+	Rotation happens between writes, so a single write is never split.
+
+	Renaming is all the producing thread does. A background thread then
+	compresses the segment into a ".gz" file that gunzip can open, deletes
+	the original, and deletes the oldest segments until no more than the
+	given number are left, so disk use stays bounded however long the
+	process runs. Segments that were not compressed when the process ended
+	are compressed the next time a sink is created for the same file, and
+	segments that could not be compressed, for example because the disk was
+	full, are tried again every ten seconds. Other files next to it, such as
+	"app.old.log", are never touched.
+
+	If the file cannot be renamed, for example because another program has it
+	open, writing goes on into the same file, and rotation is tried again a
+	second later rather than before every write.
+
+	数据通过一个 FileSink 写入给定的文件。当某次写入会使文件超过大小上限，或文件
+	存在的时间超过时间上限时，该文件会被重命名为以时间命名的分段，例如
+	"app.20261017-153012.345.log"，并由一个新的空文件取代其位置。轮转发生在两次写入
+	之间，因此单次写入永远不会被拆分。
+
+	生产者线程只负责重命名。随后由一个后台线程将该分段压缩为可以用 gunzip 打开的
+	".gz"文件，删除原文件，并删除最旧的分段，直到剩余数量不超过给定值，因此无论进程
+	运行多久，磁盘占用都是有上限的。进程结束时尚未压缩的分段，会在下次为同一文件
+	创建 Sink 时被压缩；未能压缩的分段（例如因为磁盘已满）每十秒会被再次尝试压缩。
+	旁边的其他文件（例如"app.old.log"）永远不会被改动。
+
+	如果文件无法被重命名（例如另一个程序正打开着它），数据会继续写入同一个文件，
+	并在一秒后再次尝试轮转，而不是在每次写入之前都尝试。
+
+	@see FileSink
+*/
+class RotatingFileSink : public ConsoleSink,
+                         private juce::Thread
+{
+public:
+	//==============================================================================
+	/** @brief Opens a log file, creating it if needed, and starts the background thread.
+	           打开一个日志文件（必要时创建该文件），并启动后台线程。
+
+		@param file                The file to write to. The segments are put next
+		                           to it.
+		                           要写入的文件。分段文件会放在它的旁边。
+
+		@param maxSegmentSize      The size in bytes that starts a new file, or 0 for
+		                           no limit. The default value is 64 MB.
+		                           开始写入新文件的大小（以字节计），设为0则不限制。
+		                           默认值是64 MB。
+
+		@param maxSegmentAge       The age that starts a new file, or zero for no
+		                           limit. The default value is zero.
+		                           开始写入新文件的时长，设为零则不限制。默认值是零。
+
+		@param maxNumSegments      How many old segments are kept. The default value
+		                           is 10.
+		                           保留的旧分段数量。默认值是10。
+
+		@param compressSegments    If true, old segments are compressed with gzip.
+		                           The default value is true.
+		                           设为true则使用gzip压缩旧分段。默认值是true。
+	*/
+	explicit RotatingFileSink(const juce::File &file,
+		juce::int64 maxSegmentSize = 64 * 1024 * 1024,
+		juce::RelativeTime maxSegmentAge = juce::RelativeTime(),
+		int maxNumSegments = 10,
+		bool compressSegments = true)
+		: juce::Thread("RotatingFileSink"),
+		  targetFile(file),
+		  maxSize(maxSegmentSize),
+		  maxAgeMilliseconds(maxSegmentAge.inMilliseconds()),
+		  maxSegments(juce::jmax(0, maxNumSegments)),
+		  compress(compressSegments)
+	{
+		openActiveFile();
+
+		if (compress)
+		{
+			const juce::Array<juce::File> segments(findSegments());
+
+			for (int i = 0; i < segments.size(); ++i)
+				if (!segments.getReference(i).hasFileExtension("gz"))
+					pendingSegments.add(segments.getReference(i));
+		}
+
+		startThread();
+		notify();
+	}
+
+	/** @brief Destructor. Closes the file and stops the background thread.
+	           析构函数。关闭文件并停止后台线程。
+
+		A segment being compressed is left as it is, to be compressed next time.
+
+		正在压缩的分段会保持原样，留待下次压缩。
+	*/
+	~RotatingFileSink()
+	{
+		stopThread(-1);
+
+#ifndef JUCE_WINDOWS
+		if (crashDescriptor >= 0)
+			::close(crashDescriptor);
+#endif
+	}
+
+	//==============================================================================
+	/** @brief Returns true if the current file is open.
+	           如果当前文件已打开，返回true。
+	*/
+	bool openedOk() const
+	{
+		const juce::ScopedLock sl(writeLock);
+		return activeFile != nullptr && activeFile->openedOk();
+	}
+
+	/** @brief Returns the file given in the constructor.
+	           返回构造函数中指定的文件。
+	*/
+	const juce::File& getFile() const
+	{
+		return targetFile;
+	}
+
+	/** @brief Returns the old segments on disk, oldest first.
+	           返回磁盘上的旧分段，最旧的在前。
+
+		Only the files named as this sink names its segments are returned:
+		"app.20261017-153012.345.log", "app.20261017-153012.345-1.log" and the
+		same with ".gz" added, for a file called "app.log".
+
+		只返回按本 Sink 命名分段的方式命名的文件：对于名为"app.log"的文件，即
+		"app.20261017-153012.345.log"、"app.20261017-153012.345-1.log"以及它们加上
+		".gz"后的名称。
+	*/
+	juce::Array<juce::File> findSegments() const
+	{
+		juce::Array<juce::File> candidates, segments;
+		targetFile.getParentDirectory().findChildFiles(candidates, juce::File::findFiles, false,
+			targetFile.getFileNameWithoutExtension() + ".*" + targetFile.getFileExtension() + "*");
+
+		for (int i = 0; i < candidates.size(); ++i)
+			if (isSegment(candidates.getReference(i)))
+				segments.add(candidates.getReference(i));
+
+		std::sort(segments.begin(), segments.end(), [this] (const juce::File &a, const juce::File &b)
+		{
+			return getSegmentTime(a).compareNatural(getSegmentTime(b)) < 0;
+		});
+
+		return segments;
+	}
+
+	/** @brief Starts a new file now.
+	           立即开始写入新文件。
+
+		This can be called from any thread. A write in progress on another
+		thread is finished first.
+
+		可以在任何线程中调用。另一个线程中正在进行的写入会先完成。
+
+		@returns false if the file could not be renamed, in which case writing
+		         goes on into the same file.
+		@returns 文件无法被重命名时返回false，此时数据会继续写入同一个文件。
+
+		@see getNumFailedRotations
+	*/
+	bool rotate()
+	{
+		const juce::ScopedLock sl(writeLock);
+
+		activeFile = nullptr;
+
+		const juce::File segment(createSegmentName());
+		const bool moved = targetFile.moveFileTo(segment);
+
+		if (moved)
+		{
+			const juce::ScopedLock psl(pendingLock);
+			pendingSegments.add(segment);
+		}
+		else
+		{
+			++numFailedRotations;
+			retryTime = juce::Time::getMillisecondCounter() + retryIntervalMilliseconds;
+		}
+
+		openActiveFile();
+
+		if (moved)
+			notify();
+
+		return moved;
+	}
+
+	/** @brief Returns how many times the file could not be renamed to a segment.
+	           返回文件未能被重命名为分段的次数。
+	*/
+	int getNumFailedRotations() const
+	{
+		return numFailedRotations.load();
+	}
+
+	//==============================================================================
+	bool write(const void *data, size_t numBytes) override
+	{
+		const juce::ScopedLock sl(writeLock);
+
+		rotateIfDue(numBytes);
+
+		if (!openedOk() || !activeFile->write(data, numBytes))
+			return false;
+
+		activeSize += (juce::int64)numBytes;
+		return true;
+	}
+
+	bool writeBlocks(const ConsoleDataBlock *blocks, int numBlocks) override
+	{
+		size_t numBytes = 0;
+
+		for (int i = 0; i < numBlocks; ++i)
+			numBytes += blocks[i].size;
+
+		const juce::ScopedLock sl(writeLock);
+
+		rotateIfDue(numBytes);
+
+		if (!openedOk() || !activeFile->writeBlocks(blocks, numBlocks))
+			return false;
+
+		activeSize += (juce::int64)numBytes;
+		return true;
+	}
+
+	// The handle of the current file changes on every rotation, so what is
+	// handed out is a copy of it that each new file is moved into with dup2.
+	// Windows has no way to do that, so there is no handle there.
+	bool getNativeHandle(NativeHandle &handle) const override
+	{
+#ifdef JUCE_WINDOWS
+		juce::ignoreUnused(handle);
+		return false;
+#else
+		handle = crashDescriptor;
+		return crashDescriptor >= 0;
+#endif
+	}
+
+private:
+	//==============================================================================
+	void openActiveFile()
+	{
+		activeFile = new FileSink(targetFile, true);
+		activeSize = targetFile.getSize();
+		openedTime = juce::Time::getMillisecondCounter();
+
+#ifndef JUCE_WINDOWS
+		NativeHandle handle;
+
+		if (!activeFile->getNativeHandle(handle))
+			return;
+
+		if (crashDescriptor < 0)
+			crashDescriptor = ::fcntl(handle, F_DUPFD_CLOEXEC, 0);
+		else if (::dup2(handle, crashDescriptor) >= 0)
+			::fcntl(crashDescriptor, F_SETFD, FD_CLOEXEC);
+#endif
+	}
+
+	void rotateIfDue(size_t numBytesToWrite)
+	{
+		if (activeSize == 0)
+			return;
+
+		if (retryTime != 0)
+		{
+			if ((juce::int32)(juce::Time::getMillisecondCounter() - retryTime) < 0)
+				return;
+
+			retryTime = 0;
+		}
+
+		if ((maxSize > 0 && activeSize + (juce::int64)numBytesToWrite > maxSize)
+			|| (maxAgeMilliseconds > 0 && (juce::int64)(juce::Time::getMillisecondCounter() - openedTime) >= maxAgeMilliseconds))
+			rotate();
+	}
+
+	// Returns the "YYYYMMDD-HHMMSS.mmm[-N]" that createSegmentName put between
+	// the name and the extension of the file, or an empty string. It is cut
+	// out by length rather than by looking for dots, as the target file may
+	// have no extension. These sort in the order the segments were made:
+	// "20261017-153012.345" comes before "20261017-153012.345-1".
+	juce::String getSegmentTime(const juce::File &file) const
+	{
+		const juce::String stem(targetFile.getFileNameWithoutExtension() + ".");
+		const juce::String extension(targetFile.getFileExtension());
+		juce::String fileName(file.getFileName());
+
+		if (fileName.endsWith(".gz"))
+			fileName = fileName.dropLastCharacters(3);
+
+		if (fileName.length() <= stem.length() + extension.length() || !fileName.startsWith(stem) || !fileName.endsWith(extension))
+			return juce::String();
+
+		return fileName.substring(stem.length(), fileName.length() - extension.length());
+	}
+
+	// Matches "stem.YYYYMMDD-HHMMSS.mmm[-N]ext[.gz]", as createSegmentName
+	// makes them.
+	bool isSegment(const juce::File &file) const
+	{
+		const juce::String time(getSegmentTime(file));
+		const char *t = time.toRawUTF8();
+		const char *pattern = "dddddddd-dddddd.ddd";
+		int i = 0;
+
+		for (; pattern[i] != 0; ++i)
+			if (pattern[i] == 'd' ? (t[i] < '0' || t[i] > '9') : t[i] != pattern[i])
+				return false;
+
+		if (t[i] == 0)
+			return true;
+
+		if (t[i++] != '-' || t[i] == 0)
+			return false;
+
+		for (; t[i] != 0; ++i)
+			if (t[i] < '0' || t[i] > '9')
+				return false;
+
+		return true;
+	}
+
+	juce::File createSegmentName() const
+	{
+		const juce::Time now(juce::Time::getCurrentTime());
+		const juce::String stem(targetFile.getFileNameWithoutExtension() + "."
+			+ now.formatted("%Y%m%d-%H%M%S") + "." + juce::String(now.getMilliseconds()).paddedLeft('0', 3));
+
+		juce::File segment(targetFile.getSiblingFile(stem + targetFile.getFileExtension()));
+
+		for (int i = 1; segment.exists() || segment.withFileExtension(segment.getFileExtension() + ".gz").exists(); ++i)
+			segment = targetFile.getSiblingFile(stem + "-" + juce::String(i) + targetFile.getFileExtension());
+
+		return segment;
+	}
+
+	//==============================================================================
+	void run() override
+	{
+		while (!threadShouldExit())
+		{
+			juce::Array<juce::File> failedSegments;
+
+			for (;;)
+			{
+				juce::File segment;
+
+				{
+					const juce::ScopedLock sl(pendingLock);
+
+					if (pendingSegments.size() == 0)
+						break;
+
+					segment = pendingSegments.removeAndReturn(0);
+				}
+
+				if (compress && !compressSegment(segment))
+				{
+					if (threadShouldExit())
+						break;
+
+					failedSegments.add(segment);
+				}
+
+				deleteOldSegments();
+			}
+
+			deleteOldSegments();
+
+			// The segments that could not be compressed go back to the front of
+			// the list, to be tried again later.
+			if (!failedSegments.isEmpty())
+			{
+				const juce::ScopedLock sl(pendingLock);
+
+				for (int i = 0; i < failedSegments.size(); ++i)
+					pendingSegments.insert(i, failedSegments.getReference(i));
+			}
+
+			wait(failedSegments.isEmpty() ? -1 : (int)compressRetryIntervalMilliseconds);
+		}
+	}
+
+	// Returns false if the segment is still there uncompressed.
+	bool compressSegment(const juce::File &segment)
+	{
+		const juce::File compressed(segment.getFullPathName() + ".gz");
+		bool completed = false;
+
+		// It may have been deleted as one of the oldest in the meantime.
+		if (!segment.existsAsFile())
+			return true;
+
+		{
+			juce::FileInputStream source(segment);
+
+			if (!source.openedOk())
+				return false;
+
+			compressed.deleteFile();
+			juce::FileOutputStream *destination = new juce::FileOutputStream(compressed);
+
+			if (!destination->openedOk())
+			{
+				delete destination;
+				return false;
+			}
+
+			// A window of 15 + 16 bits makes zlib write a gzip header.
+			juce::GZIPCompressorOutputStream gzip(destination, -1, true, 15 + 16);
+			juce::HeapBlock<char> block(blockSize);
+
+			while (!threadShouldExit())
+			{
+				const int numRead = source.read(block, blockSize);
+
+				if (numRead <= 0)
+				{
+					completed = true;
+					break;
+				}
+
+				if (!gzip.write(block, (size_t)numRead))
+					break;
+			}
+		}
+
+		if (!completed)
+		{
+			compressed.deleteFile();
+			return false;
+		}
+
+		segment.deleteFile();
+		return true;
+	}
+
+	void deleteOldSegments()
+	{
+		const juce::Array<juce::File> segments(findSegments());
+
+		for (int i = 0; i < segments.size() - maxSegments; ++i)
+			segments.getReference(i).deleteFile();
+	}
+
+	//==============================================================================
+	enum
+	{
+		blockSize = 64 * 1024,
+		retryIntervalMilliseconds = 1000,
+		compressRetryIntervalMilliseconds = 10000
+	};
+
+	const juce::File targetFile;
+	const juce::int64 maxSize, maxAgeMilliseconds;
+	const int maxSegments;
+	const bool compress;
+
+	juce::CriticalSection writeLock;
+	juce::ScopedPointer<FileSink> activeFile;
+	juce::int64 activeSize = 0;
+	juce::uint32 openedTime = 0, retryTime = 0;
+
+#ifndef JUCE_WINDOWS
+	int crashDescriptor = -1;
+#endif
+	std::atomic<int> numFailedRotations { 0 };
+
+	juce::CriticalSection pendingLock;
+	juce::Array<juce::File> pendingSegments;
+
+	JUCE_DECLARE_NON_COPYABLE(RotatingFileSink)
+};
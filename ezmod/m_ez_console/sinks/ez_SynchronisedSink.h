@@ -0,0 +1,101 @@
+﻿#pragma once
+#define EZ_SYNCHRONISEDSINK_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A sink that lets several threads share another sink safely.
+	       让多个线程安全地共享另一个 Sink 的 Sink。
+
+	Every call is passed on to the destination sink while holding a lock, so the
+	data of one "write" call is never mixed with the data of another. A list of
+	chunks or blocks is passed on whole under a single lock, so the data of a
+	stream that spans several chunks stays together too, and the destination
+	can still write it with one "writev" call.
+
+	每次调用都会在持有锁的情况下转交给目标 Sink，因此一次"write"调用的数据永远不
+	会与另一次调用的数据混在一起。内存块链表或多块数据会在一次加锁中被整体转交，
+	因此跨越多个内存块的输出流数据同样不会被拆开，目标 Sink 也仍然可以用一次
+	"writev"调用将其写出。
+
+*/
+class SynchronisedSink : public ConsoleSink
+{
+public:
+	//==============================================================================
+	/** @brief Creates a sink that guards the given one with a lock.
+	           创建一个用锁保护指定 Sink 的 Sink。
+
+		@param destinationSink  The sink to pass the data to.
+		                        数据要转交给的 Sink。
+
+		@param takeOwnership    If true, the destination sink will be deleted when
+		                        this sink is deleted.
+		                        设为true则在删除本 Sink 时一并删除目标 Sink。
+	*/
+	SynchronisedSink(ConsoleSink *destinationSink, bool takeOwnership)
+		: destination(destinationSink, takeOwnership)
+	{
+		jassert(destinationSink != nullptr);
+	}
+
+	//==============================================================================
+	bool write(const void *data, size_t numBytes) override
+	{
+		const juce::ScopedLock sl(lock);
+		return destination->write(data, numBytes);
+	}
+
+	bool writeBlocks(const ConsoleDataBlock *blocks, int numBlocks) override
+	{
+		const juce::ScopedLock sl(lock);
+		return destination->writeBlocks(blocks, numBlocks);
+	}
+
+	bool consumeChunks(ConsoleChunk *firstChunk) override
+	{
+		const juce::ScopedLock sl(lock);
+		return destination->consumeChunks(firstChunk);
+	}
+
+	bool writeChunks(const ConsoleChunk *firstChunk) override
+	{
+		const juce::ScopedLock sl(lock);
+		return destination->writeChunks(firstChunk);
+	}
+
+	bool flush() override
+	{
+		const juce::ScopedLock sl(lock);
+		return destination->flush();
+	}
+
+	AsyncResult consumeChunksAsync(ConsoleChunk *firstChunk, AsyncCallback whenConsumed) override
+	{
+		const juce::ScopedLock sl(lock);
+		return destination->consumeChunksAsync(firstChunk, std::move(whenConsumed));
+	}
+
+	AsyncResult flushAsync(AsyncCallback whenFlushed) override
+	{
+		const juce::ScopedLock sl(lock);
+		return destination->flushAsync(std::move(whenFlushed));
+	}
+
+	bool isInteractive() const override
+	{
+		return destination->isInteractive();
+	}
+
+	bool getNativeHandle(NativeHandle &handle) const override
+	{
+		return destination->getNativeHandle(handle);
+	}
+
+private:
+	//==============================================================================
+	juce::OptionalScopedPointer<ConsoleSink> destination;
+	juce::CriticalSection lock;
+
+	JUCE_DECLARE_NON_COPYABLE(SynchronisedSink)
+};
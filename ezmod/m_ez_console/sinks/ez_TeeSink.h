@@ -0,0 +1,440 @@
+﻿#pragma once
+#define EZ_TEESINK_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A sink that sends the same data to several other sinks.
+	       将相同的数据发送给多个其他 Sink 的 Sink。
+
+	A stream in front of a TeeSink formats each message once. The chunks it
+	hands over are wrapped in a shared, reference counted list that is never
+	changed again, and every destination reads that same list: nothing is
+	formatted twice and, for data handed over through "consumeChunks", nothing
+	is copied either. The chunks go back to the ConsoleChunkPool when the last
+	destination is done with them.
+
+	Each destination is written either inline, in the thread that writes to
+	the tee, or by a thread of its own, so a slow file or terminal does not
+	hold up the others. A destination with its own thread waits for room when
+	its queue is full.
+
+	Each destination also has a minimum level. The data written to the tee
+	itself has the level given in the constructor; "getSinkForLevel" returns a
+	sink that writes at another level, so for example a stream of warnings can
+	reach the console and the file, while a stream of debug messages only
+	reaches the memory ring.
+
+	Destinations must be added before the tee is used. Several threads may
+	write to it at once only if every inline destination can take that, for
+	example by wrapping it in a SynchronisedSink.
+
+	位于 TeeSink 之前的输出流只需对每条消息格式化一次。它交出的内存块会被包装成一个
+	共享的、带引用计数的、之后不再修改的链表，每个目的地都读取这同一个链表：没有
+	任何内容被格式化两次，对于通过"consumeChunks"交出的数据，也不会产生任何拷贝。
+	当最后一个目的地处理完毕后，这些内存块会被归还给 ConsoleChunkPool。
+
+	每个目的地要么在写入 TeeSink 的线程中直接写出，要么由其专属的线程写出，因此缓慢
+	的文件或终端不会拖慢其他目的地。拥有专属线程的目的地在其队列已满时会等待队列
+	腾出空间。
+
+	每个目的地还有一个最低级别。直接写入 TeeSink 的数据具有构造函数中指定的级别；
+	"getSinkForLevel"返回一个以其他级别写入的 Sink。例如，警告信息的输出流可以到达
+	控制台和文件，而调试信息的输出流只到达内存环形缓冲区。
+
+	必须在使用 TeeSink 之前添加目的地。只有当每个直接写出的目的地都能承受多个线程
+	同时写入时（例如将其包装在 SynchronisedSink 中），才能让多个线程同时写入。
+
+	@see MemoryRingSink, CallbackSink
+*/
+class TeeSink : public ConsoleSink
+{
+public:
+	//==============================================================================
+	/** @brief How important some data is.
+	           数据的重要程度。
+	*/
+	enum Level
+	{
+		debug,     /**< 调试。 */
+		info,      /**< 信息。 */
+		warning,   /**< 警告。 */
+		error,     /**< 错误。 */
+		fatal,     /**< 致命错误。 */
+		numLevels
+	};
+
+	//==============================================================================
+	/** @brief Creates a tee with no destinations.
+	           创建一个没有目的地的 TeeSink。
+
+		@param levelOfWrites  The level of the data written to the tee itself.
+		                      The default value is info.
+		                      直接写入 TeeSink 的数据的级别。默认值是info。
+	*/
+	explicit TeeSink(Level levelOfWrites = info)
+		: defaultLevel(levelOfWrites)
+	{
+		for (int i = 0; i < numLevels; ++i)
+			levelSinks.add(new LevelSink(*this, (Level)i));
+	}
+
+	/** @brief Destructor. Writes out everything still queued, then stops the threads.
+	           析构函数。写出所有仍在队列中的数据，然后停止线程。
+	*/
+	~TeeSink()
+	{
+		destinations.clear();
+	}
+
+	//==============================================================================
+	/** @brief Adds a sink that the data is sent to.
+	           添加一个数据要发送到的 Sink。
+
+		@param sink              The sink to add.
+		                         要添加的 Sink。
+
+		@param takeOwnership     If true, the sink will be deleted when the tee is
+		                         deleted.
+		                         设为true则在删除 TeeSink 时一并删除该 Sink。
+
+		@param minimumLevel      Data below this level is not sent to the sink. The
+		                         default value is debug, which lets everything in.
+		                         低于该级别的数据不会发送给该 Sink。默认值是debug，
+		                         即接收所有数据。
+
+		@param useOwnThread      If true, the sink is written by a thread of its own
+		                         rather than by the thread that writes to the tee.
+		                         The default value is false.
+		                         设为true则由专属线程写出该 Sink，而不是由写入 TeeSink
+		                         的线程写出。默认值是false。
+
+		@param maxQueuedBuffers  How many buffers may wait for the sink's own thread
+		                         before writers have to wait. The default value is 64.
+		                         在写入者必须等待之前，最多允许多少个缓冲区等待该
+		                         Sink 的专属线程写出。默认值是64。
+
+		@returns the index of the new destination.
+		@returns 新目的地的索引。
+	*/
+	int addDestination(ConsoleSink *sink, bool takeOwnership, Level minimumLevel = debug,
+		bool useOwnThread = false, int maxQueuedBuffers = 64)
+	{
+		jassert(sink != nullptr);
+
+		destinations.add(new Destination(sink, takeOwnership, minimumLevel, useOwnThread, maxQueuedBuffers));
+		return destinations.size() - 1;
+	}
+
+	/** @brief Returns the number of destinations.
+	           返回目的地的数量。
+	*/
+	int getNumDestinations() const
+	{
+		return destinations.size();
+	}
+
+	/** @brief Returns the sink of a destination.
+	           返回一个目的地的 Sink。
+	*/
+	ConsoleSink* getDestination(int index) const
+	{
+		Destination *d = destinations[index];
+		return d != nullptr ? d->getSink() : nullptr;
+	}
+
+	/** @brief Changes the minimum level of a destination.
+	           更改一个目的地的最低级别。
+
+		This can be called at any time, from any thread.
+
+		可以在任何时候、任何线程中调用。
+	*/
+	void setMinimumLevel(int index, Level minimumLevel)
+	{
+		if (Destination *d = destinations[index])
+			d->setMinimumLevel(minimumLevel);
+	}
+
+	/** @brief Returns the minimum level of a destination.
+	           返回一个目的地的最低级别。
+	*/
+	Level getMinimumLevel(int index) const
+	{
+		Destination *d = destinations[index];
+		return d != nullptr ? d->getMinimumLevel() : debug;
+	}
+
+	//==============================================================================
+	/** @brief Returns a sink that writes to the tee at the given level.
+	           返回一个以指定级别写入 TeeSink 的 Sink。
+
+		The sink belongs to the tee, so pass false as "takeOwnership" when
+		giving it to ConsoleOutputStream::setSink.
+
+		该 Sink 属于 TeeSink，因此在将其交给 ConsoleOutputStream::setSink 时，
+		"takeOwnership"应传入false。
+
+		@code
+		TeeSink tee;
+		tee.addDestination(new StandardOutputSink(), true, TeeSink::info);
+		tee.addDestination(new FileSink(logFile), true, TeeSink::debug, true);
+		tee.addDestination(&crashRing, false);
+
+		ezout.setSink(tee.getSinkForLevel(TeeSink::info), false);
+		debugStream.setSink(tee.getSinkForLevel(TeeSink::debug), false);
+		@endcode
+	*/
+	ConsoleSink* getSinkForLevel(Level level) const
+	{
+		jassert(level >= 0 && level < numLevels);
+		return levelSinks[level];
+	}
+
+	//==============================================================================
+	bool write(const void *data, size_t numBytes) override
+	{
+		const ConsoleDataBlock block = { data, numBytes };
+		return writeAtLevel(defaultLevel, &block, 1);
+	}
+
+	bool writeBlocks(const ConsoleDataBlock *blocks, int numBlocks) override
+	{
+		return writeAtLevel(defaultLevel, blocks, numBlocks);
+	}
+
+	bool consumeChunks(ConsoleChunk *firstChunk) override
+	{
+		return consumeAtLevel(defaultLevel, firstChunk);
+	}
+
+	/** @brief Waits for every destination's thread to catch up, then flushes every destination.
+	           等待每个目的地的线程处理完毕，然后刷新每个目的地。
+	*/
+	bool flush() override
+	{
+		bool result = true;
+
+		for (int i = 0; i < destinations.size(); ++i)
+			result = destinations.getUnchecked(i)->flush() && result;
+
+		return result;
+	}
+
+	/** @brief Returns true if any destination is interactive.
+	           如果任何一个目的地是交互式的，返回true。
+	*/
+	bool isInteractive() const override
+	{
+		for (int i = 0; i < destinations.size(); ++i)
+			if (destinations.getUnchecked(i)->getSink()->isInteractive())
+				return true;
+
+		return false;
+	}
+
+	/** @brief Gets the handle of the first destination that has one.
+	           获取第一个具有句柄的目的地的句柄。
+	*/
+	bool getNativeHandle(NativeHandle &handle) const override
+	{
+		for (int i = 0; i < destinations.size(); ++i)
+			if (destinations.getUnchecked(i)->getSink()->getNativeHandle(handle))
+				return true;
+
+		return false;
+	}
+
+private:
+	//==============================================================================
+	class SharedChunks : public juce::ReferenceCountedObject
+	{
+	public:
+		typedef juce::ReferenceCountedObjectPtr<SharedChunks> Ptr;
+
+		explicit SharedChunks(ConsoleChunk *chunks)
+			: firstChunk(chunks)
+		{
+		}
+
+		~SharedChunks()
+		{
+			ConsoleChunkPool::getInstance().releaseList(firstChunk);
+		}
+
+		ConsoleChunk *const firstChunk;
+
+		JUCE_DECLARE_NON_COPYABLE(SharedChunks)
+	};
+
+	//==============================================================================
+	// A destination with its own thread is written by a ConsoleAsyncWriter,
+	// which reads the shared chunks without taking them over.
+	class Destination
+	{
+	public:
+		Destination(ConsoleSink *destinationSink, bool takeOwnership, Level level,
+			bool useOwnThread, int maxQueuedBuffers)
+			: sink(destinationSink, takeOwnership),
+			  minimumLevel(level)
+		{
+			if (useOwnThread)
+				writer = new ConsoleAsyncWriter(destinationSink, false, ConsoleAsyncWriter::blockWhenFull, maxQueuedBuffers);
+		}
+
+		~Destination()
+		{
+			writer = nullptr;
+		}
+
+		ConsoleSink* getSink() const        { return sink.get(); }
+		bool isThreaded() const             { return writer != nullptr; }
+		Level getMinimumLevel() const       { return (Level)minimumLevel.load(std::memory_order_relaxed); }
+		void setMinimumLevel(Level level)   { minimumLevel.store(level, std::memory_order_relaxed); }
+		bool accepts(Level level) const     { return level >= getMinimumLevel(); }
+
+		bool writeNow(const ConsoleDataBlock *blocks, int numBlocks)
+		{
+			return sink->writeBlocks(blocks, numBlocks);
+		}
+
+		bool writeNow(const ConsoleChunk *chunks)
+		{
+			return sink->writeChunks(chunks);
+		}
+
+		void enqueue(SharedChunks *shared)
+		{
+			writer->writeSharedChunks(shared->firstChunk, shared);
+		}
+
+		bool flush()
+		{
+			return writer != nullptr ? writer->flush() : sink->flush();
+		}
+
+	private:
+		juce::OptionalScopedPointer<ConsoleSink> sink;
+		std::atomic<int> minimumLevel;
+		juce::ScopedPointer<ConsoleAsyncWriter> writer;
+
+		JUCE_DECLARE_NON_COPYABLE(Destination)
+	};
+
+	//==============================================================================
+	class LevelSink : public ConsoleSink
+	{
+	public:
+		LevelSink(TeeSink &teeSink, Level levelOfWrites)
+			: tee(teeSink), level(levelOfWrites)
+		{
+		}
+
+		bool write(const void *data, size_t numBytes) override
+		{
+			const ConsoleDataBlock block = { data, numBytes };
+			return tee.writeAtLevel(level, &block, 1);
+		}
+
+		bool writeBlocks(const ConsoleDataBlock *blocks, int numBlocks) override
+		{
+			return tee.writeAtLevel(level, blocks, numBlocks);
+		}
+
+		bool consumeChunks(ConsoleChunk *firstChunk) override
+		{
+			return tee.consumeAtLevel(level, firstChunk);
+		}
+
+		bool flush() override
+		{
+			return tee.flush();
+		}
+
+		bool isInteractive() const override
+		{
+			return tee.isInteractive();
+		}
+
+		bool getNativeHandle(NativeHandle &handle) const override
+		{
+			return tee.getNativeHandle(handle);
+		}
+
+	private:
+		TeeSink &tee;
+		const Level level;
+
+		JUCE_DECLARE_NON_COPYABLE(LevelSink)
+	};
+
+	//==============================================================================
+	// The threaded destinations are queued first, so their threads can start
+	// while the inline ones are being written.
+	bool writeAtLevel(Level level, const ConsoleDataBlock *blocks, int numBlocks)
+	{
+		SharedChunks::Ptr shared;
+		bool result = true;
+
+		for (int i = 0; i < destinations.size(); ++i)
+		{
+			Destination *d = destinations.getUnchecked(i);
+
+			if (d->isThreaded() && d->accepts(level))
+			{
+				if (shared == nullptr)
+				{
+					ConsoleChunkBuffer copy;
+
+					for (int j = 0; j < numBlocks; ++j)
+						copy.append(blocks[j].data, blocks[j].size);
+
+					shared = new SharedChunks(copy.detachChunks());
+				}
+
+				d->enqueue(shared);
+			}
+		}
+
+		for (int i = 0; i < destinations.size(); ++i)
+		{
+			Destination *d = destinations.getUnchecked(i);
+
+			if (!d->isThreaded() && d->accepts(level))
+				result = d->writeNow(blocks, numBlocks) && result;
+		}
+
+		return result;
+	}
+
+	bool consumeAtLevel(Level level, ConsoleChunk *firstChunk)
+	{
+		const SharedChunks::Ptr shared(new SharedChunks(firstChunk));
+		bool result = true;
+
+		for (int i = 0; i < destinations.size(); ++i)
+		{
+			Destination *d = destinations.getUnchecked(i);
+
+			if (d->isThreaded() && d->accepts(level))
+				d->enqueue(shared);
+		}
+
+		for (int i = 0; i < destinations.size(); ++i)
+		{
+			Destination *d = destinations.getUnchecked(i);
+
+			if (!d->isThreaded() && d->accepts(level))
+				result = d->writeNow(firstChunk) && result;
+		}
+
+		return result;
+	}
+
+	//==============================================================================
+	const Level defaultLevel;
+	juce::OwnedArray<Destination> destinations;
+	juce::OwnedArray<LevelSink> levelSinks;
+
+	JUCE_DECLARE_NON_COPYABLE(TeeSink)
+};
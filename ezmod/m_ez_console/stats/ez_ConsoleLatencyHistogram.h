@@ -0,0 +1,183 @@
+﻿#pragma once
+#define EZ_CONSOLELATENCYHISTOGRAM_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Counts durations in buckets that keep about 3% precision at any scale.
+	       将时长计入在任何量级下都保持约3%精度的桶中。
+
+	This is laid out like an HDR histogram: values below 32 have a bucket
+	each, and every power of two above that is split into 32 buckets, up to
+	about 18 minutes in nanoseconds. Recording a value is a few shifts and an
+	atomic increment, with no allocation and no lock, so it can be done on a
+	hot path and from several threads, while another thread reads the
+	percentiles.
+
+	其布局与HDR直方图相同：小于32的值各占一个桶，在此之上的每个2的幂区间被分为
+	32个桶，以纳秒计最多约18分钟。记录一个值只需几次移位和一次原子递增，没有内存
+	分配也没有锁，因此可以在热点路径上、在多个线程中进行，同时另一个线程读取其
+	百分位数。
+
+	@see ConsoleStreamStats
+*/
+class ConsoleLatencyHistogram
+{
+public:
+	//==============================================================================
+	enum
+	{
+		subBucketBits = 5,
+		numSubBuckets = 1 << subBucketBits,
+		maxValueBits = 40,
+		numBuckets = numSubBuckets * (maxValueBits - subBucketBits + 1)
+	};
+
+	/** @brief Creates an empty histogram.
+	           创建一个空的直方图。
+	*/
+	ConsoleLatencyHistogram()
+	{
+		reset();
+	}
+
+	//==============================================================================
+	/** @brief Adds a value. Values too large for the range count as the largest.
+	           添加一个值。超出范围的值按最大值计。
+	*/
+	void record(juce::uint64 value)
+	{
+		const juce::uint64 largest = ((juce::uint64)1 << maxValueBits) - 1;
+
+		if (value > largest)
+			value = largest;
+
+		buckets[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(value, std::memory_order_relaxed);
+
+		juce::uint64 currentMax = maximum.load(std::memory_order_relaxed);
+
+		while (value > currentMax && !maximum.compare_exchange_weak(currentMax, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	/** @brief Removes all the values.
+	           移除所有的值。
+	*/
+	void reset()
+	{
+		for (int i = 0; i < numBuckets; ++i)
+			buckets[i].store(0, std::memory_order_relaxed);
+
+		count.store(0, std::memory_order_relaxed);
+		sum.store(0, std::memory_order_relaxed);
+		maximum.store(0, std::memory_order_relaxed);
+	}
+
+	//==============================================================================
+	/** @brief Returns how many values have been recorded.
+	           返回已记录的值的数量。
+	*/
+	juce::uint64 getCount() const
+	{
+		return count.load(std::memory_order_relaxed);
+	}
+
+	/** @brief Returns the largest value recorded, exactly.
+	           返回记录到的最大值（精确值）。
+	*/
+	juce::uint64 getMax() const
+	{
+		return maximum.load(std::memory_order_relaxed);
+	}
+
+	/** @brief Returns the mean of the values recorded, exactly.
+	           返回记录到的值的平均值（精确值）。
+	*/
+	double getMean() const
+	{
+		const juce::uint64 n = getCount();
+		return n > 0 ? (double)sum.load(std::memory_order_relaxed) / (double)n : 0.0;
+	}
+
+	/** @brief Returns the value that the given percentage of values are at or below.
+	           返回给定百分比的值小于或等于的那个值。
+
+		The result is the upper end of the bucket the value falls in, so it is
+		never below the real value and at most about 3% above it.
+
+		结果为该值所在桶的上限，因此不会低于真实值，最多高出约3%。
+
+		@param percentile  From 0 to 100, such as 50, 99 or 99.9.
+		                   从0到100，例如50、99或99.9。
+	*/
+	juce::uint64 getValueAtPercentile(double percentile) const
+	{
+		const juce::uint64 n = getCount();
+
+		if (n == 0)
+			return 0;
+
+		const double fraction = juce::jlimit(0.0, 100.0, percentile) / 100.0;
+		const juce::uint64 target = juce::jmax((juce::uint64)1, (juce::uint64)std::ceil(fraction * (double)n));
+		juce::uint64 seen = 0;
+
+		for (int i = 0; i < numBuckets; ++i)
+		{
+			seen += buckets[i].load(std::memory_order_relaxed);
+
+			if (seen >= target)
+				return juce::jmin(getBucketHighestValue(i), getMax());
+		}
+
+		return getMax();
+	}
+
+private:
+	//==============================================================================
+	static int getHighestBit(juce::uint64 value)
+	{
+		int bit = 0;
+
+		for (int shift = 32; shift > 0; shift >>= 1)
+		{
+			if ((value >> shift) != 0)
+			{
+				value >>= shift;
+				bit += shift;
+			}
+		}
+
+		return bit;
+	}
+
+	// Below numSubBuckets a value is its own index. Above, the highest bit
+	// picks a group of numSubBuckets and the next subBucketBits bits pick one
+	// bucket in it.
+	static int getBucketIndex(juce::uint64 value)
+	{
+		if (value < (juce::uint64)numSubBuckets)
+			return (int)value;
+
+		const int shift = getHighestBit(value) - subBucketBits;
+		return numSubBuckets * (shift + 1) + (int)(value >> shift) - numSubBuckets;
+	}
+
+	static juce::uint64 getBucketHighestValue(int index)
+	{
+		if (index < numSubBuckets)
+			return (juce::uint64)index;
+
+		const int shift = index / numSubBuckets - 1;
+		const juce::uint64 top = (juce::uint64)(index % numSubBuckets + numSubBuckets);
+		return ((top + 1) << shift) - 1;
+	}
+
+	//==============================================================================
+	std::atomic<juce::uint64> buckets[numBuckets];
+	std::atomic<juce::uint64> count, sum, maximum;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleLatencyHistogram)
+};
@@ -0,0 +1,179 @@
+﻿#pragma once
+#define EZ_CONSOLESTREAMSTATS_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Counters that a ConsoleOutputStream keeps about its own output.
+	       ConsoleOutputStream 关于其自身输出所维护的计数器。
+
+	A stream counts the messages written to it (each write, "<<", "print" or
+	"log" call is one), the bytes and the number of prints that reached its
+	sink, and the largest amount of data it held at once. The time each print
+	spends in the sink goes into a ConsoleLatencyHistogram. In async mode that
+	is the time to hand the data to the writer thread.
+
+	All of it only exists when EZ_CONSOLE_ENABLE_STATS is 1. Otherwise every
+	method of this class is empty and inlined away, and a Snapshot is all
+	zeros, so code that reads the stats still builds.
+
+	输出流会统计写入它的消息数（每次 write、"<<"、"print"或"log"调用算一条）、到达其
+	Sink 的字节数和输出次数，以及它一次持有的最大数据量。每次输出在 Sink 中花费的
+	时间被计入一个 ConsoleLatencyHistogram。在异步模式下，这是将数据交给写线程所
+	花费的时间。
+
+	所有这些只在 EZ_CONSOLE_ENABLE_STATS 为1时才存在。否则该类的每个方法都是空的，
+	会被内联消除，Snapshot 全部为零，因此读取统计数据的代码仍然可以编译。
+
+	@see ConsoleOutputStream::getStats
+*/
+class ConsoleStreamStats
+{
+public:
+	//==============================================================================
+	/** @brief The values of the counters at one moment.
+	           计数器在某一时刻的值。
+	*/
+	struct Snapshot
+	{
+		juce::uint64 numMessages = 0;         /**< Writes into the stream. 写入输出流的次数。 */
+		juce::uint64 numBytesPrinted = 0;     /**< Bytes handed to the sink. 交给 Sink 的字节数。 */
+		juce::uint64 numPrints = 0;           /**< Calls to the sink. 调用 Sink 的次数。 */
+		juce::uint64 peakBufferSize = 0;      /**< Most bytes buffered at once. 一次缓冲的最大字节数。 */
+
+		double meanPrintMicroseconds = 0.0;   /**< Mean time of a print. 一次输出的平均时间。 */
+		double p50PrintMicroseconds = 0.0;    /**< Median time of a print. 一次输出时间的中位数。 */
+		double p99PrintMicroseconds = 0.0;    /**< 99th percentile. 第99百分位数。 */
+		double p999PrintMicroseconds = 0.0;   /**< 99.9th percentile. 第99.9百分位数。 */
+		double maxPrintMicroseconds = 0.0;    /**< Longest print. 最长的一次输出。 */
+
+		/** @brief Returns the snapshot as "name=value" lines.
+		           以"名称=值"的多行形式返回该快照。
+		*/
+		juce::String toString() const
+		{
+			juce::String text;
+
+			text << "messages=" << juce::String((juce::int64)numMessages) << "\n"
+			     << "bytesPrinted=" << juce::String((juce::int64)numBytesPrinted) << "\n"
+			     << "prints=" << juce::String((juce::int64)numPrints) << "\n"
+			     << "peakBufferSize=" << juce::String((juce::int64)peakBufferSize) << "\n"
+			     << "printMeanMicroseconds=" << juce::String(meanPrintMicroseconds, 3) << "\n"
+			     << "printP50Microseconds=" << juce::String(p50PrintMicroseconds, 3) << "\n"
+			     << "printP99Microseconds=" << juce::String(p99PrintMicroseconds, 3) << "\n"
+			     << "printP999Microseconds=" << juce::String(p999PrintMicroseconds, 3) << "\n"
+			     << "printMaxMicroseconds=" << juce::String(maxPrintMicroseconds, 3) << "\n";
+
+			return text;
+		}
+	};
+
+	//==============================================================================
+	/** @brief Returns true if the stats were compiled in.
+	           如果统计功能被编译进来，返回true。
+	*/
+	static constexpr bool isEnabled()
+	{
+		return EZ_CONSOLE_ENABLE_STATS != 0;
+	}
+
+#if EZ_CONSOLE_ENABLE_STATS
+	//==============================================================================
+	/** @brief Returns the current values of the counters.
+	           返回计数器的当前值。
+	*/
+	Snapshot getSnapshot() const
+	{
+		Snapshot snapshot;
+
+		snapshot.numMessages = numMessages.load(std::memory_order_relaxed);
+		snapshot.numBytesPrinted = numBytesPrinted.load(std::memory_order_relaxed);
+		snapshot.numPrints = printLatency.getCount();
+		snapshot.peakBufferSize = peakBufferSize.load(std::memory_order_relaxed);
+
+		snapshot.meanPrintMicroseconds = printLatency.getMean() / 1000.0;
+		snapshot.p50PrintMicroseconds = (double)printLatency.getValueAtPercentile(50.0) / 1000.0;
+		snapshot.p99PrintMicroseconds = (double)printLatency.getValueAtPercentile(99.0) / 1000.0;
+		snapshot.p999PrintMicroseconds = (double)printLatency.getValueAtPercentile(99.9) / 1000.0;
+		snapshot.maxPrintMicroseconds = (double)printLatency.getMax() / 1000.0;
+
+		return snapshot;
+	}
+
+	/** @brief Returns the histogram of print times, in nanoseconds.
+	           返回输出时间（以纳秒计）的直方图。
+	*/
+	const ConsoleLatencyHistogram& getPrintLatency() const
+	{
+		return printLatency;
+	}
+
+	/** @brief Sets all the counters back to zero.
+	           将所有计数器归零。
+	*/
+	void reset()
+	{
+		numMessages.store(0, std::memory_order_relaxed);
+		numBytesPrinted.store(0, std::memory_order_relaxed);
+		peakBufferSize.store(0, std::memory_order_relaxed);
+		printLatency.reset();
+	}
+
+	//==============================================================================
+	/** @internal */
+	void addMessage(size_t bufferSize)
+	{
+		numMessages.fetch_add(1, std::memory_order_relaxed);
+
+		if (bufferSize > peakBufferSize.load(std::memory_order_relaxed))
+			peakBufferSize.store(bufferSize, std::memory_order_relaxed);
+	}
+
+	/** @internal */
+	struct PrintTimer
+	{
+		PrintTimer(ConsoleStreamStats &s, size_t numBytes)
+			: stats(s), startTicks(juce::Time::getHighResolutionTicks())
+		{
+			stats.numBytesPrinted.fetch_add(numBytes, std::memory_order_relaxed);
+		}
+
+		~PrintTimer()
+		{
+			const juce::int64 elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+			stats.printLatency.record((juce::uint64)(juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e9));
+		}
+
+		ConsoleStreamStats &stats;
+		const juce::int64 startTicks;
+	};
+
+private:
+	//==============================================================================
+	std::atomic<juce::uint64> numMessages { 0 }, numBytesPrinted { 0 }, peakBufferSize { 0 };
+	ConsoleLatencyHistogram printLatency;
+#else
+	//==============================================================================
+	Snapshot getSnapshot() const
+	{
+		return Snapshot();
+	}
+
+	void reset()
+	{
+	}
+
+	/** @internal */
+	void addMessage(size_t)
+	{
+	}
+
+	/** @internal */
+	struct PrintTimer
+	{
+		PrintTimer(ConsoleStreamStats&, size_t)
+		{
+		}
+	};
+#endif
+};
@@ -0,0 +1,199 @@
+﻿#pragma once
+#define EZ_CONCURRENTCONSOLESTREAM_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A console stream that any number of threads can write to at once.
+	       一个可供任意数量线程同时写入的控制台输出流。
+
+	A single ConsoleOutputStream must not be used by more than one thread. This
+	class gives every thread its own ConsoleOutputStream to format into, and only
+	meets the other threads when whole lines are published to the shared sink.
+
+	By default, publishing goes through a ConsoleAsyncWriter, whose lock-free
+	queue keeps contention close to zero even with many producer threads. The
+	writer thread writes each published block in one piece, so lines from
+	different threads are never interleaved.
+
+	The per-thread streams are created the first time a thread calls "local",
+	and are kept until this object is deleted.
+
+	单个 ConsoleOutputStream 不能被多个线程使用。该类为每个线程提供一个独立的
+	ConsoleOutputStream 用于格式化数据，各线程之间只有在将完整的行发布到共享的
+	Sink 时才会发生交集。
+
+	默认情况下，发布操作通过 ConsoleAsyncWriter 完成，其无锁队列即使在生产者线程
+	很多的情况下也能让竞争接近于零。写线程会将每次发布的数据块整体写出，因此不同
+	线程的行永远不会交错在一起。
+
+	每个线程的输出流在该线程第一次调用"local"时创建，并一直保留到本对象被删除。
+
+	@code
+	ConcurrentConsoleStream ezlog;
+
+	// on any thread
+	ezlog << "worker " << workerIndex << " done" << newLine;
+	ezlog.publish();
+	@endcode
+
+*/
+class ConcurrentConsoleStream
+{
+public:
+	//==============================================================================
+	/** @brief Creates a stream that publishes to the given sink.
+	           创建一个向指定 Sink 发布数据的输出流。
+
+		@param destinationSink   The shared sink, or nullptr for the standard output.
+		                         共享的 Sink，设为nullptr则使用标准输出。
+
+		@param takeOwnership     If true, the sink will be deleted when this object
+		                         is deleted.
+		                         设为true则在删除本对象时一并删除该 Sink。
+
+		@param useWriterThread   If true, published lines are handed to a background
+		                         writer thread through a lock-free queue. If false,
+		                         they are written by the publishing thread while
+		                         holding a lock. The default value is true.
+		                         设为true则已发布的行会通过无锁队列交给后台写线程；
+		                         设为false则由发布线程在持有锁的情况下直接写出。
+		                         默认值是true。
+	*/
+	explicit ConcurrentConsoleStream(ConsoleSink *destinationSink = nullptr, bool takeOwnership = true,
+		bool useWriterThread = true)
+		: destination(destinationSink != nullptr ? destinationSink : new StandardOutputSink(),
+		              destinationSink != nullptr ? takeOwnership : true)
+	{
+		if (useWriterThread)
+			sharedSink = new ConsoleAsyncWriter(destination.get(), false);
+		else
+			sharedSink = new SynchronisedSink(destination.get(), false);
+	}
+
+	/** @brief Destructor. Publishes whatever is left in every thread's stream.
+	           析构函数。发布每个线程的输出流中剩余的所有数据。
+
+		Make sure no other thread is still writing when this is called.
+
+		调用时请确保没有其他线程仍在写入。
+	*/
+	~ConcurrentConsoleStream()
+	{
+		for (int i = 0; i < threadStreams.size(); ++i)
+			threadStreams.getUnchecked(i)->printData();
+
+		sharedSink->flush();
+	}
+
+	//==============================================================================
+	/** @brief Returns the calling thread's own stream.
+	           返回调用线程自己的输出流。
+
+		Write into this as you would into any ConsoleOutputStream, then call
+		"publish" or "flush" from the same thread.
+
+		像使用普通的 ConsoleOutputStream 一样向其写入数据，然后在同一线程中调用
+		"publish"或"flush"。
+	*/
+	ConsoleOutputStream& local()
+	{
+		ConsoleOutputStream *&stream = localStreams.get();
+
+		if (stream == nullptr)
+		{
+			stream = new ConsoleOutputStream();
+			stream->setSink(sharedSink.get(), false);
+			stream->setRecordMode(recordMode);
+
+			const juce::ScopedLock sl(threadStreamsLock);
+			threadStreams.add(stream);
+		}
+
+		return *stream;
+	}
+
+	/** @brief Writes a value into the calling thread's stream.
+	           向调用线程的输出流写入一个值。
+	*/
+	template <typename ValueType>
+	ConsoleOutputStream& operator<<(const ValueType &value)
+	{
+		return local() << value;
+	}
+
+	/** @brief Writes a line through a format into the calling thread's stream.
+	           通过一个格式向调用线程的输出流写出一行。
+
+		@see EZ_CONSOLE_LOG, ConsoleOutputStream::log
+	*/
+	template <typename... Args>
+	ConsoleOutputStream& log(const ConsoleLogFormat &format, const Args&... args)
+	{
+		return local().log(format, args...);
+	}
+
+	/** @brief Makes the threads' streams write binary records.
+	           使各线程的输出流写出二进制记录。
+
+		This applies to the streams that the threads create from then on, so
+		call it before any thread writes. Each thread's stream then starts a
+		log of its own in the shared sink, and as "publish" only hands over
+		whole records, ConsoleLogReader reads them all as one log.
+
+		该设置作用于此后各线程创建的输出流，因此请在任何线程写入之前调用它。之后每个
+		线程的输出流都会在共享的 Sink 中开始一个自己的日志，由于"publish"只交出完整的
+		记录，ConsoleLogReader 会将它们作为一个日志读取。
+
+		@see ConsoleOutputStream::setRecordMode
+	*/
+	void setRecordMode(bool shouldWriteRecords)
+	{
+		recordMode = shouldWriteRecords;
+	}
+
+	//==============================================================================
+	/** @brief Publishes every complete line in the calling thread's stream.
+	           发布调用线程的输出流中所有完整的行。
+
+		A line that has not been finished with a new line yet stays in the
+		thread's stream until a later call.
+
+		尚未以换行符结束的行会留在该线程的输出流中，直到之后的调用再将其发布。
+
+		@see ConsoleOutputStream::printCompleteLines
+	*/
+	int publish()
+	{
+		return local().printCompleteLines();
+	}
+
+	/** @brief Publishes everything in the calling thread's stream, and waits for it to be written.
+	           发布调用线程的输出流中的所有数据，并等待其写出。
+	*/
+	void flush()
+	{
+		local().flush();
+	}
+
+	/** @brief Returns the sink that all the threads publish to.
+	           返回所有线程发布数据的 Sink。
+	*/
+	ConsoleSink* getSharedSink() const
+	{
+		return sharedSink.get();
+	}
+
+private:
+	//==============================================================================
+	juce::OptionalScopedPointer<ConsoleSink> destination;
+	juce::ScopedPointer<ConsoleSink> sharedSink;
+
+	juce::ThreadLocalValue<ConsoleOutputStream*> localStreams;
+	juce::CriticalSection threadStreamsLock;
+	juce::OwnedArray<ConsoleOutputStream> threadStreams;
+
+	std::atomic<bool> recordMode { false };
+
+	JUCE_DECLARE_NON_COPYABLE(ConcurrentConsoleStream)
+};
@@ -0,0 +1,633 @@
+﻿#pragma once
+#define EZ_CONSOLEASYNCWRITER_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A sink that hands data over to a background thread for writing.
+	       将数据交给后台线程写出的 Sink。
+
+	Calling "write" copies the data into chunks taken from the ConsoleChunkPool,
+	pushes them onto a lock-free queue and returns at once. When a stream hands
+	over its own chunks through "consumeChunks", they are queued as they are,
+	without any copy. A dedicated writer thread pops the chunks, passes them to
+	the destination sink, which puts them back in the pool, so a slow terminal
+	or a full pipe never stalls the caller.
+
+	When the queue is full, the backpressure policy decides what happens: the
+	caller can wait for room, the data can be dropped (and counted), or the data
+	can go to an unbounded overflow list.
+
+	Any number of threads may call "write" at the same time. Each call is queued
+	as a whole, so the data of two calls is never mixed. Every call takes a
+	ticket before its data goes into the queue, and "flush" waits until all
+	the tickets handed out before it was called are written, so it never
+	returns before the data of the calling thread is out, whatever the other
+	threads are doing.
+
+	"consumeChunksAsync" and "flushAsync" never wait. With the blockWhenFull
+	policy, data that does not fit in the queue is set aside, in order, and
+	moved into the queue by the writer thread as room is made, so coroutines
+	and other callers that must not block still get backpressure without
+	losing anything.
+
+	The destructor writes everything that is still queued before returning.
+
+	调用"write"会把数据拷贝到从 ConsoleChunkPool 中取出的内存块里，将其压入一个
+	无锁队列后立即返回。当输出流通过"consumeChunks"交出自己的内存块时，这些内存块
+	会被原样加入队列，不做任何拷贝。专门的写线程会取出这些内存块并交给目标 Sink
+	写出，再由 Sink 将其放回缓冲池。因此缓慢的终端或已满的管道永远不会阻塞调用者。
+
+	当队列已满时，由背压策略决定如何处理：调用者可以等待队列腾出空间，数据可以被
+	丢弃（并计数），或者数据可以进入一个无上限的溢出列表。
+
+	任意数量的线程都可以同时调用"write"。每次调用的数据作为一个整体入队，因此两次
+	调用的数据永远不会混在一起。每次调用在数据入队之前都会领取一个序号，而"flush"
+	会等待在它被调用之前发出的所有序号都已写出，因此无论其他线程在做什么，它都不会
+	在调用线程的数据写出之前返回。
+
+	"consumeChunksAsync"和"flushAsync"永远不会等待。在blockWhenFull策略下，放不进
+	队列的数据会按顺序被暂存起来，由写线程在腾出空间后移入队列，因此协程等不能阻塞
+	的调用者同样能够受到背压的约束，并且不会丢失任何数据。
+
+	析构函数会在返回之前写出所有仍在队列中的数据。
+
+*/
+class ConsoleAsyncWriter : public ConsoleSink, private juce::Thread
+{
+public:
+	//==============================================================================
+	/** @brief What "write" does when the queue is full.
+	           队列已满时"write"的行为。
+	*/
+	enum BackpressurePolicy
+	{
+		blockWhenFull, /**< Wait until the writer thread has made room.
+		                    等待写线程腾出空间。 */
+		dropWhenFull,  /**< Throw the data away and count it as dropped.
+		                    丢弃数据并将其计入丢弃数。 */
+		growWhenFull   /**< Keep the data in an unbounded overflow list.
+		                    将数据保存在一个无上限的溢出列表中。 */
+	};
+
+	//==============================================================================
+	/** @brief Creates a writer and starts its thread.
+	           创建一个异步写出器并启动其线程。
+
+		@param destinationSink   The sink that the writer thread passes the data to.
+		                         写线程将数据交给的目标 Sink。
+
+		@param takeOwnership     If true, the destination sink will be deleted when
+		                         the writer is deleted.
+		                         设为true则在删除写出器时一并删除目标 Sink。
+
+		@param policy            What to do when the queue is full. The default value
+		                         is blockWhenFull.
+		                         队列已满时的处理方式。默认值是blockWhenFull。
+
+		@param maxQueuedBuffers  How many buffers may be waiting to be written before
+		                         the backpressure policy kicks in. The default value
+		                         is 64.
+		                         在触发背压策略之前，最多允许多少个缓冲区等待写出。
+		                         默认值是64。
+	*/
+	ConsoleAsyncWriter(ConsoleSink *destinationSink, bool takeOwnership,
+		BackpressurePolicy policy = blockWhenFull, int maxQueuedBuffers = 64)
+		: juce::Thread("ConsoleAsyncWriter"),
+		  destination(destinationSink, takeOwnership),
+		  backpressurePolicy(policy),
+		  pendingBuffers(maxQueuedBuffers)
+	{
+		jassert(destinationSink != nullptr);
+
+		startThread();
+	}
+
+	/** @brief Destructor. Writes out everything still queued, then stops the thread.
+	           析构函数。写出所有仍在队列中的数据，然后停止线程。
+	*/
+	~ConsoleAsyncWriter()
+	{
+		stopThread(-1);
+
+		drainQueue();
+	}
+
+	//==============================================================================
+	/** @brief Queues a copy of the data and returns without waiting for it to be written.
+	           将数据的拷贝加入队列，不等待其写出即返回。
+
+		@returns false if the data was dropped because of the dropWhenFull policy.
+		@returns 数据因dropWhenFull策略被丢弃时返回false。
+	*/
+	bool write(const void *data, size_t numBytes) override
+	{
+		if (numBytes == 0)
+			return true;
+
+		return enqueue(ConsoleChunkPool::getInstance().copyToChunks(data, numBytes));
+	}
+
+	/** @brief Queues a list of chunks as it is, without copying it.
+	           将一个内存块链表原样加入队列，不做拷贝。
+
+		@returns false if the data was dropped because of the dropWhenFull policy.
+		@returns 数据因dropWhenFull策略被丢弃时返回false。
+	*/
+	bool consumeChunks(ConsoleChunk *firstChunk) override
+	{
+		if (firstChunk == nullptr)
+			return true;
+
+		return enqueue(firstChunk);
+	}
+
+	/** @brief Queues a list of chunks that other readers share, without copying it.
+	           将一个与其他读取者共享的内存块链表加入队列，不做拷贝。
+
+		The chunks are passed to the destination's "writeChunks", which only
+		reads them, instead of being handed over. The owner gets an extra
+		reference until then and must keep the chunks alive as long as it is
+		referenced. This is how TeeSink gives one list of chunks to several
+		writers.
+
+		这些内存块会被传给目标 Sink 的"writeChunks"（它只读取这些内存块），而不是被
+		交出。在此之前，owner 会多持有一个引用，并且只要它还被引用，就必须保证这些
+		内存块有效。TeeSink 正是以这种方式把同一个内存块链表交给多个写出器的。
+
+		@returns false if the data was dropped because of the dropWhenFull policy.
+		@returns 数据因dropWhenFull策略被丢弃时返回false。
+	*/
+	bool writeSharedChunks(ConsoleChunk *firstChunk, juce::ReferenceCountedObject *owner)
+	{
+		jassert(owner != nullptr);
+
+		if (firstChunk == nullptr)
+			return true;
+
+		owner->incReferenceCount();
+		return enqueue(firstChunk, owner);
+	}
+
+	/** @brief Blocks until everything queued so far has been written and flushed.
+	           阻塞直到此前入队的所有数据都已写出并刷新。
+
+		This must not be called on the writer thread, such as from a callback or
+		a coroutine resumed there, as it would wait for itself forever. It
+		asserts and returns false instead.
+
+		不能在写线程上调用该方法（例如在回调函数中，或在写线程上恢复的协程中），否则
+		它会永远等待自己。此时它会触发断言并返回false。
+	*/
+	bool flush() override
+	{
+		if (isWriterThread())
+		{
+			jassertfalse;
+			return false;
+		}
+
+		const juce::int64 target = numEnqueued.load();
+
+		if (numFlushed.load() < target)
+		{
+			notify();
+
+			std::unique_lock<std::mutex> lock(ticketLock);
+			flushedCondition.wait(lock, [this, target] { return numFlushed.load() >= target; });
+		}
+
+		return true;
+	}
+
+	/** @brief Queues a list of chunks without waiting for room in the queue.
+	           将一个内存块链表加入队列，不等待队列腾出空间。
+
+		With the blockWhenFull policy, chunks that do not fit are set aside and
+		asyncPending is returned; the callback is called on the writer thread
+		once they are in the queue. Nothing queued afterwards is written before
+		them. With the other policies this is the same as "consumeChunks".
+
+		在blockWhenFull策略下，放不进队列的内存块会被暂存起来，并返回asyncPending；
+		它们进入队列之后，回调函数会在写线程上被调用。之后入队的任何数据都不会在它们
+		之前写出。在其他策略下，该方法与"consumeChunks"相同。
+	*/
+	AsyncResult consumeChunksAsync(ConsoleChunk *firstChunk, AsyncCallback whenConsumed) override
+	{
+		if (firstChunk == nullptr)
+			return asyncDone;
+
+		if (backpressurePolicy != blockWhenFull)
+			return enqueue(firstChunk) ? asyncDone : asyncFailed;
+
+		bool isDeferred = false;
+
+		{
+			const juce::ScopedLock sl(callbackLock);
+			const QueuedWrite queued { firstChunk, nullptr, ++numEnqueued };
+
+			if (hasDeferredWrites.load() || !pendingBuffers.push(queued))
+			{
+				deferredWrites.add({ queued, std::move(whenConsumed) });
+				hasDeferredWrites = true;
+				isDeferred = true;
+			}
+		}
+
+		notify();
+		return isDeferred ? asyncPending : asyncDone;
+	}
+
+	/** @brief Calls a function on the writer thread once everything queued so far
+	           has been written and flushed.
+	           在此前入队的所有数据都已写出并刷新之后，在写线程上调用一个函数。
+
+		@returns asyncDone if there was nothing left to write, in which case the
+		         callback is not called, or asyncPending.
+		@returns 如果没有需要写出的数据，返回asyncDone（此时不会调用回调函数），否则
+		         返回asyncPending。
+	*/
+	AsyncResult flushAsync(AsyncCallback whenFlushed) override
+	{
+		const juce::int64 target = numEnqueued.load();
+
+		{
+			const juce::ScopedLock sl(callbackLock);
+
+			if (numFlushed.load() >= target)
+				return asyncDone;
+
+			pendingFlushes.add({ target, std::move(whenFlushed) });
+		}
+
+		notify();
+		return asyncPending;
+	}
+
+	bool isInteractive() const override
+	{
+		return destination->isInteractive();
+	}
+
+	bool getNativeHandle(NativeHandle &handle) const override
+	{
+		return destination->getNativeHandle(handle);
+	}
+
+	//==============================================================================
+	/** @brief Returns true if called on the writer thread, where the callbacks run.
+	           如果在写线程（回调函数运行的线程）上调用，返回true。
+	*/
+	bool isWriterThread() const
+	{
+		return juce::Thread::getCurrentThreadId() == getThreadId();
+	}
+
+	/** @brief Returns the backpressure policy given in the constructor.
+	           返回构造函数中指定的背压策略。
+	*/
+	BackpressurePolicy getBackpressurePolicy() const
+	{
+		return backpressurePolicy;
+	}
+
+	/** @brief Returns the queue size given in the constructor, rounded up to a power of two.
+	           返回构造函数中指定的队列大小（向上取整为2的幂）。
+	*/
+	int getMaxQueuedBuffers() const
+	{
+		return pendingBuffers.getCapacity();
+	}
+
+	/** @brief Returns how many writes were dropped by the dropWhenFull policy.
+	           返回被dropWhenFull策略丢弃的写入次数。
+	*/
+	juce::int64 getNumDroppedWrites() const
+	{
+		return numDroppedWrites.load();
+	}
+
+	/** @brief Returns how many bytes were dropped by the dropWhenFull policy.
+	           返回被dropWhenFull策略丢弃的字节数。
+	*/
+	juce::int64 getNumDroppedBytes() const
+	{
+		return numDroppedBytes.load();
+	}
+
+private:
+	//==============================================================================
+	struct QueuedWrite
+	{
+		ConsoleChunk *chunks;
+		juce::ReferenceCountedObject *owner; // set if the chunks are shared
+		juce::int64 ticket;
+	};
+
+	// A write belongs to the ticket it takes here, before it can be seen by
+	// the writer thread, so that a flush started afterwards always waits for it.
+	bool enqueue(ConsoleChunk *chunks, juce::ReferenceCountedObject *owner = nullptr)
+	{
+		const QueuedWrite queued { chunks, owner, ++numEnqueued };
+
+		if (backpressurePolicy == growWhenFull)
+		{
+			if (hasOverflow.load() || !pendingBuffers.push(queued))
+			{
+				const juce::ScopedLock sl(overflowLock);
+				overflowBuffers.add(queued);
+				hasOverflow = true;
+			}
+		}
+		else
+		{
+			for (;;)
+			{
+				const juce::int64 spaceSeen = numSpaceSignals.load();
+
+				if (!hasDeferredWrites.load() && pendingBuffers.push(queued))
+					break;
+
+				// The writer thread cannot wait for itself to make room, so what
+				// it queues while the queue is full is dropped.
+				if (backpressurePolicy == dropWhenFull || isWriterThread())
+				{
+					jassert(backpressurePolicy == dropWhenFull);
+
+					++numDroppedWrites;
+					numDroppedBytes += (juce::int64)ConsoleChunk::getTotalSize(chunks);
+					release(queued);
+
+					// Marked as written, or the flushes waiting for the ticket
+					// would never return.
+					markWritten(queued.ticket);
+
+					if (writerIsIdle.load())
+						notify();
+
+					return false;
+				}
+
+				++numWaitingProducers;
+				notify();
+
+				{
+					std::unique_lock<std::mutex> lock(spaceLock);
+					spaceAvailableCondition.wait(lock, [this, spaceSeen] { return numSpaceSignals.load() != spaceSeen; });
+				}
+
+				--numWaitingProducers;
+			}
+		}
+
+		if (writerIsIdle.load())
+			notify();
+
+		return true;
+	}
+
+	//==============================================================================
+	void run() override
+	{
+		for (;;)
+		{
+			const bool exitRequested = threadShouldExit();
+
+			drainQueue();
+
+			if (exitRequested)
+				break;
+
+			writerIsIdle = true;
+
+			if (pendingBuffers.isEmpty() && !hasOverflow.load() && !hasDeferredWrites.load()
+			     && numWritten.load() <= numFlushed.load() && !threadShouldExit())
+				wait(-1);
+
+			writerIsIdle = false;
+		}
+	}
+
+	void drainQueue()
+	{
+		bool wroteAnything = false;
+
+		for (;;)
+		{
+			QueuedWrite queued;
+
+			if (pendingBuffers.pop(queued))
+			{
+				writeQueuedChunks(queued);
+			}
+			else if (hasOverflow.load())
+			{
+				juce::Array<QueuedWrite> batch;
+
+				{
+					const juce::ScopedLock sl(overflowLock);
+					batch.swapWith(overflowBuffers);
+					hasOverflow = false;
+				}
+
+				for (int i = 0; i < batch.size(); ++i)
+					writeQueuedChunks(batch.getUnchecked(i));
+			}
+			else if (hasDeferredWrites.load())
+			{
+				admitDeferredWrites();
+				continue;
+			}
+			else
+			{
+				break;
+			}
+
+			wroteAnything = true;
+		}
+
+		const juce::int64 written = numWritten.load();
+
+		if (wroteAnything)
+			destination->flush();
+
+		if (written > numFlushed.load())
+		{
+			{
+				const std::lock_guard<std::mutex> sl(ticketLock);
+				numFlushed = written;
+			}
+
+			flushedCondition.notify_all();
+			completeFlushes();
+		}
+	}
+
+	void writeQueuedChunks(const QueuedWrite &queued)
+	{
+		if (queued.owner != nullptr)
+		{
+			destination->writeChunks(queued.chunks);
+			queued.owner->decReferenceCount();
+		}
+		else
+		{
+			destination->consumeChunks(queued.chunks);
+		}
+
+		markWritten(queued.ticket);
+
+		if (hasDeferredWrites.load())
+			admitDeferredWrites();
+
+		signalSpaceAvailable();
+	}
+
+	static void release(const QueuedWrite &queued)
+	{
+		if (queued.owner != nullptr)
+			queued.owner->decReferenceCount();
+		else
+			ConsoleChunkPool::getInstance().releaseList(queued.chunks);
+	}
+
+	// Tickets can be written out of order, when a producer is overtaken between
+	// taking its ticket and pushing, or when the overflow list is involved, so
+	// numWritten only moves up to the lowest ticket not yet written.
+	void markWritten(juce::int64 ticket)
+	{
+		const std::lock_guard<std::mutex> sl(ticketLock);
+		juce::int64 written = numWritten.load();
+
+		if (ticket != written + 1)
+		{
+			ticketsWrittenAhead.add(ticket);
+			return;
+		}
+
+		for (++written; ticketsWrittenAhead.size() > 0 && ticketsWrittenAhead.getFirst() == written + 1; ++written)
+			ticketsWrittenAhead.remove(0);
+
+		numWritten = written;
+	}
+
+	void signalSpaceAvailable()
+	{
+		++numSpaceSignals;
+
+		if (numWaitingProducers.load() > 0)
+		{
+			{
+				const std::lock_guard<std::mutex> sl(spaceLock);
+			}
+
+			spaceAvailableCondition.notify_all();
+		}
+	}
+
+	// Writes set aside by consumeChunksAsync go into the queue in order, as
+	// room is made, before any blocking write can take the room.
+	void admitDeferredWrites()
+	{
+		juce::Array<AsyncCallback> callbacks;
+
+		{
+			const juce::ScopedLock sl(callbackLock);
+			int numAdmitted = 0;
+
+			for (; numAdmitted < deferredWrites.size(); ++numAdmitted)
+			{
+				const DeferredWrite &deferred = deferredWrites.getReference(numAdmitted);
+
+				if (!pendingBuffers.push(deferred.queued))
+					break;
+
+				callbacks.add(deferred.callback);
+			}
+
+			deferredWrites.removeRange(0, numAdmitted);
+			hasDeferredWrites = !deferredWrites.isEmpty();
+		}
+
+		if (!hasDeferredWrites.load())
+			signalSpaceAvailable();
+
+		callAll(callbacks);
+	}
+
+	void completeFlushes()
+	{
+		juce::Array<AsyncCallback> callbacks;
+
+		{
+			const juce::ScopedLock sl(callbackLock);
+			const juce::int64 flushed = numFlushed.load();
+
+			for (int i = 0; i < pendingFlushes.size();)
+			{
+				if (pendingFlushes.getReference(i).target <= flushed)
+				{
+					callbacks.add(pendingFlushes.getReference(i).callback);
+					pendingFlushes.remove(i);
+				}
+				else
+				{
+					++i;
+				}
+			}
+		}
+
+		callAll(callbacks);
+	}
+
+	static void callAll(const juce::Array<AsyncCallback> &callbacks)
+	{
+		for (int i = 0; i < callbacks.size(); ++i)
+			if (callbacks.getReference(i) != nullptr)
+				callbacks.getReference(i)(true);
+	}
+
+	//==============================================================================
+	juce::OptionalScopedPointer<ConsoleSink> destination;
+	const BackpressurePolicy backpressurePolicy;
+
+	LockFreeQueue<QueuedWrite> pendingBuffers;
+
+	juce::CriticalSection overflowLock;
+	juce::Array<QueuedWrite> overflowBuffers;
+	std::atomic<bool> hasOverflow { false };
+
+	struct DeferredWrite
+	{
+		QueuedWrite queued;
+		AsyncCallback callback;
+	};
+
+	struct PendingFlush
+	{
+		juce::int64 target;
+		AsyncCallback callback;
+	};
+
+	juce::CriticalSection callbackLock;
+	juce::Array<DeferredWrite> deferredWrites;
+	juce::Array<PendingFlush> pendingFlushes;
+	std::atomic<bool> hasDeferredWrites { false };
+
+	std::atomic<bool> writerIsIdle { false };
+	std::atomic<int> numWaitingProducers { 0 };
+	std::atomic<juce::int64> numSpaceSignals { 0 };
+	std::mutex spaceLock;
+	std::condition_variable spaceAvailableCondition;
+
+	// numEnqueued is the last ticket handed out, numWritten the highest ticket
+	// up to which every ticket is written or dropped, and numFlushed the same
+	// once the destination has been flushed.
+	std::mutex ticketLock;
+	std::condition_variable flushedCondition;
+	juce::SortedSet<juce::int64> ticketsWrittenAhead;
+	std::atomic<juce::int64> numEnqueued { 0 }, numWritten { 0 }, numFlushed { 0 };
+	std::atomic<juce::int64> numDroppedWrites { 0 }, numDroppedBytes { 0 };
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleAsyncWriter)
+};
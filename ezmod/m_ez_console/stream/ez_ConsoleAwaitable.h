@@ -0,0 +1,139 @@
+﻿#pragma once
+#define EZ_CONSOLEAWAITABLE_H_INCLUDED
+
+/** Awaitable output needs the coroutine support of C++20, so it is only
+	available when compiling as C++20 or later with a standard library that
+	has the <coroutine> header.
+
+	可等待的输出需要C++20的协程支持，因此只有在以C++20或更高标准编译，并且标准库
+	提供<coroutine>头文件时才可用。
+*/
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && defined(__has_include)
+ #if __has_include(<coroutine>)
+  #define EZ_CONSOLE_HAS_COROUTINES 1
+  #include <coroutine>
+ #endif
+#endif
+
+#ifndef EZ_CONSOLE_HAS_COROUTINES
+ #define EZ_CONSOLE_HAS_COROUTINES 0
+#endif
+
+#if EZ_CONSOLE_HAS_COROUTINES
+
+//==============================================================================
+/**
+
+    @brief An output operation that a coroutine can "co_await" (C++20 only).
+	       协程可以"co_await"的输出操作（仅限C++20）。
+
+	The operation starts when it is awaited. If the sink finishes it at once,
+	the coroutine goes on without being suspended. Otherwise the coroutine is
+	suspended, and resumed once the sink calls back, so the thread it was
+	running on is free for other work in the meantime. The result of
+	"co_await" is true on success.
+
+	The sink calls back from its own thread, such as the writer thread of
+	ConsoleAsyncWriter. To get back to the executor the coroutine belongs to,
+	pass a resumer that posts the handle there. Without one, the coroutine is
+	resumed straight on the sink's thread, which is only fine for a few quick
+	steps: while it runs there, nothing else gets written, and a blocking
+	"printData" or "flush" would wait for itself. That is why the awaitables
+	of ConsoleOutputStream always need a resumer.
+
+	该操作在被等待时才开始。如果 Sink 立即完成了它，协程会继续执行而不被挂起。
+	否则协程会被挂起，并在 Sink 回调时恢复，因此在此期间协程原来所在的线程可以
+	去做其他工作。"co_await"的结果在成功时为true。
+
+	Sink 会在它自己的线程（例如 ConsoleAsyncWriter 的写线程）中进行回调。要回到
+	协程所属的执行器，请传入一个将句柄投递到该执行器的恢复函数。如果不传入，协程
+	会直接在 Sink 的线程上恢复，这只适合执行少量快速的步骤：协程在那里运行期间，
+	不会写出任何其他数据，并且阻塞的"printData"或"flush"会等待自己。这就是
+	ConsoleOutputStream 的可等待对象总是需要恢复函数的原因。
+
+	@code
+	auto resumeOnPool = [&pool] (std::coroutine_handle<> handle) { asio::post(pool, handle); };
+
+	ezout << "processed " << numItems << " items\n";
+	co_await ezout.flushAwaitable(resumeOnPool);
+	@endcode
+
+	@see ConsoleOutputStream::flushAwaitable, ConsoleSink::consumeChunksAsync
+*/
+class ConsoleAwaitable
+{
+public:
+	/** @brief Resumes a suspended coroutine, usually by posting it to an executor.
+	           恢复一个被挂起的协程，通常是将其投递到某个执行器。
+	*/
+	typedef std::function<void (std::coroutine_handle<> handle)> Resumer;
+
+	/** @brief Starts the operation, as ConsoleSink::consumeChunksAsync does.
+	           开始该操作，与 ConsoleSink::consumeChunksAsync 的做法相同。
+	*/
+	typedef std::function<ConsoleSink::AsyncResult (ConsoleSink::AsyncCallback)> Operation;
+
+	//==============================================================================
+	/** @brief Creates an awaitable for an operation.
+	           为一个操作创建可等待对象。
+
+		@param operationToStart  Called when the awaitable is awaited.
+		                         在可等待对象被等待时调用。
+
+		@param resumerToUse      Resumes the coroutine when the operation finishes
+		                         later, or nullptr to resume it on the calling thread.
+		                         操作稍后完成时用于恢复协程，设为nullptr则在回调的
+		                         线程上恢复。
+	*/
+	ConsoleAwaitable(Operation operationToStart, Resumer resumerToUse)
+		: operation(std::move(operationToStart)), resumer(std::move(resumerToUse))
+	{
+		jassert(operation != nullptr);
+	}
+
+	//==============================================================================
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	// Once the callback has been handed over, the sink may resume the coroutine
+	// on another thread at any time, and with it destroy this object, even
+	// before the operation returns. So the operation is moved out and called
+	// from here, and nothing in this object is touched unless it did not pend.
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		ConsoleAwaitable *awaitable = this;
+		const Operation operationToCall = std::move(operation);
+
+		const ConsoleSink::AsyncResult result = operationToCall(
+			[awaitable, handle, resume = resumer] (bool operationSucceeded)
+			{
+				awaitable->succeeded = operationSucceeded;
+
+				if (resume != nullptr)
+					resume(handle);
+				else
+					handle.resume();
+			});
+
+		if (result == ConsoleSink::asyncPending)
+			return true;
+
+		succeeded = result == ConsoleSink::asyncDone;
+		return false;
+	}
+
+	bool await_resume() const noexcept
+	{
+		return succeeded;
+	}
+
+private:
+	//==============================================================================
+	Operation operation;
+	Resumer resumer;
+	bool succeeded = false;
+};
+
+#endif
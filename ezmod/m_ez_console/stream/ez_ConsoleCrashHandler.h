@@ -0,0 +1,394 @@
+﻿#pragma once
+#define EZ_CONSOLECRASHHANDLER_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Writes out what the streams still hold when the process crashes.
+	       在进程崩溃时写出输出流中仍保留的数据。
+
+	Streams that ask for it with ConsoleOutputStream::setFlushOnCrash are kept
+	in a fixed table, with the file descriptor (the HANDLE in Windows) of
+	their sink, which is asked for when the stream is added and again when
+	its sink changes. "flushAll" goes through the table and writes the buffer
+	of each stream straight to that descriptor, using only calls that are
+	safe in a signal handler: no lock is taken, nothing is allocated, and the
+	sink itself is never called, so a sink that is being changed or deleted
+	by another thread does no harm.
+
+	A thread may be in the middle of writing to a stream when another one
+	crashes, or the crashing thread may be that writer. Each piece of a buffer
+	is copied with ConsoleChunkBuffer::copyWhileChanging, which notices when
+	the buffer changes under it, and then written. A stream that keeps
+	changing is given up on after a short while rather than waited for, so
+	the handler can never deadlock. Data written during that time may be
+	printed twice, or not at all.
+
+	"installSignalHandlers" calls "flushAll" on SIGSEGV, SIGABRT, SIGBUS,
+	SIGFPE and SIGILL (in Windows, on unhandled exceptions and SIGABRT), then
+	hands the signal to whatever handled it before, so crash reporters and
+	core dumps still work. A previous handler is called directly, with the
+	siginfo and context of the crash. In other OS than Windows, the handler runs on an
+	alternate signal stack, so that a crash caused by a stack overflow is
+	handled too. That stack is set up for the thread that installs the
+	handlers; other threads can call "installAlternateStack" to get their
+	own. Programs that have their own crash handler can call "flushAll" from
+	it instead.
+
+	Data that was already handed to a ConsoleAsyncWriter, and sinks that have
+	no file descriptor, such as MappedFileSink, are not covered.
+
+	通过 ConsoleOutputStream::setFlushOnCrash 提出请求的输出流被保存在一个固定大小
+	的表中，同时保存其 Sink 的文件描述符（在Windows系统中为 HANDLE），该描述符在
+	输出流被加入时获取，并在其 Sink 改变时重新获取。"flushAll"遍历该表，将每个输出流
+	的缓冲区直接写入该描述符，只使用在信号处理函数中安全的调用：不加锁，不分配内存，
+	也从不调用 Sink 本身，因此另一个线程正在更换或删除的 Sink 不会造成危害。
+
+	在另一个线程崩溃时，某个线程可能正在写入输出流，甚至崩溃的线程本身就是写入者。
+	缓冲区的每一段都通过 ConsoleChunkBuffer::copyWhileChanging 拷贝（它能发现缓冲区
+	在拷贝过程中被修改），然后再写出。对于一直在变化的输出流，处理函数会在短时间后
+	放弃而不是等待，因此永远不会死锁。在此期间写入的数据可能会被输出两次，也可能
+	完全不被输出。
+
+	"installSignalHandlers"会在 SIGSEGV、SIGABRT、SIGBUS、SIGFPE 和 SIGILL（在Windows
+	系统中为未处理的异常和 SIGABRT）发生时调用"flushAll"，然后将信号交给之前的处理者，
+	因此崩溃报告工具和核心转储仍然有效。之前的处理函数会被直接调用，并传入崩溃时的
+	siginfo 和上下文。在Windows以外的系统中，处理函数运行在备用
+	信号栈上，因此由栈溢出引起的崩溃也能被处理。该栈是为安装处理函数的线程设置的，
+	其他线程可以调用"installAlternateStack"获得各自的备用栈。拥有自己的崩溃处理
+	函数的程序也可以在其中调用"flushAll"。
+
+	已经交给 ConsoleAsyncWriter 的数据，以及没有文件描述符的 Sink（例如
+	MappedFileSink）不在处理范围之内。
+
+	@see ConsoleOutputStream::setFlushOnCrash
+*/
+class ConsoleCrashHandler
+{
+public:
+	//==============================================================================
+	enum
+	{
+		maxNumStreams = 64  /**< The size of the table. 表的大小。 */
+	};
+
+	//==============================================================================
+	/** @brief Writes out the buffers of all the streams in the table.
+	           写出表中所有输出流的缓冲区。
+
+		This is safe to call from a signal handler. If it is already running
+		in another thread, it returns at once.
+
+		可以在信号处理函数中安全地调用。如果它已在另一个线程中运行，则立即返回。
+	*/
+	static void flushAll()
+	{
+		static std::atomic_flag isFlushing = ATOMIC_FLAG_INIT;
+		static char block[ConsoleChunk::capacity];
+
+		if (isFlushing.test_and_set(std::memory_order_acquire))
+			return;
+
+		Entry *entries = getEntries();
+
+		for (int i = 0; i < maxNumStreams; ++i)
+		{
+			const ConsoleChunkBuffer *buffer = entries[i].buffer.load(std::memory_order_acquire);
+
+			if (buffer != nullptr && entries[i].hasHandle.load(std::memory_order_acquire))
+				writeBuffer(*buffer, entries[i].handle.load(std::memory_order_relaxed), block, sizeof(block));
+		}
+
+		isFlushing.clear(std::memory_order_release);
+	}
+
+	/** @brief Makes the crash signals call "flushAll" first.
+	           使崩溃信号先调用"flushAll"。
+
+		Only the first call does anything.
+
+		只有第一次调用才有效。
+	*/
+	static void installSignalHandlers()
+	{
+		static const bool installed = [] ()
+		{
+#ifdef JUCE_WINDOWS
+			getPreviousFilter() = SetUnhandledExceptionFilter(handleException);
+			signal(SIGABRT, handleSignal);
+#else
+			installAlternateStack();
+
+			struct sigaction action;
+			memset(&action, 0, sizeof(action));
+			action.sa_sigaction = handleSignal;
+			action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+			sigemptyset(&action.sa_mask);
+
+			for (int i = 0; i < numCrashSignals; ++i)
+				sigaction(getCrashSignals()[i], &action, &getPreviousActions()[i]);
+#endif
+			return true;
+		}();
+
+		juce::ignoreUnused(installed);
+	}
+
+	/** @brief Gives the calling thread an alternate signal stack, so that a stack
+	           overflow in it can still be handled (non-Windows only method).
+	           为调用线程设置备用信号栈，使其中发生的栈溢出仍然能够被处理。（该方法
+	           只在非Windows环境下有效）
+
+		The stack is freed when the thread ends. Calling this again from the same
+		thread does nothing.
+
+		该栈在线程结束时被释放。在同一线程中再次调用不会有任何效果。
+
+		@returns false if the stack could not be set up.
+		@returns 无法设置该栈时返回false。
+	*/
+	static bool installAlternateStack()
+	{
+#ifdef JUCE_WINDOWS
+		return false;
+#else
+		static thread_local AlternateStack alternateStack;
+		return alternateStack.isInstalled;
+#endif
+	}
+
+	//==============================================================================
+	/** @brief Adds a buffer to the table, or changes its sink if it is there already.
+	           将一个缓冲区加入表中，如果已在表中则更改其 Sink。
+
+		The sink is asked for its native handle here, and never again. A sink
+		that has none, or nullptr, leaves the buffer in the table without being
+		written on a crash.
+
+		Sink 的原生句柄在这里获取，之后不再询问。没有原生句柄的 Sink（或nullptr）会使
+		该缓冲区留在表中，但在崩溃时不会被写出。
+
+		@returns false if the table is full.
+		@returns 表已满时返回false。
+	*/
+	static bool add(const ConsoleChunkBuffer &buffer, const ConsoleSink *sink)
+	{
+		Entry *entries = getEntries();
+
+		for (int i = 0; i < maxNumStreams; ++i)
+		{
+			if (entries[i].buffer.load(std::memory_order_acquire) == &buffer)
+			{
+				setHandle(entries[i], sink);
+				return true;
+			}
+		}
+
+		for (int i = 0; i < maxNumStreams; ++i)
+		{
+			const ConsoleChunkBuffer *expected = nullptr;
+
+			if (entries[i].buffer.compare_exchange_strong(expected, &buffer, std::memory_order_acq_rel))
+			{
+				setHandle(entries[i], sink);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/** @brief Removes a buffer from the table.
+	           将一个缓冲区从表中移除。
+	*/
+	static void remove(const ConsoleChunkBuffer &buffer)
+	{
+		Entry *entries = getEntries();
+
+		for (int i = 0; i < maxNumStreams; ++i)
+		{
+			const ConsoleChunkBuffer *expected = &buffer;
+
+			if (entries[i].buffer.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+				entries[i].hasHandle.store(false, std::memory_order_release);
+		}
+	}
+
+private:
+	//==============================================================================
+	enum
+	{
+		maxAttempts = 10000,
+		numCrashSignals = 5,
+		alternateStackSize = 64 * 1024
+	};
+
+	struct Entry
+	{
+		std::atomic<const ConsoleChunkBuffer*> buffer;
+		std::atomic<ConsoleSink::NativeHandle> handle;
+		std::atomic<bool> hasHandle;
+	};
+
+	// The handle is stored before the flag that makes it visible, and the flag
+	// is cleared first while it changes.
+	static void setHandle(Entry &entry, const ConsoleSink *sink)
+	{
+		ConsoleSink::NativeHandle handle;
+		const bool hasHandle = sink != nullptr && sink->getNativeHandle(handle);
+
+		entry.hasHandle.store(false, std::memory_order_release);
+
+		if (hasHandle)
+		{
+			entry.handle.store(handle, std::memory_order_relaxed);
+			entry.hasHandle.store(true, std::memory_order_release);
+		}
+	}
+
+	// Statics without constructors are zeroed before the program starts, so
+	// the handler never runs a function-local static initialiser.
+	static Entry* getEntries()
+	{
+		static Entry entries[maxNumStreams];
+		return entries;
+	}
+
+	static void writeBuffer(const ConsoleChunkBuffer &buffer, ConsoleSink::NativeHandle handle, char *block, size_t blockSize)
+	{
+		size_t offset = 0, numCopied;
+		int numAttemptsLeft = maxAttempts;
+
+		for (;;)
+		{
+			if (!buffer.copyWhileChanging(offset, block, blockSize, numCopied))
+			{
+				if (--numAttemptsLeft <= 0)
+					return;
+
+				continue;
+			}
+
+			if (numCopied == 0 || !writeToHandle(handle, block, numCopied))
+				return;
+
+			offset += numCopied;
+		}
+	}
+
+	static bool writeToHandle(ConsoleSink::NativeHandle handle, const char *data, size_t numBytes)
+	{
+#ifdef JUCE_WINDOWS
+		return StandardOutputSink::writeToFileHandle(handle, data, numBytes);
+#else
+		return StandardOutputSink::writeToFileDescriptor(handle, data, numBytes);
+#endif
+	}
+
+#ifdef JUCE_WINDOWS
+	static LPTOP_LEVEL_EXCEPTION_FILTER& getPreviousFilter()
+	{
+		static LPTOP_LEVEL_EXCEPTION_FILTER previousFilter;
+		return previousFilter;
+	}
+
+	static LONG WINAPI handleException(EXCEPTION_POINTERS *info)
+	{
+		flushAll();
+
+		LPTOP_LEVEL_EXCEPTION_FILTER previousFilter = getPreviousFilter();
+		return previousFilter != nullptr ? previousFilter(info) : EXCEPTION_CONTINUE_SEARCH;
+	}
+
+	static void handleSignal(int signalNumber)
+	{
+		flushAll();
+
+		signal(signalNumber, SIG_DFL);
+		raise(signalNumber);
+	}
+#else
+	static const int* getCrashSignals()
+	{
+		static const int crashSignals[numCrashSignals] = { SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL };
+		return crashSignals;
+	}
+
+	static struct sigaction* getPreviousActions()
+	{
+		static struct sigaction previousActions[numCrashSignals];
+		return previousActions;
+	}
+
+	struct AlternateStack
+	{
+		AlternateStack()
+		{
+			stack_t stack;
+			memset(&stack, 0, sizeof(stack));
+			stack.ss_sp = memory;
+			stack.ss_size = alternateStackSize;
+
+			isInstalled = sigaltstack(&stack, nullptr) == 0;
+		}
+
+		~AlternateStack()
+		{
+			if (!isInstalled)
+				return;
+
+			stack_t stack;
+			memset(&stack, 0, sizeof(stack));
+			stack.ss_flags = SS_DISABLE;
+			sigaltstack(&stack, nullptr);
+		}
+
+		juce::HeapBlock<char> memory { (size_t)alternateStackSize };
+		bool isInstalled = false;
+	};
+
+	// A previous handler is called directly, so that it gets the siginfo and
+	// context of the crash rather than those of a raise. Otherwise the previous
+	// action is put back and the signal raised again: it is blocked while this
+	// runs, so it is delivered to that action once this returns.
+	static void handleSignal(int signalNumber, siginfo_t *info, void *context)
+	{
+		flushAll();
+
+		for (int i = 0; i < numCrashSignals; ++i)
+		{
+			if (getCrashSignals()[i] != signalNumber)
+				continue;
+
+			const struct sigaction &previous = getPreviousActions()[i];
+			const bool hasSigInfo = (previous.sa_flags & SA_SIGINFO) != 0;
+
+			if (hasSigInfo ? previous.sa_sigaction != nullptr
+			               : (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN))
+			{
+				// The kernel would have reset a one-shot handler before calling it.
+				if ((previous.sa_flags & SA_RESETHAND) != 0)
+				{
+					struct sigaction defaultAction;
+					memset(&defaultAction, 0, sizeof(defaultAction));
+					defaultAction.sa_handler = SIG_DFL;
+					sigemptyset(&defaultAction.sa_mask);
+					sigaction(signalNumber, &defaultAction, nullptr);
+				}
+
+				if (hasSigInfo)
+					previous.sa_sigaction(signalNumber, info, context);
+				else
+					previous.sa_handler(signalNumber);
+
+				return;
+			}
+
+			sigaction(signalNumber, &previous, nullptr);
+			break;
+		}
+
+		raise(signalNumber);
+	}
+#endif
+};
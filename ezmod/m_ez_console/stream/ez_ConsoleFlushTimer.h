@@ -0,0 +1,163 @@
+﻿#pragma once
+#define EZ_CONSOLEFLUSHTIMER_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief A shared background thread that flushes streams whose data has waited too long.
+	       一个共享的后台线程，负责刷新数据等待过久的输出流。
+
+	Streams that have a maximum latency register themselves as clients. The
+	thread wakes up at half the shortest latency of its clients and asks each of
+	them to print its data if it has been waiting longer than allowed.
+
+	The clients are called one at a time, without holding the lock that guards
+	the list, so a slow sink only delays the other clients of the timer, and
+	never a stream that is being added or removed.
+
+	Use it through a juce::SharedResourcePointer, so the thread only exists while
+	at least one stream needs it.
+
+	设置了最大延迟的输出流会将自己注册为客户端。该线程以所有客户端中最短延迟的
+	一半为间隔醒来，并要求每个客户端在其数据等待时间超过允许值时将其输出。
+
+	客户端会被逐个调用，调用时不持有保护客户端列表的锁，因此缓慢的 Sink 只会推迟
+	该计时器的其他客户端，而永远不会阻塞正在添加或移除的输出流。
+
+	请通过 juce::SharedResourcePointer 使用该类，这样只有在至少有一个输出流需要时
+	该线程才会存在。
+
+	@see ConsoleOutputStream::setMaxLatency
+*/
+class ConsoleFlushTimer : private juce::Thread
+{
+public:
+	//==============================================================================
+	/** @brief Something that the timer can flush.
+	           可被计时器刷新的对象。
+	*/
+	class Client
+	{
+	public:
+		virtual ~Client() {}
+
+		/** @brief Returns the longest time, in milliseconds, that data may wait.
+		           返回数据最多可以等待的时间（毫秒）。
+		*/
+		virtual int getMaxLatency() const = 0;
+
+		/** @brief Called on the timer thread. Should print the data if it has waited too long.
+		           在计时器线程中调用。数据等待过久时应将其输出。
+
+			@param now  The current value of juce::Time::getMillisecondCounter().
+			            juce::Time::getMillisecondCounter()的当前值。
+		*/
+		virtual void flushIfOverdue(juce::uint32 now) = 0;
+	};
+
+	//==============================================================================
+	/** @brief Creates the timer and starts its thread.
+	           创建计时器并启动其线程。
+	*/
+	ConsoleFlushTimer()
+		: juce::Thread("ConsoleFlushTimer")
+	{
+		startThread();
+	}
+
+	/** @brief Destructor.
+	           析构函数。
+	*/
+	~ConsoleFlushTimer()
+	{
+		stopThread(-1);
+	}
+
+	//==============================================================================
+	/** @brief Starts checking a client.
+	           开始检查一个客户端。
+	*/
+	void addClient(Client *client)
+	{
+		const std::lock_guard<std::mutex> sl(lock);
+
+		if (!clients.contains(client))
+			clients.add(client);
+
+		notify();
+	}
+
+	/** @brief Stops checking a client. Once this returns, the client will not be called again.
+	           停止检查一个客户端。该方法返回后，该客户端不会再被调用。
+
+		If the timer thread is calling the client at that moment, this waits
+		for the call to return.
+
+		如果计时器线程此时正在调用该客户端，该方法会等待调用返回。
+	*/
+	void removeClient(Client *client)
+	{
+		std::unique_lock<std::mutex> sl(lock);
+		clients.removeFirstMatchingValue(client);
+
+		if (juce::Thread::getCurrentThreadId() != getThreadId())
+			callFinished.wait(sl, [this, client] { return clientBeingCalled != client; });
+	}
+
+private:
+	//==============================================================================
+	void run() override
+	{
+		while (!threadShouldExit())
+		{
+			const juce::uint32 now = juce::Time::getMillisecondCounter();
+			juce::Array<Client*> clientsToCall;
+			int interval = -1;
+
+			{
+				const std::lock_guard<std::mutex> sl(lock);
+				clientsToCall = clients;
+
+				for (int i = 0; i < clients.size(); ++i)
+				{
+					const int clientInterval = juce::jmax(1, clients.getUnchecked(i)->getMaxLatency() / 2);
+					interval = interval < 0 ? clientInterval : juce::jmin(interval, clientInterval);
+				}
+			}
+
+			for (int i = 0; i < clientsToCall.size(); ++i)
+			{
+				Client *client = clientsToCall.getUnchecked(i);
+
+				{
+					const std::lock_guard<std::mutex> sl(lock);
+
+					// It may have been removed since the list was copied.
+					if (!clients.contains(client))
+						continue;
+
+					clientBeingCalled = client;
+				}
+
+				client->flushIfOverdue(now);
+
+				{
+					const std::lock_guard<std::mutex> sl(lock);
+					clientBeingCalled = nullptr;
+				}
+
+				callFinished.notify_all();
+			}
+
+			wait(interval);
+		}
+	}
+
+	//==============================================================================
+	std::mutex lock;
+	std::condition_variable callFinished;
+	juce::Array<Client*> clients;
+	Client *clientBeingCalled = nullptr;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleFlushTimer)
+};
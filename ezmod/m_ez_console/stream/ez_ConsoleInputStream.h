@@ -0,0 +1,553 @@
+﻿#pragma once
+#define EZ_CONSOLEINPUTSTREAM_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Reads the standard input in large blocks, and hands out its lines
+	       without copying them.
+	       以大块方式读取标准输入，并在不拷贝的情况下逐行提供其内容。
+
+	When the standard input is a regular file, as with "tool < data.txt", the
+	whole file is mapped into memory and never copied at all. Otherwise, for
+	pipes and terminals, it is read into a buffer one block at a time, and the
+	buffer only grows when a single line is longer than it.
+
+	"readLine" returns a view of the next line inside the mapping or the
+	buffer, without the new line characters, which stays valid until the next
+	call on the stream. New lines are searched for with SSE2 or AVX2, like the
+	kernels of ConsoleUTF8. "readNextLine" does the same but returns a String,
+	and the rest of the juce::InputStream methods read the data as bytes.
+
+	In Windows, console input is read with "ReadConsoleW" and converted to
+	UTF-8, so that typed or pasted text arrives as UTF-8 whatever the code page
+	of the console is, and Ctrl+Z at the start of a line ends the input as it
+	does for other programs. A UTF-8 byte order mark at the start of the input,
+	which some Windows tools write into pipes, is skipped by the line methods.
+
+	The bytes are passed on as they are. Use ConsoleUTF8 to check them if the
+	input may not be valid UTF-8.
+
+	当标准输入是一个普通文件时（例如"tool < data.txt"），整个文件会被映射到内存中，
+	完全不需要拷贝。否则，对于管道和终端，数据会被一次一块地读入缓冲区，只有当单独
+	一行比缓冲区还长时，缓冲区才会增大。
+
+	"readLine"返回映射区或缓冲区中下一行的视图（不含换行符），该视图在下一次调用该
+	输入流之前一直有效。换行符使用 SSE2 或 AVX2 查找，与 ConsoleUTF8 的内核相同。
+	"readNextLine"的功能相同，但返回一个 String，而 juce::InputStream 的其他方法则以
+	字节形式读取数据。
+
+	在Windows系统中，控制台输入使用"ReadConsoleW"读取并转换为UTF-8，因此无论控制台
+	的代码页是什么，键入或粘贴的文本都会以UTF-8形式到达；在行首按下 Ctrl+Z 会像在
+	其他程序中一样结束输入。部分Windows工具会向管道写入UTF-8字节顺序标记，位于输入
+	开头的字节顺序标记会被按行读取的方法跳过。
+
+	字节会被原样传递。如果输入可能不是合法的UTF-8，请使用 ConsoleUTF8 进行检查。
+
+	@see ConsoleOutputStream, ConsoleUTF8
+*/
+class ConsoleInputStream : public juce::InputStream
+{
+public:
+	//==============================================================================
+	/** @brief A line inside the data of the stream.
+	           输入流数据中的一行。
+	*/
+	struct Line
+	{
+		const char *data = nullptr;  /**< The first byte of the line. 该行的第一个字节。 */
+		size_t size = 0;             /**< The size in bytes, without the new line. 字节数，不含换行符。 */
+
+		/** @brief Copies the line into a String.
+		           将该行拷贝到一个 String 中。
+		*/
+		juce::String toString() const
+		{
+			return juce::String::fromUTF8(data, (int)size);
+		}
+	};
+
+	//==============================================================================
+	/** @brief Creates a stream that reads the standard input.
+	           创建一个读取标准输入的输入流。
+
+		Only one stream should read the standard input at a time. When it is
+		destroyed, the position of the standard input is left just after what
+		it read if the input is a file.
+
+		同一时间只应有一个输入流读取标准输入。当其被销毁时，如果输入是一个文件，标准
+		输入的位置会被留在其已读取内容的后面。
+
+		@param blockSize    The size of the blocks read from pipes and terminals.
+		                    The default value is 256 KB.
+		                    从管道和终端读取的数据块的大小。默认值是256 KB。
+	*/
+	explicit ConsoleInputStream(size_t blockSize = 256 * 1024)
+		: bufferSize(juce::jmax(blockSize, (size_t)minimumRoom))
+	{
+#ifdef JUCE_WINDOWS
+		hInput = GetStdHandle(STD_INPUT_HANDLE);
+		isConsole = ConsoleCapabilities::getInstance().isTerminal(ConsoleCapabilities::standardInput);
+
+		LARGE_INTEGER size, offset, zero;
+		zero.QuadPart = 0;
+
+		if (GetFileType(hInput) == FILE_TYPE_DISK && GetFileSizeEx(hInput, &size) && size.QuadPart > 0
+		    && SetFilePointerEx(hInput, zero, &offset, FILE_CURRENT)
+		    && (juce::uint64)size.QuadPart <= (juce::uint64)std::numeric_limits<size_t>::max())
+		{
+			hMapping = CreateFileMappingW(hInput, NULL, PAGE_READONLY, 0, 0, NULL);
+
+			if (hMapping != NULL)
+			{
+				mapping = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+
+				if (mapping != nullptr)
+					openMapping((size_t)size.QuadPart, (size_t)offset.QuadPart);
+			}
+		}
+#else
+		struct stat info;
+		const off_t offset = ::lseek(STDIN_FILENO, 0, SEEK_CUR);
+
+		if (::fstat(STDIN_FILENO, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 && offset >= 0
+		    && (juce::uint64)info.st_size <= (juce::uint64)std::numeric_limits<size_t>::max())
+		{
+			void *address = ::mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0);
+
+			if (address != MAP_FAILED)
+			{
+				mapping = static_cast<const char*>(address);
+				::madvise(address, (size_t)info.st_size, MADV_SEQUENTIAL);
+				openMapping((size_t)info.st_size, (size_t)offset);
+			}
+		}
+#endif
+	}
+
+	/** @brief Destructor.
+	           析构函数。
+	*/
+	~ConsoleInputStream()
+	{
+		if (mapping == nullptr)
+			return;
+
+#ifdef JUCE_WINDOWS
+		LARGE_INTEGER offset;
+		offset.QuadPart = (LONGLONG)position;
+		SetFilePointerEx(hInput, offset, NULL, FILE_BEGIN);
+
+		UnmapViewOfFile(mapping);
+		CloseHandle(hMapping);
+#else
+		::lseek(STDIN_FILENO, (off_t)position, SEEK_SET);
+		::munmap(const_cast<char*>(mapping), dataSize);
+#endif
+	}
+
+	//==============================================================================
+	/** @brief Reads the next line.
+	           读取下一行。
+
+		The line ends at a new line character, which is not included, and a
+		carriage return before it is removed too. The last line of the input
+		does not need to end with a new line.
+
+		行在换行符处结束，换行符不包含在内，其前面的回车符也会被移除。输入的最后一行
+		不需要以换行符结尾。
+
+		@param line  Set to the line. The data stays valid until the next call on
+		             this stream.
+		             被设置为读到的行。其数据在下一次调用该输入流之前一直有效。
+
+		@returns false at the end of the input.
+		@returns 到达输入末尾时返回false。
+	*/
+	bool readLine(Line &line)
+	{
+		if (atStart)
+			skipByteOrderMark();
+
+		size_t numSearched = 0;
+
+		for (;;)
+		{
+			const char *newLine = findNewLine(data + position + numSearched, dataSize - position - numSearched);
+
+			if (newLine != nullptr)
+			{
+				const size_t end = (size_t)(newLine - data);
+				setLine(line, end);
+				position = end + 1;
+				return true;
+			}
+
+			numSearched = dataSize - position;
+
+			if (!fillBuffer())
+				break;
+		}
+
+		if (position == dataSize)
+			return false;
+
+		setLine(line, dataSize);
+		position = dataSize;
+		return true;
+	}
+
+	/** @brief Returns true if the standard input is a file mapped into memory.
+	           如果标准输入是一个被映射到内存中的文件，返回true。
+	*/
+	bool isMapped() const
+	{
+		return mapping != nullptr;
+	}
+
+	/** @brief Returns true if the standard input is a terminal.
+	           如果标准输入是一个终端，返回true。
+	*/
+	bool isInteractive() const
+	{
+		return ConsoleCapabilities::getInstance().isTerminal(ConsoleCapabilities::standardInput);
+	}
+
+	//==============================================================================
+	/** @brief Returns the size of a mapped file, or -1 for other input.
+	           返回被映射文件的大小，其他输入则返回-1。
+	*/
+	juce::int64 getTotalLength() override
+	{
+		return isMapped() ? (juce::int64)dataSize : -1;
+	}
+
+	bool isExhausted() override
+	{
+		return position == dataSize && !fillBuffer();
+	}
+
+	int read(void *destBuffer, int maxBytesToRead) override
+	{
+		char *dest = static_cast<char*>(destBuffer);
+		size_t numWanted = (size_t)juce::jmax(0, maxBytesToRead);
+		size_t numCopied = 0;
+
+		atStart = false;
+
+		while (numWanted > 0)
+		{
+			if (position == dataSize)
+			{
+				// A large read goes straight into the destination
+				if (!isMapped() && numWanted >= bufferSize && !endOfInput)
+				{
+					numBytesDiscarded += (juce::int64)dataSize;
+					position = dataSize = 0;
+
+					const size_t numRead = readBlock(dest + numCopied, numWanted);
+
+					if (numRead == 0)
+					{
+						endOfInput = true;
+						break;
+					}
+
+					numBytesDiscarded += (juce::int64)numRead;
+					numCopied += numRead;
+					numWanted -= numRead;
+					continue;
+				}
+
+				if (!fillBuffer())
+					break;
+			}
+
+			const size_t numToCopy = juce::jmin(numWanted, dataSize - position);
+			memcpy(dest + numCopied, data + position, numToCopy);
+			position += numToCopy;
+			numCopied += numToCopy;
+			numWanted -= numToCopy;
+		}
+
+		return (int)numCopied;
+	}
+
+	juce::String readNextLine() override
+	{
+		Line line;
+		return readLine(line) ? line.toString() : juce::String();
+	}
+
+	juce::int64 getPosition() override
+	{
+		return numBytesDiscarded + (juce::int64)position;
+	}
+
+	/** @brief Moves anywhere in a mapped file. Other input can only move
+	           forwards, or back within what is still buffered.
+	           在被映射的文件中可以移动到任意位置。其他输入只能向前移动，或者在仍被
+	           缓冲的范围内向后移动。
+	*/
+	bool setPosition(juce::int64 newPosition) override
+	{
+		if (newPosition < numBytesDiscarded)
+			return false;
+
+		atStart = false;
+
+		if (isMapped())
+		{
+			position = (size_t)juce::jmin(newPosition, (juce::int64)dataSize);
+			return true;
+		}
+
+		while (newPosition > getPosition())
+		{
+			if (position == dataSize && !fillBuffer())
+				return false;
+
+			position += (size_t)juce::jmin(newPosition - getPosition(), (juce::int64)(dataSize - position));
+		}
+
+		position = (size_t)(newPosition - numBytesDiscarded);
+		return true;
+	}
+
+	//==============================================================================
+	/** @brief Returns the first new line character in the data, or nullptr if
+	           there is none.
+	           返回数据中的第一个换行符，如果没有则返回nullptr。
+	*/
+	static const char* findNewLine(const char *data, size_t numBytes)
+	{
+		static const NewLineFinder finder = ConsoleSIMD::chooseKernel(findNewLineScalar, findNewLineSSE2, findNewLineAVX2);
+		return finder(data, numBytes);
+	}
+
+private:
+	//==============================================================================
+	enum
+	{
+		minimumRoom = 64,
+		wideBufferSize = 8192,
+		ctrlZ = 0x1a
+	};
+
+	typedef const char* (*NewLineFinder) (const char*, size_t);
+
+	void openMapping(size_t size, size_t offset)
+	{
+		data = mapping;
+		dataSize = size;
+		position = juce::jmin(offset, size);
+		endOfInput = true;
+	}
+
+	void setLine(Line &line, size_t end) const
+	{
+		line.data = data + position;
+		line.size = end - position;
+
+		if (line.size > 0 && line.data[line.size - 1] == '\r')
+			--line.size;
+	}
+
+	void skipByteOrderMark()
+	{
+		atStart = false;
+
+		while (dataSize - position < 3 && fillBuffer())
+		{
+		}
+
+		if (dataSize - position >= 3 && memcmp(data + position, "\xef\xbb\xbf", 3) == 0)
+			position += 3;
+	}
+
+	// Keeps what has not been read yet at the start of the buffer, and reads
+	// more after it.
+	bool fillBuffer()
+	{
+		if (endOfInput)
+			return false;
+
+		if (buffer == nullptr)
+			buffer.malloc(bufferSize);
+
+		if (position > 0)
+		{
+			memmove(buffer, buffer + position, dataSize - position);
+			numBytesDiscarded += (juce::int64)position;
+			dataSize -= position;
+			position = 0;
+		}
+
+		if (bufferSize - dataSize < (size_t)minimumRoom)
+		{
+			bufferSize *= 2;
+			buffer.realloc(bufferSize);
+		}
+
+		data = buffer;
+
+		const size_t numRead = readBlock(buffer + dataSize, bufferSize - dataSize);
+
+		if (numRead == 0)
+		{
+			endOfInput = true;
+			return false;
+		}
+
+		dataSize += numRead;
+		return true;
+	}
+
+	size_t readBlock(char *dest, size_t numBytes)
+	{
+#ifdef JUCE_WINDOWS
+		if (isConsole)
+			return readConsole(dest, numBytes);
+
+		DWORD numRead = 0;
+
+		if (!ReadFile(hInput, dest, (DWORD)juce::jmin(numBytes, (size_t)0x40000000), &numRead, NULL))
+			return 0;
+
+		return (size_t)numRead;
+#else
+		for (;;)
+		{
+			const ssize_t numRead = ::read(STDIN_FILENO, dest, numBytes);
+
+			if (numRead >= 0)
+				return (size_t)numRead;
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				pollfd p = { STDIN_FILENO, POLLIN, 0 };
+				::poll(&p, 1, -1);
+			}
+			else if (errno != EINTR)
+			{
+				return 0;
+			}
+		}
+#endif
+	}
+
+#ifdef JUCE_WINDOWS
+	// ReadConsoleW gives UTF-16 whatever the code page is, which ReadFile and
+	// ReadConsoleA do not. A high surrogate at the end of a read is kept for the
+	// next one, so that a pair is never split.
+	size_t readConsole(char *dest, size_t numBytes)
+	{
+		if (wideBuffer == nullptr)
+			wideBuffer.malloc(wideBufferSize);
+
+		const size_t maxUnits = juce::jmin(numBytes / 3, (size_t)wideBufferSize);
+		DWORD numRead = 0;
+
+		if (maxUnits <= numHeldUnits
+		    || !ReadConsoleW(hInput, wideBuffer + numHeldUnits, (DWORD)(maxUnits - numHeldUnits), &numRead, NULL))
+			return 0;
+
+		size_t numUnits = numHeldUnits + numRead;
+		numHeldUnits = 0;
+
+		if (numUnits == 0 || (atLineStart && wideBuffer[0] == ctrlZ))
+			return 0;
+
+		if (numUnits > 1 && wideBuffer[numUnits - 1] >= 0xd800 && wideBuffer[numUnits - 1] < 0xdc00)
+			numHeldUnits = 1;
+
+		const size_t numWritten = ConsoleUTF8::convertUTF16(reinterpret_cast<const juce::uint16*>(wideBuffer.getData()),
+		                                                    numUnits - numHeldUnits, dest);
+
+		if (numHeldUnits > 0)
+			wideBuffer[0] = wideBuffer[numUnits - 1];
+
+		atLineStart = numWritten > 0 && dest[numWritten - 1] == '\n';
+		return numWritten;
+	}
+#endif
+
+	//==============================================================================
+	static const char* findNewLineScalar(const char *data, size_t numBytes)
+	{
+		return static_cast<const char*>(memchr(data, '\n', numBytes));
+	}
+
+#if EZ_CONSOLE_USE_SSE2
+	static const char* findNewLineSSE2(const char *data, size_t numBytes)
+	{
+		const __m128i newLine = _mm_set1_epi8('\n');
+		size_t i = 0;
+
+		for (; i + 16 <= numBytes; i += 16)
+		{
+			const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), newLine));
+
+			if (mask != 0)
+				return data + i + ConsoleSIMD::findLowestSetBit((juce::uint32)mask);
+		}
+
+		return findNewLineScalar(data + i, numBytes - i);
+	}
+#else
+	static const char* findNewLineSSE2(const char*, size_t)   { return nullptr; }
+#endif
+
+#if EZ_CONSOLE_USE_AVX2
+	// Two vectors per step, as lines of text are usually longer than 32 bytes.
+	EZ_CONSOLE_AVX2_TARGET
+	static const char* findNewLineAVX2(const char *data, size_t numBytes)
+	{
+		const __m256i newLine = _mm256_set1_epi8('\n');
+		size_t i = 0;
+
+		for (; i + 64 <= numBytes; i += 64)
+		{
+			const __m256i low = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), newLine);
+			const __m256i high = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 32)), newLine);
+
+			if (_mm256_movemask_epi8(_mm256_or_si256(low, high)) != 0)
+			{
+				const juce::uint32 lowMask = (juce::uint32)_mm256_movemask_epi8(low);
+
+				return lowMask != 0 ? data + i + ConsoleSIMD::findLowestSetBit(lowMask)
+				                    : data + i + 32 + ConsoleSIMD::findLowestSetBit((juce::uint32)_mm256_movemask_epi8(high));
+			}
+		}
+
+		for (; i + 32 <= numBytes; i += 32)
+		{
+			const juce::uint32 mask = (juce::uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), newLine));
+
+			if (mask != 0)
+				return data + i + ConsoleSIMD::findLowestSetBit(mask);
+		}
+
+		return findNewLineScalar(data + i, numBytes - i);
+	}
+#else
+	static const char* findNewLineAVX2(const char*, size_t)   { return nullptr; }
+#endif
+
+	//==============================================================================
+	const char *data = nullptr;
+	const char *mapping = nullptr;
+	size_t position = 0, dataSize = 0, bufferSize;
+	juce::int64 numBytesDiscarded = 0;
+	juce::HeapBlock<char> buffer;
+	bool endOfInput = false, atStart = true;
+
+#ifdef JUCE_WINDOWS
+	HANDLE hInput = INVALID_HANDLE_VALUE, hMapping = NULL;
+	bool isConsole = false, atLineStart = true;
+	juce::HeapBlock<WCHAR> wideBuffer;
+	size_t numHeldUnits = 0;
+#endif
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleInputStream)
+};
@@ -0,0 +1,1839 @@
+﻿#pragma once
+#define EZ_CONSOLEOUTPUTSTREAM_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Writes data to standard output stream.
+	       向标准输出流输出数据。
+
+	This is use to take over the "cout" object in the stardard library.
+
+	The usage of this class is somewhat like the "MemoryOutputStream" in JUCE.
+	The data is kept in a list of fixed-size chunks taken from a shared pool
+	instead of one growing block, so writing a lot of data never reallocates
+	or moves what is already buffered.
+
+	By using this class, you can have a strong compatibility to the build-in
+	JUCE data types.
+
+	And, you can output UTF-8 strings by using this class in whatever compiling
+	environment, which is not possible using cout in VC compiler.
+
+	We also provide a "command" method, which have the same function as "system",
+	and prints the output of the command through the stream.
+
+	Important: Be sure to call "InitUTF8Console" before any UTF-8 outputs, so
+	that the console uses a font that can show them.
+
+	Note that we only support UTF-8 outputs in Windows in current version.
+
+	该类被用于取代C++标准库里的传统"cout"对象。
+
+	该类的使用方法与 JUCE 的 MemoryOutputStream 类很相似。数据保存在从共享缓冲池
+	中取出的固定大小内存块链表中，而不是一整块不断增长的内存，因此写入大量数据时
+	永远不会重新分配或移动已缓冲的数据。
+
+	该类与 JUCE 的内置数据类型具有很强的兼容性。
+
+	使用该类，您可以在任何编译环境下输出UTF-8字符串。这是使用cout在VC编译器中
+	无法实现的。
+
+	同时，我们还提供了了一个"command"方法，该方法与"system"函数作用相同，并通过
+	输出流打印命令的输出。
+
+	重要！请在输出任何UTF-8数据之前调用"InitUTF8Console"，以便控制台使用能够显示
+	这些数据的字体。
+
+	注意：当前版本的UTF-8数据输出功能暂时只支持Windows系统。
+
+*/
+class ConsoleOutputStream : public juce::OutputStream,
+                            private ConsoleFlushTimer::Client
+{
+public:
+	//==============================================================================
+	/** @brief When the stream prints its data without being asked to.
+	           输出流在未被要求时何时输出其数据。
+
+		@see setFlushPolicy, setMaxLatency
+	*/
+	enum FlushPolicy
+	{
+		flushManually,      /**< Only "printData", "printCompleteLines" and "flush" print anything.
+		                         This is the default.
+		                         只有"printData"、"printCompleteLines"和"flush"会输出数据。
+		                         这是默认值。 */
+		flushUnbuffered,    /**< Every write is printed at once.
+		                         每次写入都立即输出。 */
+		flushLineBuffered,  /**< Complete lines are printed as soon as they are written.
+		                         完整的行一经写入即被输出。 */
+		flushBlockBuffered, /**< Everything is printed once the block size is reached.
+		                         缓冲的数据达到块大小时全部输出。 */
+		flushAutomatically  /**< Line buffered when the sink is an interactive terminal,
+		                         block buffered otherwise (files and pipes).
+		                         当 Sink 为交互式终端时按行缓冲，否则（文件和管道）按块
+		                         缓冲。 */
+	};
+
+	//==============================================================================
+	/** @brief Creates an empty console output stream, ready to be written into.
+	           创建一个空的控制台输出流。
+	*/
+	ConsoleOutputStream()
+		: sink(new StandardOutputSink(), true)
+	{
+		reset();
+	}
+
+	/** @brief Destructor.
+	           析构函数。
+
+		Unless the flush policy is flushManually, whatever is still buffered
+		is printed first.
+
+		除非刷新策略为flushManually，否则会先输出仍在缓冲中的数据。
+	*/
+	~ConsoleOutputStream()
+	{
+		setFlushOnCrash(false);
+		setMaxLatency(0);
+
+		if (flushPolicy != flushManually)
+			printData();
+
+		reset();
+	}
+
+	//==============================================================================
+	bool write(const void *data, size_t numBytes) override
+	{
+		const ScopedBufferLock sbl(*this);
+
+		startPendingTimeIfEmpty();
+		buffer.append(data, numBytes);
+
+		applyFlushPolicy(activeFlushPolicy == flushLineBuffered && memchr(data, '\n', numBytes) != nullptr);
+		return true;
+	}
+
+	bool writeRepeatedByte(juce::uint8 byte, size_t numTimesToRepeat) override
+	{
+		const ScopedBufferLock sbl(*this);
+
+		startPendingTimeIfEmpty();
+		buffer.appendRepeated(byte, numTimesToRepeat);
+
+		applyFlushPolicy(byte == '\n' && numTimesToRepeat > 0);
+		return true;
+	}
+
+	juce::int64 getPosition() override
+	{
+		return (juce::int64)buffer.getTotalSize();
+	}
+
+	/** @brief The stream can only be written in order, so this only succeeds
+	           when asked to stay at the current end of the data.
+	           该输出流只能顺序写入，因此只有在要求停留于当前数据末尾时才会成功。
+	*/
+	bool setPosition(juce::int64 newPosition) override
+	{
+		return newPosition == getPosition();
+	}
+
+	//==============================================================================
+	/** @brief Returns the number of bytes waiting to be printed.
+	           返回等待输出的字节数。
+	*/
+	size_t getDataSize() const
+	{
+		return buffer.getTotalSize();
+	}
+
+	/** @brief Returns a pointer to the data waiting to be printed.
+	           返回指向等待输出数据的指针。
+
+		When the data spans more than one chunk, it is copied into one
+		contiguous block first, so only use this where a single pointer is
+		really needed. The pointer stays valid until the stream is next
+		changed.
+
+		当数据跨越多个内存块时，会先将其拷贝到一整块连续的内存中，因此请只在确实
+		需要单个指针的地方使用该方法。该指针在输出流下一次被修改之前一直有效。
+	*/
+	const void* getData() const
+	{
+		const ConsoleChunk *first = buffer.getFirstChunk();
+
+		if (first == nullptr)
+			return "";
+
+		if (first->next == nullptr)
+			return first->data;
+
+		contiguousCopy.malloc(buffer.getTotalSize());
+		buffer.copyTo(contiguousCopy);
+		return contiguousCopy;
+	}
+
+	/** @brief Discards all the data waiting to be printed.
+	           丢弃所有等待输出的数据。
+	*/
+	void reset()
+	{
+		const ScopedBufferLock sbl(*this);
+		buffer.clear();
+	}
+
+	/** @brief Returns the data waiting to be printed as a String.
+	           以String形式返回等待输出的数据。
+	*/
+	juce::String toString() const
+	{
+		return juce::String::createStringFromData(getData(), (int)getDataSize());
+	}
+
+	/** @brief Returns the data waiting to be printed as a String, assuming it is UTF-8.
+	           假定等待输出的数据为UTF-8编码，以String形式返回。
+	*/
+	juce::String toUTF8() const
+	{
+		return juce::String::fromUTF8(static_cast<const char*>(getData()), (int)getDataSize());
+	}
+
+	//==============================================================================
+	/** @brief Makes the stream check that its data is valid UTF-8 before printing it.
+	           使输出流在输出数据之前检查其是否为合法的UTF-8。
+
+		When this is on, every print checks the data with the SIMD validator in
+		ConsoleUTF8, and if anything is wrong, each invalid sequence is replaced
+		with U+FFFD, so a stray byte can never garble the terminal. Valid data
+		is passed on without being copied. It is off by default.
+
+		打开该功能后，每次输出都会使用 ConsoleUTF8 中的 SIMD 校验器检查数据，一旦
+		发现错误，每个非法序列都会被替换为U+FFFD，因此零散的错误字节永远不会搅乱终端
+		的显示。合法的数据会被直接传递，不做拷贝。该功能默认关闭。
+
+		@see ConsoleUTF8
+	*/
+	void setUTF8ValidationEnabled(bool shouldValidate)
+	{
+		const ScopedBufferLock sbl(*this);
+		validateUTF8 = shouldValidate;
+	}
+
+	/** @brief Returns true if the stream checks its data before printing it.
+	           如果输出流在输出之前检查其数据，返回true。
+	*/
+	bool isUTF8ValidationEnabled() const
+	{
+		return validateUTF8;
+	}
+
+	//==============================================================================
+	/** @brief Sets how much data the stream may hold before printing on its own.
+	           设置输出流在自动输出之前最多可以缓存多少数据。
+
+		When a write takes the buffered data over this size, the complete lines
+		are printed, and if that is still not enough, everything is printed.
+		This keeps memory use bounded however long "printData" is not called.
+		The default value is 4 MB.
+
+		当一次写入使缓冲的数据超过该大小时，会先输出所有完整的行，如果仍然超出，则
+		输出全部数据。这样无论多久没有调用"printData"，内存占用都是有上限的。默认值
+		是4 MB。
+	*/
+	void setBufferLimit(size_t maxBytes)
+	{
+		bufferLimit = maxBytes;
+	}
+
+	/** @brief Returns the limit set by "setBufferLimit".
+	           返回由"setBufferLimit"设置的上限。
+	*/
+	size_t getBufferLimit() const
+	{
+		return bufferLimit;
+	}
+
+	//==============================================================================
+	/** @brief Writes a number straight into the buffer.
+	           将数字直接写入缓冲区。
+
+		The generic operators of juce::OutputStream turn each number into a
+		temporary String first. These overloads format it in place instead,
+		so no memory is allocated. Floating point values are written in the
+		shortest form that reads back to the same value.
+
+		juce::OutputStream 的通用运算符会先将每个数字转换为一个临时的String。
+		这些重载则直接在缓冲区中格式化数字，因此不会分配内存。浮点数以能够读回
+		原值的最短形式写出。
+
+		@see hex, fixed, prefix, json, ConsoleNumberFormat
+	*/
+	ConsoleOutputStream& operator<< (int number)                { return appendSigned(number); }
+	ConsoleOutputStream& operator<< (long number)               { return appendSigned(number); }
+	ConsoleOutputStream& operator<< (long long number)          { return appendSigned(number); }
+	ConsoleOutputStream& operator<< (short number)              { return appendSigned(number); }
+	ConsoleOutputStream& operator<< (unsigned int number)       { return appendUnsigned(number); }
+	ConsoleOutputStream& operator<< (unsigned long number)      { return appendUnsigned(number); }
+	ConsoleOutputStream& operator<< (unsigned long long number) { return appendUnsigned(number); }
+	ConsoleOutputStream& operator<< (unsigned short number)     { return appendUnsigned(number); }
+
+	ConsoleOutputStream& operator<< (double number)
+	{
+		return appendFormatted(ConsoleNumberFormat::maxFloatChars,
+			[number] (char *dest) { return ConsoleNumberFormat::formatDouble(number, dest); });
+	}
+
+	ConsoleOutputStream& operator<< (float number)
+	{
+		return appendFormatted(ConsoleNumberFormat::maxFloatChars,
+			[number] (char *dest) { return ConsoleNumberFormat::formatFloat(number, dest); });
+	}
+
+	ConsoleOutputStream& operator<< (const ConsoleNumberFormat::Hex &number)
+	{
+		return appendFormatted(ConsoleNumberFormat::maxIntegerChars,
+			[&number] (char *dest) { return ConsoleNumberFormat::formatHex(number.value, dest, number.minNumDigits, number.upperCase); });
+	}
+
+	ConsoleOutputStream& operator<< (const ConsoleNumberFormat::Fixed &number)
+	{
+		return appendFormatted(ConsoleNumberFormat::maxFixedChars,
+			[&number] (char *dest) { return ConsoleNumberFormat::formatFixed(number.value, number.numDecimalPlaces, dest); });
+	}
+
+	ConsoleOutputStream& operator<< (const ConsoleLinePrefix::Tag &tag)
+	{
+		return appendFormatted(ConsoleLinePrefix::maxChars,
+			[&tag] (char *dest) { return ConsoleLinePrefix::format(dest, tag.level, tag.fields); });
+	}
+
+	template <typename ValueType>
+	ConsoleOutputStream& operator<< (const ConsoleJsonWriter::Json<ValueType> &json)
+	{
+		return writeJson(json.value, json.flags);
+	}
+
+	/** @brief Writes wide text straight into the buffer as UTF-8.
+	           将宽字符文本以UTF-8形式直接写入缓冲区。
+
+		The text is converted by the SIMD kernels in ConsoleUTF8 rather than
+		one character at a time through a temporary String, which makes a big
+		difference for long runs of CJK text.
+
+		文本由 ConsoleUTF8 中的 SIMD 内核转换，而不是经由临时的String逐个字符转换，
+		这对大段的中日韩文本有很大的影响。
+
+		@see ConsoleUTF8
+	*/
+	ConsoleOutputStream& operator<< (const wchar_t *text)  { return appendWideText(text); }
+	ConsoleOutputStream& operator<< (const char16_t *text) { return appendWideText(text); }
+	ConsoleOutputStream& operator<< (const char32_t *text) { return appendWideText(text); }
+
+	/** @brief Writes anything else that juce::OutputStream can write.
+	           写出 juce::OutputStream 能够写出的其他任何内容。
+
+		This passes the value on to the usual juce::OutputStream operator, but
+		returns the ConsoleOutputStream, so the numbers later in the same chain
+		still use the overloads above.
+
+		该运算符将值交给通常的 juce::OutputStream 运算符处理，但返回的是
+		ConsoleOutputStream，因此同一串表达式中后面的数字依然会使用上面的重载。
+	*/
+	template <typename ValueType>
+	auto operator<< (const ValueType &value) -> decltype(std::declval<juce::OutputStream&>() << value, std::declval<ConsoleOutputStream&>())
+	{
+		static_cast<juce::OutputStream&>(*this) << value;
+		return *this;
+	}
+
+	/** @brief Wraps a number so that it is written in hexadecimal, without a "0x" prefix.
+	           包装一个数字，使其以十六进制写出，不带"0x"前缀。
+
+		@code
+		ezout << "id: 0x" << ConsoleOutputStream::hex(id, 8) << newLine;
+		@endcode
+
+		@param minNumDigits  Leading zeros are added up to this many digits.
+		                     不足该位数时补前导零。
+
+		@param upperCase     True to use "A" to "F".
+		                     设为true则使用"A"到"F"。
+	*/
+	static ConsoleNumberFormat::Hex hex(juce::uint64 number, int minNumDigits = 1, bool upperCase = false)
+	{
+		const ConsoleNumberFormat::Hex result = { number, minNumDigits, upperCase };
+		return result;
+	}
+
+	/** @brief Wraps a number so that it is written with a fixed number of decimal places.
+	           包装一个数字，使其以固定的小数位数写出。
+
+		@code
+		ezout << "load: " << ConsoleOutputStream::fixed(load, 2) << "%" << newLine;
+		@endcode
+
+		@param numDecimalPlaces  The number of digits after the decimal point, up to
+		                         ConsoleNumberFormat::maxDecimalPlaces.
+		                         小数点后的位数，最多为ConsoleNumberFormat::maxDecimalPlaces。
+	*/
+	static ConsoleNumberFormat::Fixed fixed(double number, int numDecimalPlaces)
+	{
+		const ConsoleNumberFormat::Fixed result = { number, numDecimalPlaces };
+		return result;
+	}
+
+	/** @brief Makes a timestamp, thread and level prefix for a log line.
+	           生成日志行的时间戳、线程和级别前缀。
+
+		The prefix is written straight into the buffer from text that each
+		thread keeps for the current second, with no String and no allocation.
+
+		前缀由每个线程为当前这一秒保存的文本直接写入缓冲区，不创建String，也不分配
+		内存。
+
+		@code
+		ezout << ConsoleOutputStream::prefix(TeeSink::warning) << "disk almost full" << newLine;
+		@endcode
+
+		@param level   The level to show.
+		               要显示的级别。
+
+		@param fields  The parts to write, a combination of ConsoleLinePrefix::Fields.
+		               The default is the date, the time to the millisecond, the
+		               thread and the level.
+		               要写出的部分，为ConsoleLinePrefix::Fields的组合。默认为日期、
+		               精确到毫秒的时间、线程和级别。
+
+		@see ConsoleLinePrefix
+	*/
+	static ConsoleLinePrefix::Tag prefix(TeeSink::Level level, int fields = ConsoleLinePrefix::defaultFields)
+	{
+		const ConsoleLinePrefix::Tag result = { level, fields };
+		return result;
+	}
+
+	/** @brief Wraps a value so that it is written as JSON.
+	           包装一个值，使其以JSON格式写出。
+
+		@code
+		ezout << "settings: " << ConsoleOutputStream::json(settings, ConsoleJsonWriter::pretty) << newLine;
+		@endcode
+
+		Only a reference to the value is kept, so use it within the same
+		expression.
+
+		只会保存该值的引用，因此请在同一个表达式中使用它。
+
+		@param flags  A combination of ConsoleJsonWriter::Flags. The default is
+		              compact.
+		              ConsoleJsonWriter::Flags 的组合。默认值是compact。
+
+		@see writeJson
+	*/
+	template <typename ValueType>
+	static ConsoleJsonWriter::Json<ValueType> json(const ValueType &value, int flags = ConsoleJsonWriter::compact)
+	{
+		const ConsoleJsonWriter::Json<ValueType> result = { value, flags };
+		return result;
+	}
+
+	/** @brief Writes a value as JSON straight into the buffer.
+	           将一个值以JSON格式直接写入缓冲区。
+
+		The value is walked and escaped into the buffer as it goes, without
+		building the text in a String first. If the JSON grows past the block
+		size of the flush policy (or past the buffer limit, when flushing
+		manually), the part written so far is printed before the rest is
+		written, so even a huge value only takes about a block of memory.
+
+		该方法边遍历值边将转义后的文本写入缓冲区，不会先在String中构建文本。如果
+		JSON超过了刷新策略的块大小（手动刷新时则为缓冲区上限），已写出的部分会在
+		写出其余部分之前先被输出，因此即使是非常大的值，也只占用大约一个数据块的
+		内存。
+
+		@param value  A juce::var, DynamicObject, StringArray, juce::Array, string,
+		              number or bool.
+		              一个juce::var、DynamicObject、StringArray、juce::Array、字符串、
+		              数字或bool。
+
+		@param flags  A combination of ConsoleJsonWriter::Flags. The default is
+		              compact.
+		              ConsoleJsonWriter::Flags 的组合。默认值是compact。
+
+		@see json, ConsoleJsonWriter
+	*/
+	template <typename ValueType>
+	ConsoleOutputStream& writeJson(const ValueType &value, int flags = ConsoleJsonWriter::compact)
+	{
+		const ScopedBufferLock sbl(*this);
+
+		startPendingTimeIfEmpty();
+
+		ConsoleJsonWriter writer(buffer, flags, [this] (ConsoleChunkBuffer&) { printBuffered(); },
+		                         activeFlushPolicy == flushManually ? bufferLimit : flushBlockSize);
+		writer.write(value);
+
+		applyFlushPolicy((flags & ConsoleJsonWriter::pretty) != 0);
+		return *this;
+	}
+
+	/** @brief Writes binary data as a hex dump, like "hexdump -C".
+	           将二进制数据写为十六进制转储，类似于"hexdump -C"。
+
+		The lines are formatted straight into the buffer, with no String for
+		each byte as String::toHexString makes. As with "writeJson", a large
+		dump is printed block by block as it goes, so it never needs much more
+		memory than a block.
+
+		@code
+		ezout.writeHexDump(packet.getData(), packet.getSize());
+		@endcode
+
+		各行被直接格式化到缓冲区中，不会像 String::toHexString 那样为每个字节创建
+		String。与"writeJson"一样，大量数据的转储会在进行中逐块输出，因此所需的内存
+		从不会比一个数据块多很多。
+
+		@param data      The bytes to dump.
+		                 要转储的字节。
+
+		@param numBytes  The number of bytes.
+		                 字节数。
+
+		@param options   The layout. The default is the one of "hexdump -C".
+		                 排版方式。默认与"hexdump -C"相同。
+
+		@see ConsoleHexDump
+	*/
+	ConsoleOutputStream& writeHexDump(const void *data, size_t numBytes,
+		const ConsoleHexDump::Options &options = ConsoleHexDump::Options())
+	{
+		const ScopedBufferLock sbl(*this);
+
+		startPendingTimeIfEmpty();
+
+		ConsoleHexDump dump(buffer, options, [this] (ConsoleChunkBuffer&) { printBuffered(); },
+		                    activeFlushPolicy == flushManually ? bufferLimit : flushBlockSize);
+		dump.write(data, numBytes);
+		dump.finish();
+
+		applyFlushPolicy(true);
+		return *this;
+	}
+
+	/** @brief Writes the contents of a MemoryBlock as a hex dump.
+	           将 MemoryBlock 的内容写为十六进制转储。
+
+		@see writeHexDump
+	*/
+	ConsoleOutputStream& writeHexDump(const juce::MemoryBlock &data,
+		const ConsoleHexDump::Options &options = ConsoleHexDump::Options())
+	{
+		return writeHexDump(data.getData(), data.getSize(), options);
+	}
+
+#if EZ_CONSOLE_HAS_FORMAT_STRINGS
+	/** @brief Writes a format string with each "{}" replaced by the next argument (C++20 only).
+	           写出格式字符串，并将每个"{}"替换为下一个参数（仅限C++20）。
+
+		The format string is parsed while compiling: a wrong number of arguments,
+		an argument type that cannot be written, or an unmatched brace is a
+		compile error. At run time, this is just the literal parts and the
+		arguments appended one after another, with no parsing and no temporary
+		Strings.
+
+		格式字符串在编译期被解析：参数个数错误、无法写出的参数类型或不匹配的花括号
+		都会导致编译错误。在运行时，它只是依次追加字面部分和各个参数，不做任何解析，
+		也不创建临时的String。
+
+		@code
+		ezout.print<"{} frames in {} ms, load {}%\n">(numFrames, elapsed, ConsoleOutputStream::fixed(load, 1));
+		@endcode
+
+		@see ConsoleFormatString, ConsoleFormatArgument
+	*/
+	template <ConsoleFormatString format, typename... Args>
+	ConsoleOutputStream& print(const Args&... args)
+	{
+		using CompiledFormat = ConsoleCompiledFormat<format>;
+
+		static_assert(CompiledFormat::numPlaceholders >= 0,
+		              "Unmatched brace in the format string, use \"{{\" and \"}}\" for literal braces");
+		static_assert(CompiledFormat::numPlaceholders == (int)sizeof...(Args),
+		              "The number of arguments does not match the number of \"{}\" in the format string");
+		static_assert((ConsoleFormatArgument<Args>::isSupported && ...),
+		              "An argument has a type that ConsoleFormatArgument cannot write");
+
+		const ScopedBufferLock sbl(*this);
+
+		startPendingTimeIfEmpty();
+		CompiledFormat::write(buffer, args...);
+
+		applyFlushPolicy(activeFlushPolicy == flushLineBuffered);
+		return *this;
+	}
+#endif
+
+	/** @brief Writes a line through a format kept at the call site.
+	           通过保存在调用点的格式写出一行。
+
+		In text mode, each "{}" of the format is replaced by the next argument,
+		using the same ConsoleFormatArgument writers as "print". In record mode,
+		only the id of the format and the raw arguments are appended, which is
+		a few stores per argument, and the text is rendered later by
+		ConsoleLogReader. The format is described to the log the first time the
+		stream writes it.
+
+		Use the EZ_CONSOLE_LOG macro rather than calling this directly, so that
+		each call site gets its own static ConsoleLogFormat.
+
+		在文本模式下，格式中的每个"{}"都会被下一个参数替换，所用的
+		ConsoleFormatArgument 写出函数与"print"相同。在记录模式下，只追加格式的id和
+		原始参数，每个参数只需几次存储操作，文本之后由 ConsoleLogReader 渲染。格式会
+		在输出流第一次写出它时被描述到日志中。
+
+		请使用 EZ_CONSOLE_LOG 宏而不是直接调用该方法，以便每个调用点都拥有自己的
+		静态 ConsoleLogFormat。
+
+		@see EZ_CONSOLE_LOG, setRecordMode
+	*/
+	template <typename... Args>
+	ConsoleOutputStream& log(const ConsoleLogFormat &format, const Args&... args)
+	{
+		static_assert(areAllTrue(ConsoleLogArgument<Args>::isSupported...),
+		              "An argument has a type that cannot be written to a binary log");
+
+		// The number of arguments does not match the number of "{}" in the format.
+		jassert(format.getNumPlaceholders() == (int)sizeof...(Args));
+
+		const ScopedBufferLock sbl(*this);
+
+		startPendingTimeIfEmpty();
+
+		if (recordMode)
+		{
+			const juce::uint32 id = format.getId();
+			const int index = (int)(id - ConsoleLogFormat::firstFormatId);
+
+			if (index >= writtenFormats.size() || !writtenFormats.getUnchecked(index))
+			{
+				ConsoleLogRecord::writeFormat(buffer, format, ConsoleLogSignature<Args...>::get());
+
+				while (writtenFormats.size() <= index)
+					writtenFormats.add(false);
+
+				writtenFormats.set(index, true);
+			}
+
+			ConsoleLogRecord::writeLine(buffer, id, args...);
+		}
+		else
+		{
+			int index = 0;
+
+			using Expander = int[];
+			(void)Expander { 0, (format.writeLiteral(buffer, index++), ConsoleFormatArgument<Args>::write(buffer, args), 0)... };
+			format.writeLiteral(buffer, index);
+		}
+
+		applyFlushPolicy(activeFlushPolicy == flushLineBuffered);
+		return *this;
+	}
+
+	/** @brief Switches "log" between writing text and writing binary records.
+	           在写出文本和写出二进制记录之间切换"log"的行为。
+
+		Record mode is meant for a stream whose sink is a file, usually a
+		FileSink. Switching it on writes the record that starts a log, so each
+		stream makes a log that can be read on its own. Only use "log" while
+		record mode is on: anything written through the other methods ends up
+		between the records and makes the log unreadable from there on.
+
+		While record mode is on, every "log" call counts as a complete line for
+		flushLineBuffered and "printCompleteLines", and UTF-8 validation is
+		skipped, as the data is binary.
+
+		记录模式适用于 Sink 为文件（通常是 FileSink）的输出流。打开该模式时会写出
+		日志的开始记录，因此每个输出流都会生成一个可以单独读取的日志。在记录模式下
+		请只使用"log"：通过其他方法写入的内容会夹在记录之间，使日志从该处起无法读取。
+
+		在记录模式下，对于flushLineBuffered和"printCompleteLines"而言，每次"log"
+		调用都算作一个完整的行，并且由于数据是二进制的，会跳过UTF-8校验。
+
+		@see log, FileSink, ConsoleLogReader
+	*/
+	void setRecordMode(bool shouldWriteRecords)
+	{
+		const ScopedBufferLock sbl(*this);
+
+		if (shouldWriteRecords && !recordMode)
+		{
+			writtenFormats.clearQuick();
+
+			startPendingTimeIfEmpty();
+			ConsoleLogRecord::writeStart(buffer);
+		}
+
+		recordMode = shouldWriteRecords;
+	}
+
+	/** @brief Returns true if "log" writes binary records.
+	           如果"log"写出二进制记录，返回true。
+	*/
+	bool isRecordMode() const
+	{
+		return recordMode;
+	}
+
+	//==============================================================================
+	/** @brief Limits how many messages "admit" lets through, over the whole stream.
+	           限制"admit"在整个输出流上放行的消息数量。
+
+		The arguments are those of ConsoleRateLimiter. Calling this again starts a
+		new limit, and a rate of 0 with no sampling removes it.
+
+		参数与 ConsoleRateLimiter 相同。再次调用会开始一个新的限制，速率为0且不采样
+		时则取消限制。
+
+		@see admit, ConsoleRateLimiter
+	*/
+	void setRateLimit(double messagesPerSecond, int burstSize = 1, int sampleEvery = 1)
+	{
+		streamLimiter = (messagesPerSecond > 0.0 || sampleEvery > 1)
+			? new ConsoleRateLimiter(messagesPerSecond, burstSize, sampleEvery) : nullptr;
+	}
+
+	/** @brief Gives every message key its own limit, unless it has one set with the
+	           other "setKeyRateLimit".
+	           为每个消息键设置各自的限制，除非已通过另一个"setKeyRateLimit"为其设置。
+
+		Each key that "admit" sees gets its own ConsoleRateLimiter with these
+		arguments, so one noisy message cannot use up the budget of the others.
+		The limits set before for keys are dropped.
+
+		"admit"遇到的每个键都会获得一个使用这些参数的 ConsoleRateLimiter，因此一条
+		频繁出现的消息不会耗尽其他消息的额度。此前为各个键设置的限制会被丢弃。
+	*/
+	void setKeyRateLimit(double messagesPerSecond, int burstSize = 1, int sampleEvery = 1)
+	{
+		keyLimiters.clear();
+		keyLimitersByHash.clear();
+
+		keyRateLimit = messagesPerSecond;
+		keyBurstSize = burstSize;
+		keySampleEvery = sampleEvery;
+	}
+
+	/** @brief Sets the limit of one message key.
+	           设置一个消息键的限制。
+
+		@see setKeyRateLimit
+	*/
+	void setKeyRateLimit(juce::StringRef key, double messagesPerSecond, int burstSize = 1, int sampleEvery = 1)
+	{
+		if (KeyLimiter *existing = findKeyLimiter(key, false))
+			removeKeyLimiter(existing);
+
+		addKeyLimiter(key, messagesPerSecond, burstSize, sampleEvery);
+	}
+
+	/** @brief Makes the stream report the suppressed messages periodically.
+	           使输出流定期报告被抑制的消息。
+
+		At most once per interval, before a message that is admitted, a line
+		is written through "log" for the stream and for each key that lost
+		messages since the last report, saying how many. 0 turns the reports
+		off, which is the default.
+
+		每个间隔内最多一次，在一条被准许的消息之前，为输出流以及自上次报告以来丢失了
+		消息的每个键通过"log"写出一行，说明丢失的数量。设为0则关闭报告，这也是默认值。
+
+		@see reportSuppressed
+	*/
+	void setSuppressionReportInterval(int milliseconds)
+	{
+		reportInterval = juce::jmax(0, milliseconds);
+		lastReportTime = juce::Time::getMillisecondCounter();
+	}
+
+	//==============================================================================
+	/** @brief Returns true if a message may be written, under the stream-wide limit.
+	           如果在整个输出流的限制下可以写出一条消息，返回true。
+
+		Ask this before building a message, so that a message that is refused
+		costs nothing more than the question. The EZ_CONSOLE_LIMITED macro does
+		that for a chain of "<<".
+
+		请在构造消息之前询问，这样被拒绝的消息除询问本身外不会产生任何开销。
+		EZ_CONSOLE_LIMITED 宏为一连串的"<<"做了这件事。
+
+		@see EZ_CONSOLE_LIMITED, setRateLimit
+	*/
+	bool admit()
+	{
+		if (streamLimiter != nullptr && !streamLimiter->admit())
+			return false;
+
+		reportIfDue();
+		return true;
+	}
+
+	/** @brief Returns true if a message with a key may be written, under the limit of
+	           the key and then the stream-wide limit.
+	           如果带有某个键的消息在该键的限制和整个输出流的限制下都可以写出，返回true。
+
+		The key is usually a literal that names the message, such as "disk full".
+		A message that the stream-wide limit refuses does not use up the
+		allowance of its key.
+
+		键通常是为消息命名的字面量，例如"disk full"。被整个输出流的限制拒绝的消息
+		不会占用其键的额度。
+
+		@see setKeyRateLimit
+	*/
+	bool admit(juce::StringRef key)
+	{
+		KeyLimiter *keyLimiter = findKeyLimiter(key, true);
+
+		if (keyLimiter != nullptr && !keyLimiter->limiter.admit())
+			return false;
+
+		if (admit())
+			return true;
+
+		if (keyLimiter != nullptr)
+			keyLimiter->limiter.refund();
+
+		return false;
+	}
+
+	/** @brief Returns how many messages have been suppressed and not reported yet.
+	           返回已被抑制但尚未报告的消息数量。
+	*/
+	juce::uint64 getNumSuppressed() const
+	{
+		juce::uint64 total = streamLimiter != nullptr ? streamLimiter->getNumSuppressed() : 0;
+
+		for (int i = 0; i < keyLimiters.size(); ++i)
+			total += keyLimiters.getUnchecked(i)->limiter.getNumSuppressed();
+
+		return total;
+	}
+
+	/** @brief Writes the report of suppressed messages now.
+	           立即写出被抑制消息的报告。
+
+		@see setSuppressionReportInterval
+	*/
+	void reportSuppressed()
+	{
+		static const ConsoleLogFormat streamFormat("{} messages were suppressed\n", __FILE__, __LINE__);
+		static const ConsoleLogFormat keyFormat("{} messages with the key \"{}\" were suppressed\n", __FILE__, __LINE__);
+
+		if (streamLimiter != nullptr)
+			if (const juce::uint64 numSuppressed = streamLimiter->takeNumSuppressed())
+				log(streamFormat, numSuppressed);
+
+		for (int i = 0; i < keyLimiters.size(); ++i)
+			if (const juce::uint64 numSuppressed = keyLimiters.getUnchecked(i)->limiter.takeNumSuppressed())
+				log(keyFormat, numSuppressed, keyLimiters.getUnchecked(i)->key);
+	}
+
+	//==============================================================================
+	/** @brief Initialize console for UTF-8 data outputs.
+	           为UTF-8输出初始化控制台。
+
+		The code page of the console is already switched to UTF-8 when the
+		first stream is created, see ConsoleCapabilities. This also sets a
+		console font that can show CJK characters. Both are done once for the
+		whole process, so calling this again, on any stream, costs nothing.
+
+		控制台的代码页在第一个输出流被创建时就已切换为UTF-8，参见
+		ConsoleCapabilities。此方法还会设置一个能够显示中日韩字符的控制台字体。
+		两者在整个进程中都只执行一次，因此在任何输出流上再次调用此方法都不会产生
+		开销。
+
+		@returns the BOOL result of setting console font action in Windows in order
+		         to support UTF-8 display, or in other OS, 1 if the locale is UTF-8
+		         and 0 otherwise.
+	    @returns 返回Windows控制台用来支持UTF-8数据显示的修改字体操作的 BOOL 类型
+				 结果，或者当编译环境为非Windows的其他系统时，区域设置为UTF-8则返回1，
+				 否则返回0。
+
+		@see ConsoleCapabilities
+	*/
+	int InitUTF8Console()
+	{
+		const ConsoleCapabilities &capabilities = ConsoleCapabilities::getInstance();
+
+#ifdef JUCE_WINDOWS
+		return capabilities.useUTF8Font();
+#else
+		return capabilities.supportsUTF8() ? 1 : 0;
+#endif
+	}
+
+	/** @brief Print the data in the OutputStram to the console.
+	           向控制台中输出OutputStream（输出流）中的数据。
+
+		Remember to call "InitUTF8Console" before calling this if
+		you have UTF-8 encoded data inserted in your output stream.
+
+		In other OS, this method will write the data stored in the
+		output stream straight to the standard output file descriptor,
+		without converting it to a String or going through "cout".
+
+		如果您的输出内容中有UTF-8编码的数据，请在调用本方法之前先调用
+		"InitUTF8Console"方法。
+
+		在非Windows的其他系统中，该方法会将输出流中的数据直接写入标准
+		输出的文件描述符，而不会将其转换为String或经过"cout"。
+
+		@returns 1 if all the data was written, and 0 if "WriteConsoleW"
+		         or "WriteFile" failed in Windows, or "write" failed in
+		         other OS.
+		@returns 全部数据写入成功返回1；在Windows系统中"WriteConsoleW"或
+				 "WriteFile"失败，或者在其他系统中"write"失败时返回0。
+
+		In async mode, this method only queues the data and returns at
+		once, see "setAsyncMode".
+
+		在异步模式下，该方法只会将数据加入队列并立即返回，参见
+		"setAsyncMode"。
+
+		@see InitUTF8Console, StandardOutputSink, setAsyncMode
+	*/
+	int printData()
+	{
+		const ScopedBufferLock sbl(*this);
+		return printBuffered();
+	}
+
+	/** @brief Prints the data up to and including the last new line character.
+	           输出数据中最后一个换行符及其之前的部分。
+
+		Whatever comes after the last '\n' stays in the stream, so a line that
+		is still being written is never cut in half. If there is no '\n' in the
+		stream, nothing is printed.
+
+		最后一个'\n'之后的内容会留在输出流中，因此正在写入的行永远不会被截断。
+		如果输出流中没有'\n'，则不输出任何内容。
+
+		@returns the same as "printData".
+		@returns 与"printData"相同。
+
+		@see printData
+	*/
+	int printCompleteLines()
+	{
+		const ScopedBufferLock sbl(*this);
+		return printBufferedLines();
+	}
+
+	/** @brief Prints any data left in the stream, and waits until it has all been written.
+	           输出流中剩余的数据，并等待所有数据写出完毕。
+
+		In async mode, this blocks until the writer thread has written and
+		flushed everything that was queued before the call.
+
+		在异步模式下，该方法会阻塞，直到写线程写出并刷新了调用之前入队的所有
+		数据。
+
+		@see printData, setAsyncMode
+	*/
+	void flush() override
+	{
+		printData();
+
+		const ScopedSinkLock ssl(*this);
+		getActiveSink()->flush();
+	}
+
+	//==============================================================================
+	/** @brief Hands the data to the sink without waiting for room, like a
+	           "printData" that never blocks.
+	           将数据交给 Sink 而不等待空间，相当于一个永远不会阻塞的"printData"。
+
+		In async mode with the blockWhenFull policy, if the queue of the writer
+		thread is full, the data is set aside in order, asyncPending is returned
+		and the callback is called on the writer thread once the data is in the
+		queue. Other sinks may block here, as "printData" does.
+
+		This is meant for code that must never block, such as coroutines on a
+		shared executor, which should then leave the flush policy at
+		flushManually so that writing into the stream never prints on its own.
+
+		在异步模式并使用blockWhenFull策略时，如果写线程的队列已满，数据会被按顺序暂存
+		起来，该方法返回asyncPending，并在数据进入队列后于写线程上调用回调函数。其他
+		Sink 可能会像"printData"一样在这里阻塞。
+
+		该方法适用于永远不能阻塞的代码，例如运行在共享执行器上的协程，此时应将刷新
+		策略保持为flushManually，以免写入输出流时自行输出。
+
+		@param whenPrinted  Called if asyncPending is returned. It may be nullptr.
+		                    返回asyncPending时调用。可以为nullptr。
+
+		@see flushAsync, setAsyncMode, ConsoleSink::consumeChunksAsync
+	*/
+	ConsoleSink::AsyncResult printDataAsync(ConsoleSink::AsyncCallback whenPrinted)
+	{
+		const ScopedBufferLock sbl(*this);
+		return printBufferedAsync(std::move(whenPrinted));
+	}
+
+	/** @brief Writes data into the stream and hands it to the sink without waiting.
+	           将数据写入输出流，并不经等待地交给 Sink。
+
+		This is "write" followed by "printDataAsync", except that the flush
+		policy is not applied in between.
+
+		该方法相当于"write"之后调用"printDataAsync"，只是两者之间不会应用刷新策略。
+
+		@see printDataAsync
+	*/
+	ConsoleSink::AsyncResult writeAsync(const void *data, size_t numBytes, ConsoleSink::AsyncCallback whenPrinted)
+	{
+		const ScopedBufferLock sbl(*this);
+
+		buffer.append(data, numBytes);
+		stats.addMessage(buffer.getTotalSize());
+
+		return printBufferedAsync(std::move(whenPrinted));
+	}
+
+	/** @brief Starts a "flush" without waiting for it to finish.
+	           开始一次"flush"，但不等待其完成。
+
+		The data is handed over as by "printDataAsync". In async mode, if it
+		has not all been written and flushed yet, asyncPending is returned and
+		the callback is called on the writer thread once it has. Other sinks
+		flush at once, which may block.
+
+		"flush" remains for callers that can wait.
+
+		数据以与"printDataAsync"相同的方式交出。在异步模式下，如果数据尚未全部写出并
+		刷新，该方法返回asyncPending，并在完成后于写线程上调用回调函数。其他 Sink 会
+		立即刷新，可能会阻塞。
+
+		可以等待的调用者仍然可以使用"flush"。
+
+		@param whenFlushed  Called if asyncPending is returned. It may be nullptr.
+		                    返回asyncPending时调用。可以为nullptr。
+
+		@see printDataAsync, flush
+	*/
+	ConsoleSink::AsyncResult flushAsync(ConsoleSink::AsyncCallback whenFlushed)
+	{
+		const ScopedBufferLock sbl(*this);
+
+		if (printBufferedAsync(nullptr) != ConsoleSink::asyncFailed)
+		{
+			const ScopedSinkLock ssl(*this);
+			return getActiveSink()->flushAsync(std::move(whenFlushed));
+		}
+
+		const ScopedSinkLock ssl(*this);
+
+		const ConsoleSink::AsyncResult result = getActiveSink()->flushAsync([whenFlushed] (bool)
+		{
+			if (whenFlushed != nullptr)
+				whenFlushed(false);
+		});
+
+		return result == ConsoleSink::asyncPending ? result : ConsoleSink::asyncFailed;
+	}
+
+#if EZ_CONSOLE_HAS_COROUTINES
+	/** @brief Hands the data to the sink, suspending the coroutine while the sink
+	           is full (C++20 only).
+	           将数据交给 Sink，在 Sink 已满时挂起协程（仅限C++20）。
+
+		The stream must be in async mode. Any other sink writes in the calling
+		thread, which would block the executor.
+
+		输出流必须处于异步模式。其他 Sink 都会在调用线程中写出，从而阻塞执行器。
+
+		@code
+		ezout.setAsyncMode(true);
+
+		ezout << "request " << id << " done\n";
+		co_await ezout.printDataAwaitable(resumeOnExecutor);
+		@endcode
+
+		@param resumer  Resumes the coroutine if it was suspended. It must not be
+		                nullptr: the coroutine would then go on running on the
+		                writer thread, where a blocking "printData" or "flush"
+		                waits for itself. See ConsoleAwaitable.
+		                协程被挂起时用于恢复它，不能为nullptr：否则协程会继续在写线程
+		                上运行，而在那里阻塞的"printData"或"flush"会等待自己。参见
+		                ConsoleAwaitable。
+
+		@see ConsoleAwaitable, printDataAsync
+	*/
+	ConsoleAwaitable printDataAwaitable(ConsoleAwaitable::Resumer resumer)
+	{
+		jassert(isAsyncMode());
+		jassert(resumer != nullptr);
+
+		return ConsoleAwaitable([this] (ConsoleSink::AsyncCallback callback) { return printDataAsync(std::move(callback)); },
+		                        std::move(resumer));
+	}
+
+	/** @brief Writes data into the stream and hands it to the sink, suspending the
+	           coroutine while the sink is full (C++20 only).
+	           将数据写入输出流并交给 Sink，在 Sink 已满时挂起协程（仅限C++20）。
+
+		The data is copied into the stream at once, so it need not outlive the
+		call. As with "printDataAwaitable", the stream must be in async mode.
+
+		数据会被立即拷贝到输出流中，因此不需要在调用之后继续有效。与
+		"printDataAwaitable"一样，输出流必须处于异步模式。
+
+		@see ConsoleAwaitable, printDataAwaitable, writeAsync
+	*/
+	ConsoleAwaitable writeAwaitable(const void *data, size_t numBytes, ConsoleAwaitable::Resumer resumer)
+	{
+		{
+			const ScopedBufferLock sbl(*this);
+
+			buffer.append(data, numBytes);
+			stats.addMessage(buffer.getTotalSize());
+		}
+
+		return printDataAwaitable(std::move(resumer));
+	}
+
+	/** @brief Prints the data and waits for it to be written without blocking the
+	           thread, suspending the coroutine instead (C++20 only).
+	           输出数据并等待其写出，挂起协程而不是阻塞线程（仅限C++20）。
+
+		The stream must be in async mode. Any other sink flushes in the calling
+		thread, which would block the executor.
+
+		输出流必须处于异步模式。其他 Sink 都会在调用线程中刷新，从而阻塞执行器。
+
+		@code
+		co_await ezout.flushAwaitable(resumeOnExecutor);
+		@endcode
+
+		@see ConsoleAwaitable, printDataAwaitable, flushAsync
+	*/
+	ConsoleAwaitable flushAwaitable(ConsoleAwaitable::Resumer resumer)
+	{
+		jassert(isAsyncMode());
+		jassert(resumer != nullptr);
+
+		return ConsoleAwaitable([this] (ConsoleSink::AsyncCallback callback) { return flushAsync(std::move(callback)); },
+		                        std::move(resumer));
+	}
+#endif
+
+	//==============================================================================
+	/** @brief Sets when the stream prints its data on its own.
+	           设置输出流何时自动输出其数据。
+
+		With flushAutomatically, the choice between line and block buffering is
+		made again whenever the sink changes, so redirecting the output to a
+		file or a pipe gives large block writes, while a terminal still shows
+		each line as soon as it is complete.
+
+		使用flushAutomatically时，每当 Sink 改变都会重新在按行缓冲和按块缓冲之间
+		做出选择。因此将输出重定向到文件或管道时会采用大块写入，而终端仍然能在每一
+		行完成时立即显示。
+
+		@param newPolicy  The policy to use. The default is flushManually.
+		                  要使用的策略。默认值是flushManually。
+
+		@param blockSize  The number of bytes that triggers a print in block
+		                  buffered mode. The default value is 64 KB.
+		                  按块缓冲模式下触发输出的字节数。默认值是64 KB。
+
+		@see setMaxLatency, ConsoleSink::isInteractive
+	*/
+	void setFlushPolicy(FlushPolicy newPolicy, size_t blockSize = 64 * 1024)
+	{
+		const ScopedBufferLock sbl(*this);
+
+		flushPolicy = newPolicy;
+		flushBlockSize = blockSize;
+		updateActiveFlushPolicy();
+	}
+
+	/** @brief Returns the policy set by "setFlushPolicy".
+	           返回由"setFlushPolicy"设置的策略。
+	*/
+	FlushPolicy getFlushPolicy() const
+	{
+		return flushPolicy;
+	}
+
+	/** @brief Sets the longest time that written data may wait before it is printed.
+	           设置已写入的数据在被输出之前最多可以等待的时间。
+
+		This works on top of any flush policy. A shared background thread checks
+		the stream and prints its data once the oldest byte has waited longer
+		than this, so output still appears when nothing else is written.
+
+		While a latency is set, the stream takes a spin lock around each write so
+		the background thread never prints half of one.
+
+		该设置可与任何刷新策略同时使用。一个共享的后台线程会检查输出流，并在最早
+		写入的字节等待超过该时间后输出数据，因此即使之后不再有写入，数据依然会被
+		输出。
+
+		设置了延迟之后，输出流会在每次写入时持有一个自旋锁，以保证后台线程永远不会
+		只输出一次写入的一半。
+
+		@param milliseconds  The maximum latency, or 0 to turn it off. The default
+		                     is 0.
+		                     最大延迟，设为0则关闭该功能。默认值是0。
+
+		@see ConsoleFlushTimer
+	*/
+	void setMaxLatency(int milliseconds)
+	{
+		if (milliseconds > 0)
+		{
+			maxLatency = milliseconds;
+
+			if (latencyTimer == nullptr)
+			{
+				latencyTimer = new juce::SharedResourcePointer<ConsoleFlushTimer>();
+
+				{
+					const ScopedBufferLock sbl(*this);
+					pendingSince = juce::Time::getMillisecondCounter();
+				}
+
+				(*latencyTimer)->addClient(this);
+			}
+		}
+		else if (latencyTimer != nullptr)
+		{
+			(*latencyTimer)->removeClient(this);
+			latencyTimer = nullptr;
+			maxLatency = 0;
+		}
+	}
+
+	/** @brief Makes the data still in the buffer get written out if the process crashes.
+	           使缓冲区中仍保留的数据在进程崩溃时被写出。
+
+		The stream is added to the table of ConsoleCrashHandler, which writes its
+		buffer straight to the file descriptor of the sink from a signal handler.
+		Only sinks that have one are covered: StandardOutputSink, FileSink,
+		RotatingFileSink (except in Windows), and the sinks that wrap them.
+
+		输出流会被加入 ConsoleCrashHandler 的表中，后者会在信号处理函数中将其缓冲区
+		直接写入 Sink 的文件描述符。只有具备文件描述符的 Sink 才在处理范围之内：
+		StandardOutputSink、FileSink、RotatingFileSink（Windows系统除外），以及包装
+		它们的 Sink。
+
+		@param shouldFlush            Whether to write the buffer out on a crash.
+		                              The default is false.
+		                              是否在崩溃时写出缓冲区。默认值是false。
+
+		@param installSignalHandlers  If true, the crash signals are also made to
+		                              call ConsoleCrashHandler::flushAll.
+		                              设为true则同时使崩溃信号调用
+		                              ConsoleCrashHandler::flushAll。
+
+		@returns false if the table of ConsoleCrashHandler is full.
+		@returns ConsoleCrashHandler 的表已满时返回false。
+
+		@see ConsoleCrashHandler
+	*/
+	bool setFlushOnCrash(bool shouldFlush, bool installSignalHandlers = true)
+	{
+		const ScopedBufferLock sbl(*this);
+
+		if (!shouldFlush)
+		{
+			if (flushOnCrash)
+				ConsoleCrashHandler::remove(buffer);
+
+			flushOnCrash = false;
+			return true;
+		}
+
+		if (!ConsoleCrashHandler::add(buffer, sink.get()))
+			return false;
+
+		flushOnCrash = true;
+
+		if (installSignalHandlers)
+			ConsoleCrashHandler::installSignalHandlers();
+
+		return true;
+	}
+
+	/** @brief Returns true if "setFlushOnCrash" was turned on.
+	           如果已通过"setFlushOnCrash"开启，返回true。
+	*/
+	bool isFlushedOnCrash() const
+	{
+		return flushOnCrash;
+	}
+
+	/** @brief Returns the latency set by "setMaxLatency", or 0.
+	           返回由"setMaxLatency"设置的延迟，或0。
+	*/
+	int getMaxLatency() const override
+	{
+		return maxLatency.load();
+	}
+
+	//==============================================================================
+	/** @brief Sets where the data goes when "printData" is called.
+	           设置调用"printData"时数据的去向。
+
+		By default, the data goes to the standard output.
+
+		默认情况下，数据会被输出到标准输出。
+
+		@param newSink        The sink to use, or nullptr to go back to the standard
+		                      output.
+		                      要使用的 Sink，设为nullptr则恢复为标准输出。
+
+		@param takeOwnership  If true, the stream will delete the sink when it is no
+		                      longer needed.
+		                      设为true则由输出流在不再需要该 Sink 时将其删除。
+
+		@see ConsoleSink, StandardOutputSink
+	*/
+	void setSink(ConsoleSink *newSink, bool takeOwnership)
+	{
+		const bool wasAsync = isAsyncMode();
+		const ConsoleAsyncWriter::BackpressurePolicy policy = wasAsync ? asyncWriter->getBackpressurePolicy()
+		                                                               : ConsoleAsyncWriter::blockWhenFull;
+		const int maxQueuedBuffers = wasAsync ? asyncWriter->getMaxQueuedBuffers() : 64;
+
+		{
+			const ScopedBufferLock sbl(*this);
+
+			asyncWriter = nullptr;
+
+			ConsoleSink *replacement = newSink != nullptr ? newSink : new StandardOutputSink();
+
+			// The crash handler must stop using the old sink before it is deleted.
+			if (flushOnCrash)
+				ConsoleCrashHandler::add(buffer, replacement);
+
+			sink.set(replacement, newSink == nullptr || takeOwnership);
+
+			updateActiveFlushPolicy();
+		}
+
+		if (wasAsync)
+			setAsyncMode(true, policy, maxQueuedBuffers);
+	}
+
+	/** @brief Returns the counters of the stream.
+	           返回输出流的计数器。
+
+		They are only kept when EZ_CONSOLE_ENABLE_STATS is 1 in the module
+		settings, otherwise their snapshot is all zeros. They can be read from
+		any thread.
+
+		只有在模块设置中 EZ_CONSOLE_ENABLE_STATS 为1时才会维护这些计数器，否则其快照
+		全部为零。可以在任何线程中读取它们。
+
+		@see ConsoleStreamStats
+	*/
+	const ConsoleStreamStats& getStats() const
+	{
+		return stats;
+	}
+
+	/** @brief Sets the counters of the stream back to zero.
+	           将输出流的计数器归零。
+	*/
+	void resetStats()
+	{
+		stats.reset();
+	}
+
+	/** @brief Returns the sink that the data is written to.
+	           返回数据写入的 Sink。
+	*/
+	ConsoleSink* getSink() const
+	{
+		return sink.get();
+	}
+
+	//==============================================================================
+	/** @brief Turns the asynchronous output mode on or off.
+	           打开或关闭异步输出模式。
+
+		In async mode, "printData" hands the data to a background writer thread
+		and returns at once, so a slow terminal or a full pipe does not stall
+		the calling thread. Call "flush" when you need to wait for the data to
+		be written.
+
+		Turning async mode off waits for everything already queued to be
+		written first.
+
+		在异步模式下，"printData"将数据交给后台写线程后立即返回，因此缓慢的终端或
+		已满的管道不会阻塞调用线程。需要等待数据写出时请调用"flush"。
+
+		关闭异步模式时会先等待所有已入队的数据写出。
+
+		@param shouldBeAsync     True to turn async mode on, false to turn it off.
+		                         设为true打开异步模式，设为false关闭异步模式。
+
+		@param policy            What to do when the queue is full. The default value
+		                         is ConsoleAsyncWriter::blockWhenFull.
+		                         队列已满时的处理方式。默认值是
+		                         ConsoleAsyncWriter::blockWhenFull。
+
+		@param maxQueuedBuffers  How many "printData" calls may be waiting to be
+		                         written. The default value is 64.
+		                         最多允许多少次"printData"调用的数据等待写出。默认值
+		                         是64。
+
+		@see ConsoleAsyncWriter, flush
+	*/
+	void setAsyncMode(bool shouldBeAsync,
+		ConsoleAsyncWriter::BackpressurePolicy policy = ConsoleAsyncWriter::blockWhenFull,
+		int maxQueuedBuffers = 64)
+	{
+		const ScopedBufferLock sbl(*this);
+
+		asyncWriter = nullptr;
+
+		if (shouldBeAsync)
+			asyncWriter = new ConsoleAsyncWriter(sink.get(), false, policy, maxQueuedBuffers);
+	}
+
+	/** @brief Returns true if the stream is in async mode.
+	           如果输出流处于异步模式，返回true。
+	*/
+	bool isAsyncMode() const
+	{
+		return asyncWriter != nullptr;
+	}
+
+	/** @brief Returns the background writer used in async mode, or nullptr.
+	           返回异步模式下使用的后台写出器，或nullptr。
+	*/
+	ConsoleAsyncWriter* getAsyncWriter() const
+	{
+		return asyncWriter.get();
+	}
+
+	//==============================================================================
+	/** @brief Runs a shell command, like the "system" function, and prints its output
+	           through this stream.
+	           像"system"函数一样执行一条shell命令，并通过该输出流打印其输出。
+
+		What is buffered is printed first. The command runs in "cmd /c" in Windows
+		and in "/bin/sh -c" in other OS, through ConsoleProcess, and its standard
+		output and standard error are printed through this stream as they arrive.
+
+		已缓冲的数据会先被打印。该命令通过 ConsoleProcess 在Windows的"cmd /c"中或其他
+		系统的"/bin/sh -c"中执行，其标准输出和标准错误输出在到达时即通过该输出流打印。
+
+		@returns The exit code of the command, or -1 if the shell could not be started.
+		@returns 命令的退出码，无法启动shell时返回-1。
+
+		@see ConsoleProcess
+	*/
+	int command(const char *cmd)
+	{
+		printData();
+
+		ConsoleProcess process;
+		const ConsoleProcess::OutputCallback printOutput = [this] (ConsoleProcess::OutputChannel, const char *data, size_t numBytes)
+		{
+			write(data, numBytes);
+			printData();
+		};
+
+#ifdef JUCE_WINDOWS
+		process.start("cmd.exe /c " + juce::String::fromUTF8(cmd), printOutput);
+#else
+		process.start(juce::StringArray("/bin/sh", "-c", cmd), printOutput);
+#endif
+
+		return process.getExitCode().get();
+	}
+
+private:
+	//==============================================================================
+	ConsoleSink* getActiveSink() const
+	{
+		return asyncWriter != nullptr ? static_cast<ConsoleSink*>(asyncWriter.get()) : sink.get();
+	}
+
+	//==============================================================================
+	struct ScopedBufferLock
+	{
+		explicit ScopedBufferLock(const ConsoleOutputStream &stream)
+			: lock(stream.latencyTimer != nullptr ? &stream.bufferLock : nullptr)
+		{
+			if (lock != nullptr)
+				lock->enter();
+		}
+
+		~ScopedBufferLock()
+		{
+			if (lock != nullptr)
+				lock->exit();
+		}
+
+		const juce::SpinLock *lock;
+	};
+
+	// Keeps the timer thread, which writes what it has taken from the buffer
+	// after letting go of the buffer lock, from calling the sink at the same
+	// time as the owning thread.
+	struct ScopedSinkLock
+	{
+		explicit ScopedSinkLock(const ConsoleOutputStream &stream)
+			: lock(stream.latencyTimer != nullptr ? &stream.sinkLock : nullptr)
+		{
+			if (lock != nullptr)
+				lock->enter();
+		}
+
+		~ScopedSinkLock()
+		{
+			if (lock != nullptr)
+				lock->exit();
+		}
+
+		const juce::CriticalSection *lock;
+	};
+
+	//==============================================================================
+	template <typename FormatFunction>
+	ConsoleOutputStream& appendFormatted(size_t maxNumBytes, FormatFunction format)
+	{
+		const ScopedBufferLock sbl(*this);
+
+		startPendingTimeIfEmpty();
+		buffer.commitWrite((size_t)format(buffer.prepareWrite(maxNumBytes)));
+
+		applyFlushPolicy(false);
+		return *this;
+	}
+
+	static constexpr bool areAllTrue()
+	{
+		return true;
+	}
+
+	template <typename... Bools>
+	static constexpr bool areAllTrue(bool first, Bools... rest)
+	{
+		return first && areAllTrue(rest...);
+	}
+
+	template <typename CharType>
+	ConsoleOutputStream& appendWideText(const CharType *text)
+	{
+		size_t numUnits = 0;
+
+		if (text != nullptr)
+			while (text[numUnits] != 0)
+				++numUnits;
+
+		const ScopedBufferLock sbl(*this);
+
+		startPendingTimeIfEmpty();
+
+		if (sizeof(CharType) == 2)
+			ConsoleUTF8::appendUTF16(buffer, reinterpret_cast<const juce::uint16*>(text), numUnits);
+		else
+			ConsoleUTF8::appendUTF32(buffer, reinterpret_cast<const juce::uint32*>(text), numUnits);
+
+		applyFlushPolicy(activeFlushPolicy == flushLineBuffered);
+		return *this;
+	}
+
+	ConsoleOutputStream& appendSigned(juce::int64 number)
+	{
+		return appendFormatted(ConsoleNumberFormat::maxIntegerChars,
+			[number] (char *dest) { return ConsoleNumberFormat::formatSigned(number, dest); });
+	}
+
+	ConsoleOutputStream& appendUnsigned(juce::uint64 number)
+	{
+		return appendFormatted(ConsoleNumberFormat::maxIntegerChars,
+			[number] (char *dest) { return ConsoleNumberFormat::formatUnsigned(number, dest); });
+	}
+
+	//==============================================================================
+	int printBuffered()
+	{
+		if (buffer.getTotalSize() == 0)
+			return 1;
+
+		const ScopedSinkLock ssl(*this);
+		const ConsoleStreamStats::PrintTimer printTimer(stats, buffer.getTotalSize());
+		return getActiveSink()->consumeChunks(validateIfEnabled(buffer.detachChunks())) ? 1 : 0;
+	}
+
+	ConsoleSink::AsyncResult printBufferedAsync(ConsoleSink::AsyncCallback whenPrinted)
+	{
+		if (buffer.getTotalSize() == 0)
+			return ConsoleSink::asyncDone;
+
+		const ScopedSinkLock ssl(*this);
+		const ConsoleStreamStats::PrintTimer printTimer(stats, buffer.getTotalSize());
+		return getActiveSink()->consumeChunksAsync(validateIfEnabled(buffer.detachChunks()), std::move(whenPrinted));
+	}
+
+	int printBufferedLines()
+	{
+		if (recordMode)
+			return printBuffered();
+
+		size_t lastNewLine;
+
+		if (!buffer.findLast('\n', lastNewLine))
+			return 1;
+
+		const ScopedSinkLock ssl(*this);
+		const ConsoleStreamStats::PrintTimer printTimer(stats, lastNewLine + 1);
+		return getActiveSink()->consumeChunks(validateIfEnabled(buffer.detachFront(lastNewLine + 1))) ? 1 : 0;
+	}
+
+	ConsoleChunk* validateIfEnabled(ConsoleChunk *chunks)
+	{
+		if (!validateUTF8 || recordMode || ConsoleUTF8::isValid(chunks))
+			return chunks;
+
+		const size_t numBytes = ConsoleChunk::getTotalSize(chunks);
+		juce::HeapBlock<char> data(numBytes);
+		size_t offset = 0;
+
+		for (const ConsoleChunk *chunk = chunks; chunk != nullptr; chunk = chunk->next)
+		{
+			memcpy(data + offset, chunk->data, chunk->size);
+			offset += chunk->size;
+		}
+
+		ConsoleChunkPool::getInstance().releaseList(chunks);
+
+		ConsoleChunkBuffer sanitised;
+		ConsoleUTF8::appendSanitised(sanitised, data, numBytes);
+		return sanitised.detachChunks();
+	}
+
+	void applyFlushPolicy(bool wroteNewLine)
+	{
+		stats.addMessage(buffer.getTotalSize());
+
+		switch (activeFlushPolicy)
+		{
+		case flushUnbuffered:
+			printBuffered();
+			break;
+
+		case flushLineBuffered:
+			if (wroteNewLine)
+				printBufferedLines();
+			break;
+
+		case flushBlockBuffered:
+			if (buffer.getTotalSize() >= flushBlockSize)
+				printBuffered();
+			break;
+
+		default:
+			break;
+		}
+
+		if (buffer.getTotalSize() > bufferLimit)
+		{
+			printBufferedLines();
+
+			if (buffer.getTotalSize() > bufferLimit)
+				printBuffered();
+		}
+	}
+
+	void updateActiveFlushPolicy()
+	{
+		if (flushPolicy == flushAutomatically)
+			activeFlushPolicy = sink->isInteractive() ? flushLineBuffered : flushBlockBuffered;
+		else
+			activeFlushPolicy = flushPolicy;
+	}
+
+	struct KeyLimiter
+	{
+		KeyLimiter(juce::StringRef k, juce::int64 h, double messagesPerSecond, int burstSize, int sampleEvery)
+			: key(k), hash(h), limiter(messagesPerSecond, burstSize, sampleEvery)
+		{
+		}
+
+		juce::String key;
+		juce::int64 hash;
+		ConsoleRateLimiter limiter;
+		KeyLimiter *nextWithSameHash = nullptr;
+	};
+
+	enum { maxNumKeys = 1024 };
+
+	static juce::int64 hashKey(juce::StringRef key)
+	{
+		juce::uint64 hash = 14695981039346656037ull;
+
+		for (const char *p = key.text.getAddress(); *p != 0; ++p)
+			hash = (hash ^ (juce::uint8)*p) * 1099511628211ull;
+
+		return (juce::int64)hash;
+	}
+
+	// Keys nobody set a limit for get the one of setKeyRateLimit, if any. Past
+	// maxNumKeys only the stream-wide limit applies. Keys whose hashes are the
+	// same are chained from the map.
+	KeyLimiter* findKeyLimiter(juce::StringRef key, bool createIfNeeded)
+	{
+		const juce::int64 hash = hashKey(key);
+
+		for (KeyLimiter *keyLimiter = keyLimitersByHash[hash]; keyLimiter != nullptr; keyLimiter = keyLimiter->nextWithSameHash)
+			if (keyLimiter->key == key)
+				return keyLimiter;
+
+		if (!createIfNeeded || (keyRateLimit <= 0.0 && keySampleEvery <= 1) || keyLimiters.size() >= maxNumKeys)
+			return nullptr;
+
+		return addKeyLimiter(key, keyRateLimit, keyBurstSize, keySampleEvery);
+	}
+
+	KeyLimiter* addKeyLimiter(juce::StringRef key, double messagesPerSecond, int burstSize, int sampleEvery)
+	{
+		KeyLimiter *keyLimiter = keyLimiters.add(new KeyLimiter(key, hashKey(key), messagesPerSecond, burstSize, sampleEvery));
+		keyLimiter->nextWithSameHash = keyLimitersByHash[keyLimiter->hash];
+		keyLimitersByHash.set(keyLimiter->hash, keyLimiter);
+		return keyLimiter;
+	}
+
+	void removeKeyLimiter(KeyLimiter *keyLimiter)
+	{
+		KeyLimiter *first = keyLimitersByHash[keyLimiter->hash];
+
+		if (first == keyLimiter)
+		{
+			if (keyLimiter->nextWithSameHash != nullptr)
+				keyLimitersByHash.set(keyLimiter->hash, keyLimiter->nextWithSameHash);
+			else
+				keyLimitersByHash.remove(keyLimiter->hash);
+		}
+		else
+		{
+			while (first->nextWithSameHash != keyLimiter)
+				first = first->nextWithSameHash;
+
+			first->nextWithSameHash = keyLimiter->nextWithSameHash;
+		}
+
+		keyLimiters.removeObject(keyLimiter);
+	}
+
+	void reportIfDue()
+	{
+		if (reportInterval == 0)
+			return;
+
+		const juce::uint32 now = juce::Time::getMillisecondCounter();
+
+		if (now - lastReportTime >= (juce::uint32)reportInterval)
+		{
+			lastReportTime = now;
+			reportSuppressed();
+		}
+	}
+
+	//==============================================================================
+	void startPendingTimeIfEmpty()
+	{
+		if (latencyTimer != nullptr && buffer.getTotalSize() == 0)
+			pendingSince = juce::Time::getMillisecondCounter();
+	}
+
+	// The chunks are taken out under the buffer lock, but written after letting
+	// go of it, so the owning thread never spins through a system call. The sink
+	// lock is taken first and held until they are written, so nothing the owning
+	// thread prints afterwards can overtake them.
+	void flushIfOverdue(juce::uint32 now) override
+	{
+		const juce::ScopedTryLock ssl(sinkLock);
+
+		if (!ssl.isLocked())
+			return;
+
+		ConsoleChunk *chunks;
+		size_t numBytes;
+
+		{
+			const juce::SpinLock::ScopedTryLockType sl(bufferLock);
+
+			if (!sl.isLocked() || buffer.getTotalSize() == 0
+				|| now - pendingSince < (juce::uint32)maxLatency.load())
+				return;
+
+			numBytes = buffer.getTotalSize();
+			chunks = validateIfEnabled(buffer.detachChunks());
+		}
+
+		const ConsoleStreamStats::PrintTimer printTimer(stats, numBytes);
+		getActiveSink()->consumeChunks(chunks);
+	}
+
+	//==============================================================================
+	ConsoleChunkBuffer buffer;
+	size_t bufferLimit = 4 * 1024 * 1024;
+	mutable juce::HeapBlock<char> contiguousCopy;
+
+	FlushPolicy flushPolicy = flushManually, activeFlushPolicy = flushManually;
+	size_t flushBlockSize = 64 * 1024;
+
+	bool validateUTF8 = false;
+
+	bool recordMode = false;
+	juce::Array<bool> writtenFormats;
+
+	ConsoleStreamStats stats;
+
+	juce::ScopedPointer<ConsoleRateLimiter> streamLimiter;
+	juce::OwnedArray<KeyLimiter> keyLimiters;
+	juce::HashMap<juce::int64, KeyLimiter*> keyLimitersByHash;
+	double keyRateLimit = 0.0;
+	int keyBurstSize = 1, keySampleEvery = 1;
+	int reportInterval = 0;
+	juce::uint32 lastReportTime = 0;
+
+	juce::ScopedPointer<juce::SharedResourcePointer<ConsoleFlushTimer>> latencyTimer;
+	juce::SpinLock bufferLock;
+	juce::CriticalSection sinkLock;
+	std::atomic<int> maxLatency { 0 };
+	juce::uint32 pendingSince = 0;
+
+	bool flushOnCrash = false;
+
+	juce::OptionalScopedPointer<ConsoleSink> sink;
+	juce::ScopedPointer<ConsoleAsyncWriter> asyncWriter;
+};
+
+//==============================================================================
+/** @brief Writes a chain of "<<" only if ConsoleOutputStream::admit lets it through.
+           只有当 ConsoleOutputStream::admit 放行时才写出一连串的"<<"。
+
+	The optional second argument is the message key. When the message is
+	refused, nothing to the right of the macro is evaluated:
+
+	可选的第二个参数是消息键。消息被拒绝时，宏右侧的任何内容都不会被求值：
+
+	@code
+	EZ_CONSOLE_LIMITED(ezout, "disk full") << "cannot write " << file.getFullPathName() << newLine;
+	@endcode
+*/
+#define EZ_CONSOLE_LIMITED(stream, ...) \
+	if (!(stream).admit(__VA_ARGS__)) {} else (stream)
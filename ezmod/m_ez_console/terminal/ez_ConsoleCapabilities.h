@@ -0,0 +1,256 @@
+﻿#pragma once
+#define EZ_CONSOLECAPABILITIES_H_INCLUDED
+
+#if defined (JUCE_WINDOWS) && !defined (ENABLE_VIRTUAL_TERMINAL_PROCESSING)
+ #define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+
+//==============================================================================
+/**
+
+    @brief What the console of the process can do, found out once and shared
+	       by every stream.
+	       进程的控制台支持哪些功能，只检测一次并由所有输出流共享。
+
+	The first call to "getInstance" sets the console up and looks at it:
+	whether the standard input, output and error are terminals, whether the
+	terminal shows UTF-8 and understands ANSI escape sequences, and how wide it
+	is. Every later call returns the same results without asking the system
+	again, so StandardOutputSink, ConsoleLiveRegion and ConsoleInputStream can
+	ask as often as they like.
+
+	In Windows, setting up means switching the console to the UTF-8 code page
+	with "SetConsoleOutputCP" and "SetConsoleCP", instead of starting a shell
+	to run "chcp", and turning on virtual terminal processing for the standard
+	output and error. In other OS nothing is changed: UTF-8 comes from the
+	locale variables (LC_ALL, LC_CTYPE, then LANG), ANSI support from the TERM
+	variable, and the width from the terminal itself.
+
+	If the program redirects its standard handles later, for example with
+	"dup2", the results are not updated.
+
+	第一次调用"getInstance"时会设置并检测控制台：标准输入、输出和错误输出是否为终端，
+	终端是否能显示UTF-8、是否能理解ANSI转义序列，以及终端的宽度。之后的每次调用都
+	返回相同的结果，不再询问系统，因此 StandardOutputSink、ConsoleLiveRegion 和
+	ConsoleInputStream 可以随意查询。
+
+	在Windows系统中，设置是指使用"SetConsoleOutputCP"和"SetConsoleCP"将控制台切换到
+	UTF-8代码页（而不是启动一个shell来运行"chcp"），并为标准输出和错误输出开启虚拟
+	终端处理。在其他系统中不会做任何改动：UTF-8支持取决于区域设置变量（依次为
+	LC_ALL、LC_CTYPE、LANG），ANSI支持取决于TERM变量，宽度则从终端本身获取。
+
+	如果程序之后重定向了其标准句柄（例如使用"dup2"），检测结果不会随之更新。
+
+	@see ConsoleOutputStream::InitUTF8Console
+*/
+class ConsoleCapabilities
+{
+public:
+	//==============================================================================
+	/** @brief The standard streams of the process.
+	           进程的标准流。
+	*/
+	enum StandardStream
+	{
+		standardInput,   /**< 标准输入。 */
+		standardOutput,  /**< 标准输出。 */
+		standardError    /**< 标准错误输出。 */
+	};
+
+	//==============================================================================
+	/** @brief Returns the capabilities, finding them out the first time.
+	           返回控制台功能，在第一次调用时进行检测。
+
+		This is safe to call from several threads at once.
+
+		可以同时在多个线程中安全地调用。
+	*/
+	static const ConsoleCapabilities& getInstance()
+	{
+		static const ConsoleCapabilities instance;
+		return instance;
+	}
+
+	//==============================================================================
+	/** @brief Returns true if a standard stream is a terminal, rather than a file
+	           or a pipe.
+	           如果一个标准流是终端，而不是文件或管道，返回true。
+	*/
+	bool isTerminal(StandardStream stream) const
+	{
+		return terminal[stream];
+	}
+
+	/** @brief Returns true if the terminal shows UTF-8 text.
+	           如果终端能显示UTF-8文本，返回true。
+	*/
+	bool supportsUTF8() const
+	{
+		return utf8;
+	}
+
+	/** @brief Returns true if the terminal understands ANSI escape sequences.
+	           如果终端能理解ANSI转义序列，返回true。
+
+		This does not say whether the output goes to the terminal. Check
+		"isTerminal" for that.
+
+		这并不表示输出是否发送到终端。请使用"isTerminal"检查这一点。
+	*/
+	bool supportsANSI() const
+	{
+		return ansi;
+	}
+
+	/** @brief Returns the width of the terminal in columns, or 80 if it is not known.
+	           返回终端的宽度（以列计），如果无法得知则返回80。
+
+		@see updateWidth
+	*/
+	int getWidth() const
+	{
+		return width.load(std::memory_order_relaxed);
+	}
+
+	/** @brief Asks the terminal for its width again, after it was resized.
+	           在终端大小改变后，重新获取其宽度。
+
+		@returns the new width.
+		@returns 新的宽度。
+	*/
+	int updateWidth() const
+	{
+		const int newWidth = findWidth();
+		width.store(newWidth, std::memory_order_relaxed);
+		return newWidth;
+	}
+
+	//==============================================================================
+	/** @brief Sets a console font that can show CJK characters (Windows only method).
+	           设置一个能够显示中日韩字符的控制台字体。（该方法只在Windows环境下有效）
+
+		The font is only set the first time.
+
+		字体只在第一次调用时设置。
+
+		@returns the BOOL result of "SetCurrentConsoleFontEx", or 0 in other OS.
+		@returns 返回"SetCurrentConsoleFontEx"的BOOL结果，在其他系统中返回0。
+	*/
+	int useUTF8Font() const
+	{
+#ifdef JUCE_WINDOWS
+		static const int result = [] ()
+		{
+			CONSOLE_FONT_INFOEX info = { 0 };
+			info.cbSize = sizeof(info);
+			info.dwFontSize.Y = 16;
+			info.FontWeight = FW_NORMAL;
+			wcscpy(info.FaceName, L"Consolas");
+
+			return (int)SetCurrentConsoleFontEx(GetStdHandle(STD_OUTPUT_HANDLE), FALSE, &info);
+		}();
+
+		return result;
+#else
+		return 0;
+#endif
+	}
+
+private:
+	//==============================================================================
+	ConsoleCapabilities()
+	{
+#ifdef JUCE_WINDOWS
+		const DWORD handleIds[] = { STD_INPUT_HANDLE, STD_OUTPUT_HANDLE, STD_ERROR_HANDLE };
+
+		for (int i = 0; i < 3; ++i)
+		{
+			HANDLE handle = GetStdHandle(handleIds[i]);
+			DWORD mode = 0;
+
+			terminal[i] = GetConsoleMode(handle, &mode) != 0;
+
+			if (terminal[i] && i != standardInput
+			    && SetConsoleMode(handle, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING))
+				ansi = true;
+		}
+
+		SetConsoleCP(CP_UTF8);
+		utf8 = SetConsoleOutputCP(CP_UTF8) != 0 || GetConsoleOutputCP() == CP_UTF8;
+#else
+		const int descriptors[] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+
+		for (int i = 0; i < 3; ++i)
+			terminal[i] = isatty(descriptors[i]) != 0;
+
+		utf8 = isUTF8Locale();
+
+		const char *term = getenv("TERM");
+		ansi = term != nullptr && *term != 0 && strcmp(term, "dumb") != 0;
+#endif
+
+		width.store(findWidth(), std::memory_order_relaxed);
+	}
+
+#ifndef JUCE_WINDOWS
+	// The first of these that is set decides, as it does for setlocale.
+	static bool isUTF8Locale()
+	{
+		const char *const names[] = { "LC_ALL", "LC_CTYPE", "LANG" };
+
+		for (int i = 0; i < 3; ++i)
+		{
+			const char *value = getenv(names[i]);
+
+			if (value != nullptr && *value != 0)
+			{
+				const juce::String locale(value);
+				return locale.containsIgnoreCase("utf-8") || locale.containsIgnoreCase("utf8");
+			}
+		}
+
+	#if JUCE_MAC
+		return true;
+	#else
+		return false;
+	#endif
+	}
+#endif
+
+	static int findWidth()
+	{
+#ifdef JUCE_WINDOWS
+		const DWORD handleIds[] = { STD_OUTPUT_HANDLE, STD_ERROR_HANDLE };
+
+		for (int i = 0; i < 2; ++i)
+		{
+			CONSOLE_SCREEN_BUFFER_INFO info;
+
+			if (GetConsoleScreenBufferInfo(GetStdHandle(handleIds[i]), &info))
+				return info.srWindow.Right - info.srWindow.Left + 1;
+		}
+#else
+		const int descriptors[] = { STDOUT_FILENO, STDERR_FILENO, STDIN_FILENO };
+
+		for (int i = 0; i < 3; ++i)
+		{
+			winsize size;
+
+			if (::ioctl(descriptors[i], TIOCGWINSZ, &size) == 0 && size.ws_col > 0)
+				return size.ws_col;
+		}
+#endif
+
+		const char *columns = getenv("COLUMNS");
+		const int numColumns = columns != nullptr ? atoi(columns) : 0;
+
+		return numColumns > 0 ? numColumns : 80;
+	}
+
+	//==============================================================================
+	bool terminal[3] = { false, false, false };
+	bool utf8 = false, ansi = false;
+	mutable std::atomic<int> width { 80 };
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleCapabilities)
+};
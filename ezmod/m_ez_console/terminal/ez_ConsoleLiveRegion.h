@@ -0,0 +1,277 @@
+﻿#pragma once
+#define EZ_CONSOLELIVEREGION_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Redraws a block of lines at the bottom of the console, such as
+	       progress bars, by sending only what changed.
+	       重绘控制台底部的一块区域（例如进度条），只发送发生变化的部分。
+
+	The region keeps a copy of the last frame it drew. Each "update" compares
+	the new frame with it line by line, and for each line that changed, moves
+	the cursor to the first character that differs and rewrites only up to the
+	last one, with ANSI escape sequences. Lines that did not change cost
+	nothing, so the amount sent to the terminal, and the flicker, follow what
+	changed rather than the size of the region.
+
+	The whole frame is put together first and written to the stream at once,
+	so with the flushManually policy of the stream, which is the default, it
+	reaches the terminal in a single write. Terminals that know the
+	synchronized output mode also show it in one go.
+
+	Use "printAbove" for lines that should scroll away above the region, and
+	"finish" when the region is done. Lines of a frame should be plain text
+	that fits the width of the terminal, as escape sequences and wrapped lines
+	would put the cursor somewhere the region does not expect. Columns are
+	counted with ConsoleDisplayWidth, so CJK characters take two and combining
+	marks none.
+
+	When the sink of the stream is not interactive, or the terminal does not
+	understand ANSI escape sequences, nothing is drawn until "finish", which
+	prints the last frame as normal lines, so a log file gets the final state
+	instead of a mess of escape sequences.
+
+	该区域保存它上次绘制的帧的副本。每次"update"都会逐行将新帧与之比较，对每个
+	发生变化的行，使用ANSI转义序列将光标移到第一个不同的字符处，并只重写到最后一个
+	不同的字符为止。没有变化的行不产生任何开销，因此发送到终端的数据量以及闪烁程度
+	取决于变化的内容，而不是区域的大小。
+
+	整个帧先被组装完毕，再一次性写入输出流，因此在输出流使用默认的flushManually
+	策略时，它只需一次写入即可到达终端。支持同步输出模式的终端也会一次性显示它。
+
+	需要在区域上方滚动消失的行请使用"printAbove"，区域使用完毕时请调用"finish"。
+	帧中的行应为不超过终端宽度的纯文本，因为转义序列和折行会使光标停在区域意料之外
+	的位置。列数使用 ConsoleDisplayWidth 计算，因此中日韩字符占两列，组合字符不占列。
+
+	当输出流的 Sink 不是交互式的，或者终端不理解ANSI转义序列时，在"finish"之前不会
+	绘制任何内容，"finish"会将最后一帧作为普通的行输出，因此日志文件得到的是最终
+	状态，而不是一堆转义序列。
+*/
+class ConsoleLiveRegion
+{
+public:
+	//==============================================================================
+	/** @brief Creates a region that draws through a stream.
+	           创建一个通过输出流进行绘制的区域。
+
+		The region starts at the line where the cursor is, and the stream must
+		outlive it.
+
+		区域从光标所在的行开始，输出流的生命周期必须长于该区域。
+	*/
+	explicit ConsoleLiveRegion(ConsoleOutputStream &outputStream)
+		: stream(outputStream),
+		  capabilities(ConsoleCapabilities::getInstance())
+	{
+	}
+
+	/** @brief Destructor. Leaves the last frame where it is.
+	           析构函数。将最后一帧保留在原处。
+	*/
+	~ConsoleLiveRegion()
+	{
+		finish();
+	}
+
+	//==============================================================================
+	/** @brief Draws a new frame, one string per line.
+	           绘制新的一帧，每个字符串为一行。
+	*/
+	void update(const juce::StringArray &lines)
+	{
+		if (!isInteractive() || lines == lastFrame)
+		{
+			lastFrame = lines;
+			return;
+		}
+
+		frame.reset();
+		frame << "\x1b[?2026h";
+
+		for (int i = 0; i < lines.size(); ++i)
+			drawLine(i, i < lastFrame.size() ? lastFrame[i] : juce::String(), lines[i]);
+
+		moveToRow(lines.size());
+		frame << "\r";
+
+		if (lastFrame.size() > lines.size())
+			frame << "\x1b[J";
+
+		frame << "\x1b[?2026l";
+
+		lastFrame = lines;
+		writeFrame();
+	}
+
+	/** @brief Draws a new frame, split into lines at each new line character.
+	           绘制新的一帧，在每个换行符处将其拆分为多行。
+	*/
+	void update(const juce::String &text)
+	{
+		update(juce::StringArray::fromLines(text));
+	}
+
+	/** @brief Prints text above the region, then draws the region again below it.
+	           在区域上方输出文本，然后在其下方重新绘制区域。
+
+		The text should end with a new line.
+
+		文本应以换行符结尾。
+	*/
+	void printAbove(const juce::String &text)
+	{
+		if (!isInteractive())
+		{
+			stream << text;
+			stream.printData();
+			return;
+		}
+
+		const juce::StringArray lines(lastFrame);
+
+		frame.reset();
+		moveToRow(0);
+		frame << "\r\x1b[J" << text;
+		writeFrame();
+
+		lastFrame.clear();
+		cursorRow = 0;
+		update(lines);
+	}
+
+	/** @brief Leaves the last frame on the screen and starts a new, empty region
+	           below it.
+	           将最后一帧留在屏幕上，并在其下方开始一个新的空区域。
+	*/
+	void finish()
+	{
+		if (!isInteractive())
+		{
+			for (int i = 0; i < lastFrame.size(); ++i)
+				stream << lastFrame[i] << "\n";
+		}
+
+		if (lastFrame.size() > 0)
+			stream.printData();
+
+		lastFrame.clear();
+		cursorRow = 0;
+	}
+
+	/** @brief Returns the lines of the last frame.
+	           返回最后一帧的各行。
+	*/
+	const juce::StringArray& getLastFrame() const
+	{
+		return lastFrame;
+	}
+
+private:
+	//==============================================================================
+	bool isInteractive() const
+	{
+		return capabilities.supportsANSI()
+			&& (stream.getSink() == nullptr || stream.getSink()->isInteractive());
+	}
+
+	static bool isContinuationByte(char c)
+	{
+		return ((juce::uint8)c & 0xc0) == 0x80;
+	}
+
+	static size_t findCharacterEnd(const char *text, size_t index, size_t numBytes)
+	{
+		while (++index < numBytes && isContinuationByte(text[index])) {}
+		return index;
+	}
+
+	static bool isZeroWidth(const char *text, size_t index, size_t numBytes)
+	{
+		return index < numBytes && ConsoleDisplayWidth::getWidth(text + index, findCharacterEnd(text, index, numBytes) - index) == 0;
+	}
+
+	// The cursor sits on the line below the region between frames, which is
+	// row lastFrame.size(). Moving down uses new lines, so the screen scrolls
+	// when the region grows at the bottom of it.
+	void moveToRow(int row)
+	{
+		if (row < cursorRow)
+			frame << "\x1b[" << (cursorRow - row) << "A";
+
+		for (; cursorRow < row; ++cursorRow)
+			frame << "\n";
+
+		cursorRow = row;
+	}
+
+	void drawLine(int row, const juce::String &oldLine, const juce::String &newLine)
+	{
+		const char *oldText = oldLine.toRawUTF8(), *newText = newLine.toRawUTF8();
+		const size_t oldSize = oldLine.getNumBytesAsUTF8(), newSize = newLine.getNumBytesAsUTF8();
+
+		size_t start = 0;
+
+		while (start < oldSize && start < newSize && oldText[start] == newText[start])
+			++start;
+
+		if (start == oldSize && start == newSize)
+			return;
+
+		// A combining mark that was added or removed is redrawn with the
+		// character it sits on.
+		do
+		{
+			while (start > 0 && isContinuationByte(newText[start]))
+				--start;
+		}
+		while (start > 0 && (isZeroWidth(newText, start, newSize) || isZeroWidth(oldText, start, oldSize)) && --start > 0);
+
+		const int startColumn = ConsoleDisplayWidth::getWidth(newText, start);
+		const int oldNumColumns = startColumn + ConsoleDisplayWidth::getWidth(oldText + start, oldSize - start);
+		const int newNumColumns = startColumn + ConsoleDisplayWidth::getWidth(newText + start, newSize - start);
+
+		// When both lines have the same width, the characters after the last
+		// difference are already on the screen.
+		size_t end = newSize;
+
+		if (oldNumColumns == newNumColumns)
+		{
+			size_t oldEnd = oldSize;
+
+			while (end > start && oldEnd > start && newText[end - 1] == oldText[oldEnd - 1])
+			{
+				--end;
+				--oldEnd;
+			}
+
+			while (end < newSize && isContinuationByte(newText[end]))
+				++end;
+
+			while (isZeroWidth(newText, end, newSize))
+				end = findCharacterEnd(newText, end, newSize);
+		}
+
+		moveToRow(row);
+		frame << "\x1b[" << (startColumn + 1) << "G";
+		frame.write(newText + start, end - start);
+
+		if (newNumColumns < oldNumColumns)
+			frame << "\x1b[K";
+	}
+
+	void writeFrame()
+	{
+		stream.write(frame.getData(), frame.getDataSize());
+		stream.printData();
+	}
+
+	//==============================================================================
+	ConsoleOutputStream &stream;
+	const ConsoleCapabilities &capabilities;
+	juce::StringArray lastFrame;
+	juce::MemoryOutputStream frame;
+	int cursorRow = 0;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleLiveRegion)
+};
@@ -0,0 +1,384 @@
+﻿#pragma once
+#define EZ_CONSOLETABLE_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Lays out rows of text in aligned columns, counting CJK characters as
+	       two columns wide.
+	       将多行文本排列成对齐的列，中日韩字符按两列宽计算。
+
+	Each cell is measured once with ConsoleDisplayWidth when its row is added,
+	so the layout works however much CJK and ASCII text is mixed. When a row is
+	written, the cells, their padding and the separators go straight into the
+	stream's buffer in a single pass, with no String built for the line.
+
+	By default the table keeps its rows until "print", then makes each column
+	as wide as its widest cell. In streaming mode, each row is written as soon
+	as it is added, and the header before the first one, so a table of results
+	that come in slowly shows up as they do. The width of each column must then
+	be known in advance: it is the width given to "addColumn", or the width of
+	the title. In either mode, a cell that is wider than a column of fixed
+	width is cut short and ends with "...".
+
+	Cells should be single lines of plain text, as new lines, tabs and escape
+	sequences would move the cursor where the table does not expect. Narrow
+	string literals and "const char*" values are read as UTF-8, but with
+	Visual Studio a literal is only UTF-8 if the source is compiled with
+	"/utf-8", so use wide literals such as L"名称" as the rest of the module
+	does.
+
+	每个单元格在其所在行被添加时使用 ConsoleDisplayWidth 测量一次，因此无论中日韩
+	文本与ASCII文本如何混合，排版都是正确的。写出一行时，各单元格、其填充空格以及
+	分隔符会一次性直接写入输出流的缓冲区，不会为该行构建String。
+
+	默认情况下，表格会保留所有行直到调用"print"，然后使每一列与其最宽的单元格一样宽。
+	在流式模式下，每一行在被添加时立即写出（表头在第一行之前写出），因此缓慢到达的
+	结果表格会随结果的到达而显示。此时每一列的宽度必须事先确定：即传给"addColumn"的
+	宽度，或者标题的宽度。在两种模式下，比固定宽度的列更宽的单元格都会被截断，并以
+	"..."结尾。
+
+	单元格应为单行纯文本，因为换行符、制表符和转义序列会将光标移到表格意料之外的
+	位置。窄字符串字面量和"const char*"值会被当作UTF-8读取，但在Visual Studio中，
+	只有以"/utf-8"编译源文件时字面量才是UTF-8编码，因此请像本模块的其他部分一样
+	使用宽字符串字面量，例如L"名称"。
+
+	@code
+	ConsoleTable table(ezout);
+	table.addColumn(L"名称");
+	table.addColumn(L"大小", ConsoleTable::alignRight);
+	table.addRow("readme.txt", 1024);
+	table.addRow(L"说明文档.pdf", 52431);
+	table.print();
+	@endcode
+
+	@see ConsoleDisplayWidth
+*/
+class ConsoleTable
+{
+public:
+	//==============================================================================
+	/** @brief Where a cell sits in its column.
+	           单元格在其所在列中的位置。
+	*/
+	enum Alignment
+	{
+		alignLeft,   /**< 左对齐。 */
+		alignRight,  /**< 右对齐。 */
+		alignCentre  /**< 居中。 */
+	};
+
+	//==============================================================================
+	/** @brief Creates a table that writes to a stream.
+	           创建一个写入输出流的表格。
+
+		@param outputStream  The stream to write to. It must outlive the table.
+		                     要写入的输出流，其生命周期必须长于表格。
+
+		@param streamRows    If true, each row is written as soon as it is added.
+		                     The default value is false.
+		                     设为true则每一行在被添加时立即写出。默认值是false。
+	*/
+	explicit ConsoleTable(ConsoleOutputStream &outputStream, bool streamRows = false)
+		: stream(outputStream), streaming(streamRows)
+	{
+	}
+
+	//==============================================================================
+	/** @brief Adds a column. All columns must be added before the first row.
+	           添加一列。所有列都必须在第一行之前添加。
+
+		@param title      The text of the header. If every title is empty, no
+		                  header is written.
+		                  表头的文本。如果所有标题都为空，则不写出表头。
+
+		@param alignment  Where the cells sit. The default is alignLeft.
+		                  单元格的位置。默认值是alignLeft。
+
+		@param width      The width of the column in terminal columns, or 0 to
+		                  fit the cells (the title in streaming mode). The
+		                  default value is 0.
+		                  以终端列计的列宽，设为0则适应单元格的宽度（流式模式下为
+		                  标题的宽度）。默认值是0。
+	*/
+	void addColumn(const juce::String &title, Alignment alignment = alignLeft, int width = 0)
+	{
+		jassert(rows.isEmpty() && !headerWritten);
+
+		Column column;
+		column.title = title;
+		column.titleWidth = ConsoleDisplayWidth::getWidth(title);
+		column.alignment = alignment;
+		column.fixedWidth = width;
+		columns.add(column);
+	}
+
+	/** @brief Adds a column whose title is UTF-8 text.
+	           添加一列，其标题为UTF-8文本。
+
+		@see addColumn
+	*/
+	void addColumn(const char *title, Alignment alignment = alignLeft, int width = 0)
+	{
+		addColumn(juce::String::fromUTF8(title), alignment, width);
+	}
+
+	/** @brief Sets what is written between two columns. The default is two spaces.
+	           设置两列之间写出的内容。默认值是两个空格。
+	*/
+	void setSeparator(const juce::String &columnSeparator)
+	{
+		separator = columnSeparator;
+	}
+
+	/** @brief Sets the character of the line under the header, or 0 for no line.
+	           设置表头下方横线所用的字符，设为0则不画横线。
+
+		The default is '-'.
+
+		默认值是'-'。
+	*/
+	void setHeaderRule(char ruleCharacter)
+	{
+		headerRule = ruleCharacter;
+	}
+
+	//==============================================================================
+	/** @brief Adds a row. Missing cells are left empty, extra ones are ignored.
+	           添加一行。缺少的单元格留空，多余的单元格被忽略。
+	*/
+	void addRow(const juce::StringArray &cells)
+	{
+		jassert(columns.size() > 0);
+
+		Row row;
+
+		for (int i = 0; i < columns.size(); ++i)
+		{
+			const juce::String cell(i < cells.size() ? cells[i] : juce::String());
+			row.cells.add(cell);
+			row.widths.add(ConsoleDisplayWidth::getWidth(cell));
+		}
+
+		if (!streaming)
+		{
+			rows.add(row);
+			return;
+		}
+
+		if (!headerWritten)
+		{
+			for (int i = 0; i < columns.size(); ++i)
+			{
+				Column &column = columns.getReference(i);
+				column.width = column.fixedWidth > 0 ? column.fixedWidth : juce::jmax(1, column.titleWidth);
+			}
+
+			writeHeader();
+		}
+
+		writeRow(row);
+	}
+
+	/** @brief Adds a row from any values that juce::String can be made from.
+	           使用任何可以构造 juce::String 的值添加一行。
+
+		Narrow strings are read as UTF-8.
+
+		窄字符串会被当作UTF-8读取。
+	*/
+	template <typename... Cells>
+	void addRow(const Cells&... cells)
+	{
+		const juce::String values[] = { toCell(cells)... };
+		addRow(juce::StringArray(values, (int)sizeof...(cells)));
+	}
+
+	/** @brief Adds a row with every cell empty.
+	           添加一个所有单元格均为空的行。
+	*/
+	void addRow()
+	{
+		addRow(juce::StringArray());
+	}
+
+	/** @brief Writes the rows that were kept, with the header, and forgets them.
+	           写出保留的各行及表头，然后丢弃它们。
+
+		In streaming mode the rows are already written, so this only writes the
+		header if no row was added.
+
+		在流式模式下，各行已经写出，因此该方法只在没有添加任何行时写出表头。
+	*/
+	void print()
+	{
+		if (headerWritten)
+			return;
+
+		for (int i = 0; i < columns.size(); ++i)
+		{
+			Column &column = columns.getReference(i);
+			column.width = column.fixedWidth;
+
+			if (column.width <= 0)
+			{
+				column.width = column.titleWidth;
+
+				for (int r = 0; r < rows.size(); ++r)
+					column.width = juce::jmax(column.width, rows.getReference(r).widths[i]);
+			}
+		}
+
+		writeHeader();
+
+		for (int r = 0; r < rows.size(); ++r)
+			writeRow(rows.getReference(r));
+
+		rows.clear();
+		headerWritten = streaming;
+	}
+
+	/** @brief Returns the number of columns.
+	           返回列数。
+	*/
+	int getNumColumns() const
+	{
+		return columns.size();
+	}
+
+private:
+	//==============================================================================
+	struct Column
+	{
+		juce::String title;
+		int titleWidth = 0, fixedWidth = 0, width = 0;
+		Alignment alignment = alignLeft;
+	};
+
+	struct Row
+	{
+		juce::StringArray cells;
+		juce::Array<int> widths;
+	};
+
+	enum
+	{
+		ellipsisWidth = 3
+	};
+
+	//==============================================================================
+	// juce::String would take a "const char*" for ASCII.
+	static juce::String toCell(const char *text)
+	{
+		return juce::String::fromUTF8(text);
+	}
+
+	static juce::String toCell(char *text)
+	{
+		return juce::String::fromUTF8(text);
+	}
+
+	template <typename Type>
+	static juce::String toCell(const Type &value)
+	{
+		return juce::String(value);
+	}
+
+	//==============================================================================
+	void writeHeader()
+	{
+		headerWritten = true;
+
+		bool hasTitles = false;
+
+		for (int i = 0; i < columns.size(); ++i)
+			hasTitles = hasTitles || columns.getReference(i).titleWidth > 0;
+
+		if (!hasTitles)
+			return;
+
+		Row header;
+
+		for (int i = 0; i < columns.size(); ++i)
+		{
+			header.cells.add(columns.getReference(i).title);
+			header.widths.add(columns.getReference(i).titleWidth);
+		}
+
+		writeRow(header);
+
+		if (headerRule != 0)
+		{
+			for (int i = 0; i < columns.size(); ++i)
+			{
+				if (i > 0)
+					stream.write(separator.toRawUTF8(), separator.getNumBytesAsUTF8());
+
+				stream.writeRepeatedByte((juce::uint8)headerRule, (size_t)columns.getReference(i).width);
+			}
+
+			stream.write("\n", 1);
+		}
+	}
+
+	// Empty cells at the end of a row, and the spaces after the last cell,
+	// are left out.
+	void writeRow(const Row &row)
+	{
+		int lastColumn = columns.size() - 1;
+
+		while (lastColumn > 0 && row.cells[lastColumn].isEmpty())
+			--lastColumn;
+
+		for (int i = 0; i <= lastColumn; ++i)
+		{
+			const Column &column = columns.getReference(i);
+			const juce::String &cell = row.cells.getReference(i);
+			const char *text = cell.toRawUTF8();
+			size_t numBytes = cell.getNumBytesAsUTF8();
+			int cellWidth = row.widths[i];
+			bool isCut = false;
+
+			if (cellWidth > column.width)
+			{
+				isCut = column.width > ellipsisWidth;
+				numBytes = ConsoleDisplayWidth::findPrefixThatFits(text, numBytes,
+					isCut ? column.width - ellipsisWidth : column.width, cellWidth);
+
+				if (isCut)
+					cellWidth += ellipsisWidth;
+			}
+
+			const int padding = column.width - cellWidth;
+			const int paddingBefore = column.alignment == alignRight ? padding
+			                        : column.alignment == alignCentre ? padding / 2 : 0;
+			const int paddingAfter = i < lastColumn ? padding - paddingBefore : 0;
+
+			if (i > 0)
+				stream.write(separator.toRawUTF8(), separator.getNumBytesAsUTF8());
+
+			stream.writeRepeatedByte(' ', (size_t)paddingBefore);
+			stream.write(text, numBytes);
+
+			if (isCut)
+				stream.write("...", ellipsisWidth);
+
+			stream.writeRepeatedByte(' ', (size_t)paddingAfter);
+		}
+
+		stream.write("\n", 1);
+	}
+
+	//==============================================================================
+	ConsoleOutputStream &stream;
+	const bool streaming;
+
+	juce::Array<Column> columns;
+	juce::Array<Row> rows;
+
+	juce::String separator { "  " };
+	char headerRule = '-';
+	bool headerWritten = false;
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleTable)
+};
@@ -0,0 +1,698 @@
+﻿#pragma once
+#define EZ_CONSOLEUTF8_H_INCLUDED
+
+//==============================================================================
+/**
+
+    @brief Fast UTF-8 validation, and conversion of wide text to UTF-8.
+	       快速的UTF-8校验，以及宽字符文本到UTF-8的转换。
+
+	Console output is mostly ASCII with runs of CJK text, so the kernels are
+	built around those two cases. Blocks of ASCII are checked and copied with
+	SSE2 (16 bytes at a time) or AVX2 (32 bytes at a time), and with AVX2 a
+	block of eight characters from the three-byte range, which covers all CJK
+	ideographs and punctuation, is encoded with a couple of byte shuffles.
+	Everything else goes through the scalar code, which is also used on CPUs
+	without SSE2. AVX2 is only used when "juce::SystemStats::hasAVX2" says the
+	CPU has it.
+
+	Unpaired surrogates and values above U+10FFFF are written as U+FFFD, so
+	the output is always valid UTF-8.
+
+	控制台输出大多是ASCII，并夹杂着成段的中日韩文本，因此这些内核围绕这两种情况
+	设计。ASCII 数据块使用 SSE2（每次16字节）或 AVX2（每次32字节）进行检查和拷贝；
+	在 AVX2 下，八个位于三字节编码范围内的字符（涵盖所有中日韩表意文字及标点）会
+	通过几次字节重排一次性完成编码。其他情况使用标量代码处理，不支持 SSE2 的 CPU
+	也使用标量代码。只有当"juce::SystemStats::hasAVX2"表明 CPU 支持时才会使用
+	AVX2。
+
+	未配对的代理项以及大于U+10FFFF的值会被写为U+FFFD，因此输出始终是合法的UTF-8。
+
+	@see ConsoleOutputStream::setUTF8ValidationEnabled
+*/
+class ConsoleUTF8
+{
+public:
+	//==============================================================================
+	/** @brief Checks the UTF-8 sequence that starts at "bytes".
+	           检查从"bytes"开始的UTF-8序列。
+
+		Overlong forms, surrogates and values above U+10FFFF are invalid.
+
+		过长编码、代理项以及大于U+10FFFF的值都是非法的。
+
+		@returns the length of the sequence if it is valid, 0 if it is invalid,
+		         or -1 if it is a valid start that is cut short by the end of
+		         the data.
+		@returns 序列合法时返回其长度，非法时返回0，如果是一个合法的开头但被数据末尾
+		         截断则返回-1。
+	*/
+	static int getSequenceLength(const juce::uint8 *bytes, size_t numAvailable)
+	{
+		int numValidBytes;
+		return checkSequence(bytes, numAvailable, numValidBytes);
+	}
+
+	/** @brief Returns the offset of the first byte that is not part of a valid sequence.
+	           返回第一个不属于合法序列的字节的偏移量。
+
+		@returns numBytes if all the data is valid UTF-8. A sequence that is cut
+		         short by the end of the data counts as invalid.
+		@returns 如果全部数据都是合法的UTF-8则返回numBytes。被数据末尾截断的序列
+		         视为非法。
+	*/
+	static size_t findFirstInvalid(const char *data, size_t numBytes)
+	{
+		static const Validator validator = ConsoleSIMD::chooseKernel(findFirstInvalidScalar, findFirstInvalidSSE2, findFirstInvalidAVX2);
+		return validator(data, numBytes);
+	}
+
+	/** @brief Returns true if the data is valid UTF-8.
+	           如果数据是合法的UTF-8，返回true。
+	*/
+	static bool isValid(const char *data, size_t numBytes)
+	{
+		return findFirstInvalid(data, numBytes) == numBytes;
+	}
+
+	/** @brief Returns true if a list of chunks holds valid UTF-8.
+	           如果内存块链表中的数据是合法的UTF-8，返回true。
+
+		Sequences that are split between two chunks are checked as a whole.
+
+		被拆分到两个内存块中的序列会作为一个整体进行检查。
+	*/
+	static bool isValid(const ConsoleChunk *firstChunk)
+	{
+		size_t numToSkip = 0;
+
+		for (const ConsoleChunk *chunk = firstChunk; chunk != nullptr; chunk = chunk->next)
+		{
+			if (numToSkip >= chunk->size)
+			{
+				numToSkip -= chunk->size;
+				continue;
+			}
+
+			const char *data = chunk->data + numToSkip;
+			const size_t numBytes = chunk->size - numToSkip;
+			const size_t invalid = findFirstInvalid(data, numBytes);
+
+			numToSkip = 0;
+
+			if (invalid == numBytes)
+				continue;
+
+			const size_t numTailBytes = numBytes - invalid;
+
+			if (numTailBytes >= 4 || getSequenceLength((const juce::uint8*)data + invalid, numTailBytes) >= 0)
+				return false;
+
+			// A sequence that runs on into the next chunks: gather it and check it as a whole
+			juce::uint8 sequence[4];
+			size_t numGathered = numTailBytes;
+			memcpy(sequence, data + invalid, numTailBytes);
+
+			for (const ConsoleChunk *next = chunk->next; next != nullptr && numGathered < 4; next = next->next)
+				for (size_t i = 0; i < next->size && numGathered < 4; ++i)
+					sequence[numGathered++] = (juce::uint8)next->data[i];
+
+			const int length = getSequenceLength(sequence, numGathered);
+
+			if (length <= 0)
+				return false;
+
+			numToSkip = (size_t)length - numTailBytes;
+		}
+
+		return true;
+	}
+
+	/** @brief Copies UTF-8 data, replacing each invalid sequence with U+FFFD.
+	           拷贝UTF-8数据，并将每个非法序列替换为U+FFFD。
+
+		Copying stops when the source has all been read or when there are fewer
+		than 4 bytes of room left.
+
+		当源数据全部读完，或者剩余空间少于4字节时停止拷贝。
+
+		@param numBytesRead  Set to the number of source bytes that were used.
+		                     被设置为已使用的源数据字节数。
+
+		@returns the number of bytes written to "dest".
+		@returns 写入"dest"的字节数。
+	*/
+	static size_t sanitise(const char *source, size_t numBytes, char *dest, size_t destSize, size_t &numBytesRead)
+	{
+		size_t numRead = 0, numWritten = 0;
+
+		while (numRead < numBytes && destSize - numWritten >= 4)
+		{
+			const size_t numValid = findFirstInvalid(source + numRead, juce::jmin(numBytes - numRead, destSize - numWritten));
+
+			memcpy(dest + numWritten, source + numRead, numValid);
+			numRead += numValid;
+			numWritten += numValid;
+
+			if (numRead == numBytes || destSize - numWritten < 4)
+				break;
+
+			const juce::uint8 *sequence = (const juce::uint8*)source + numRead;
+			int numValidBytes;
+			const int length = checkSequence(sequence, numBytes - numRead, numValidBytes);
+
+			if (length > 0)
+			{
+				// Only cut short by the room left in "dest"
+				memcpy(dest + numWritten, sequence, (size_t)length);
+				numRead += (size_t)length;
+				numWritten += (size_t)length;
+			}
+			else
+			{
+				numWritten += writeCodePoint(0xfffd, dest + numWritten);
+				numRead += (size_t)numValidBytes;
+			}
+		}
+
+		numBytesRead = numRead;
+		return numWritten;
+	}
+
+	//==============================================================================
+	/** @brief Converts UTF-16 to UTF-8.
+	           将UTF-16转换为UTF-8。
+
+		"dest" must have room for 3 bytes per source unit.
+
+		"dest"中每个源编码单元需要有3字节的空间。
+
+		@returns the number of bytes written.
+		@returns 写入的字节数。
+	*/
+	static size_t convertUTF16(const juce::uint16 *source, size_t numUnits, char *dest)
+	{
+		static const UTF16Converter converter = ConsoleSIMD::chooseKernel(convertUTF16Scalar, convertUTF16SSE2, convertUTF16AVX2);
+		return converter(source, numUnits, dest);
+	}
+
+	/** @brief Converts UTF-32 to UTF-8.
+	           将UTF-32转换为UTF-8。
+
+		"dest" must have room for 4 bytes per source unit.
+
+		"dest"中每个源编码单元需要有4字节的空间。
+
+		@returns the number of bytes written.
+		@returns 写入的字节数。
+	*/
+	static size_t convertUTF32(const juce::uint32 *source, size_t numUnits, char *dest)
+	{
+		static const UTF32Converter converter = ConsoleSIMD::chooseKernel(convertUTF32Scalar, convertUTF32SSE2, convertUTF32AVX2);
+		return converter(source, numUnits, dest);
+	}
+
+	//==============================================================================
+	/** @brief Appends UTF-16 text to a chunk buffer as UTF-8.
+	           将UTF-16文本以UTF-8形式追加到内存块缓冲区。
+	*/
+	static void appendUTF16(ConsoleChunkBuffer &buffer, const juce::uint16 *source, size_t numUnits)
+	{
+		while (numUnits > 0)
+		{
+			size_t numInPiece = juce::jmin(numUnits, (size_t)utf16UnitsPerPiece);
+
+			// Never split a surrogate pair between two pieces
+			if (numInPiece < numUnits && source[numInPiece - 1] >= 0xd800 && source[numInPiece - 1] < 0xdc00)
+				--numInPiece;
+
+			buffer.commitWrite(convertUTF16(source, numInPiece, buffer.prepareWrite(numInPiece * 3)));
+			source += numInPiece;
+			numUnits -= numInPiece;
+		}
+	}
+
+	/** @brief Appends UTF-32 text to a chunk buffer as UTF-8.
+	           将UTF-32文本以UTF-8形式追加到内存块缓冲区。
+	*/
+	static void appendUTF32(ConsoleChunkBuffer &buffer, const juce::uint32 *source, size_t numUnits)
+	{
+		while (numUnits > 0)
+		{
+			const size_t numInPiece = juce::jmin(numUnits, (size_t)utf32UnitsPerPiece);
+
+			buffer.commitWrite(convertUTF32(source, numInPiece, buffer.prepareWrite(numInPiece * 4)));
+			source += numInPiece;
+			numUnits -= numInPiece;
+		}
+	}
+
+	/** @brief Appends wchar_t text to a chunk buffer as UTF-8.
+	           将wchar_t文本以UTF-8形式追加到内存块缓冲区。
+
+		wchar_t holds UTF-16 on Windows and UTF-32 everywhere else.
+
+		wchar_t在Windows中为UTF-16，在其他系统中为UTF-32。
+	*/
+	static void appendWide(ConsoleChunkBuffer &buffer, const wchar_t *source, size_t numUnits)
+	{
+		if (sizeof(wchar_t) == 2)
+			appendUTF16(buffer, reinterpret_cast<const juce::uint16*>(source), numUnits);
+		else
+			appendUTF32(buffer, reinterpret_cast<const juce::uint32*>(source), numUnits);
+	}
+
+	/** @brief Appends UTF-8 data to a chunk buffer, replacing each invalid sequence with U+FFFD.
+	           将UTF-8数据追加到内存块缓冲区，并将每个非法序列替换为U+FFFD。
+	*/
+	static void appendSanitised(ConsoleChunkBuffer &buffer, const char *source, size_t numBytes)
+	{
+		while (numBytes > 0)
+		{
+			size_t numRead;
+			buffer.commitWrite(sanitise(source, numBytes, buffer.prepareWrite(sanitisedBytesPerPiece),
+			                            sanitisedBytesPerPiece, numRead));
+			source += numRead;
+			numBytes -= numRead;
+		}
+	}
+
+private:
+	//==============================================================================
+	enum
+	{
+		utf16UnitsPerPiece = 4096,
+		utf32UnitsPerPiece = 2048,
+		sanitisedBytesPerPiece = 4096
+	};
+
+	typedef size_t (*Validator) (const char*, size_t);
+	typedef size_t (*UTF16Converter) (const juce::uint16*, size_t, char*);
+	typedef size_t (*UTF32Converter) (const juce::uint32*, size_t, char*);
+
+	//==============================================================================
+	static int checkSequence(const juce::uint8 *bytes, size_t numAvailable, int &numValidBytes)
+	{
+		const juce::uint8 lead = bytes[0];
+		juce::uint8 low = 0x80, high = 0xbf;
+		int length;
+
+		numValidBytes = 1;
+
+		if (lead < 0x80)
+			return 1;
+
+		if (lead < 0xc2)
+			return 0;
+
+		if (lead < 0xe0)
+		{
+			length = 2;
+		}
+		else if (lead < 0xf0)
+		{
+			length = 3;
+
+			if (lead == 0xe0)       low = 0xa0;  // overlong
+			else if (lead == 0xed)  high = 0x9f; // surrogates
+		}
+		else if (lead < 0xf5)
+		{
+			length = 4;
+
+			if (lead == 0xf0)       low = 0x90;  // overlong
+			else if (lead == 0xf4)  high = 0x8f; // above U+10FFFF
+		}
+		else
+		{
+			return 0;
+		}
+
+		for (int i = 1; i < length; ++i)
+		{
+			if ((size_t)i >= numAvailable)
+				return -1;
+
+			if (bytes[i] < low || bytes[i] > high)
+				return 0;
+
+			low = 0x80;
+			high = 0xbf;
+			++numValidBytes;
+		}
+
+		return length;
+	}
+
+	static size_t writeCodePoint(juce::uint32 c, char *dest)
+	{
+		if (c < 0x80)
+		{
+			dest[0] = (char)c;
+			return 1;
+		}
+
+		if (c < 0x800)
+		{
+			dest[0] = (char)(0xc0 | (c >> 6));
+			dest[1] = (char)(0x80 | (c & 0x3f));
+			return 2;
+		}
+
+		if (c >= 0x110000 || (c >= 0xd800 && c < 0xe000))
+			c = 0xfffd;
+
+		if (c < 0x10000)
+		{
+			dest[0] = (char)(0xe0 | (c >> 12));
+			dest[1] = (char)(0x80 | ((c >> 6) & 0x3f));
+			dest[2] = (char)(0x80 | (c & 0x3f));
+			return 3;
+		}
+
+		dest[0] = (char)(0xf0 | (c >> 18));
+		dest[1] = (char)(0x80 | ((c >> 12) & 0x3f));
+		dest[2] = (char)(0x80 | ((c >> 6) & 0x3f));
+		dest[3] = (char)(0x80 | (c & 0x3f));
+		return 4;
+	}
+
+	static size_t encodeUTF16At(const juce::uint16 *source, size_t index, size_t numUnits, char *&dest)
+	{
+		const juce::uint32 c = source[index];
+
+		if (c >= 0xd800 && c < 0xdc00 && index + 1 < numUnits
+		    && source[index + 1] >= 0xdc00 && source[index + 1] < 0xe000)
+		{
+			dest += writeCodePoint(0x10000 + ((c - 0xd800) << 10) + (source[index + 1] - 0xdc00u), dest);
+			return 2;
+		}
+
+		dest += writeCodePoint(c, dest);
+		return 1;
+	}
+
+	static size_t skipSequences(const juce::uint8 *bytes, size_t index, size_t end, size_t numBytes, bool &isValid)
+	{
+		while (index < end)
+		{
+			const int length = getSequenceLength(bytes + index, numBytes - index);
+
+			if (length <= 0)
+			{
+				isValid = false;
+				return index;
+			}
+
+			index += (size_t)length;
+		}
+
+		isValid = true;
+		return index;
+	}
+
+	//==============================================================================
+	static size_t findFirstInvalidScalar(const char *data, size_t numBytes)
+	{
+		const juce::uint8 *bytes = (const juce::uint8*)data;
+		size_t i = 0;
+		bool isValid = true;
+
+		while (i < numBytes)
+		{
+			if (i + 8 <= numBytes)
+			{
+				juce::uint64 word;
+				memcpy(&word, bytes + i, sizeof(word));
+
+				if ((word & 0x8080808080808080ULL) == 0)
+				{
+					i += 8;
+					continue;
+				}
+			}
+
+			i = skipSequences(bytes, i, juce::jmin(i + 8, numBytes), numBytes, isValid);
+
+			if (!isValid)
+				return i;
+		}
+
+		return numBytes;
+	}
+
+	static size_t convertUTF16Scalar(const juce::uint16 *source, size_t numUnits, char *dest)
+	{
+		char *d = dest;
+
+		for (size_t i = 0; i < numUnits;)
+			i += encodeUTF16At(source, i, numUnits, d);
+
+		return (size_t)(d - dest);
+	}
+
+	static size_t convertUTF32Scalar(const juce::uint32 *source, size_t numUnits, char *dest)
+	{
+		char *d = dest;
+
+		for (size_t i = 0; i < numUnits; ++i)
+			d += writeCodePoint(source[i], d);
+
+		return (size_t)(d - dest);
+	}
+
+#if EZ_CONSOLE_USE_SSE2
+	//==============================================================================
+	static bool isAsciiUTF16(__m128i units)
+	{
+		const __m128i high = _mm_and_si128(units, _mm_set1_epi16((short)0xff80));
+		return _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) == 0xffff;
+	}
+
+	static size_t findFirstInvalidSSE2(const char *data, size_t numBytes)
+	{
+		const juce::uint8 *bytes = (const juce::uint8*)data;
+		size_t i = 0;
+		bool isValid = true;
+
+		while (i < numBytes)
+		{
+			if (i + 16 <= numBytes
+			    && _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(bytes + i))) == 0)
+			{
+				i += 16;
+				continue;
+			}
+
+			i = skipSequences(bytes, i, juce::jmin(i + 16, numBytes), numBytes, isValid);
+
+			if (!isValid)
+				return i;
+		}
+
+		return numBytes;
+	}
+
+	static size_t convertUTF16SSE2(const juce::uint16 *source, size_t numUnits, char *dest)
+	{
+		char *d = dest;
+		size_t i = 0;
+
+		while (i < numUnits)
+		{
+			if (i + 8 <= numUnits)
+			{
+				const __m128i units = _mm_loadu_si128((const __m128i*)(source + i));
+
+				if (isAsciiUTF16(units))
+				{
+					_mm_storel_epi64((__m128i*)d, _mm_packus_epi16(units, units));
+					d += 8;
+					i += 8;
+					continue;
+				}
+			}
+
+			for (const size_t end = juce::jmin(i + 8, numUnits); i < end;)
+				i += encodeUTF16At(source, i, numUnits, d);
+		}
+
+		return (size_t)(d - dest);
+	}
+
+	static size_t convertUTF32SSE2(const juce::uint32 *source, size_t numUnits, char *dest)
+	{
+		const __m128i nonAscii = _mm_set1_epi32(~0x7f);
+		char *d = dest;
+		size_t i = 0;
+
+		while (i < numUnits)
+		{
+			if (i + 4 <= numUnits)
+			{
+				const __m128i units = _mm_loadu_si128((const __m128i*)(source + i));
+
+				if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(units, nonAscii), _mm_setzero_si128())) == 0xffff)
+				{
+					const __m128i words = _mm_packs_epi32(units, units);
+					const int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+					memcpy(d, &bytes, 4);
+					d += 4;
+					i += 4;
+					continue;
+				}
+			}
+
+			for (const size_t end = juce::jmin(i + 4, numUnits); i < end; ++i)
+				d += writeCodePoint(source[i], d);
+		}
+
+		return (size_t)(d - dest);
+	}
+#else
+	static size_t findFirstInvalidSSE2(const char*, size_t)                   { return 0; }
+	static size_t convertUTF16SSE2(const juce::uint16*, size_t, char*)       { return 0; }
+	static size_t convertUTF32SSE2(const juce::uint32*, size_t, char*)       { return 0; }
+#endif
+
+#if EZ_CONSOLE_USE_AVX2
+	//==============================================================================
+	/** Writes eight UTF-16 units that are all ASCII or all in the three-byte range. */
+	EZ_CONSOLE_AVX2_TARGET
+	static bool encodeBlockAVX2(__m128i units, char *&dest)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i top = _mm_and_si128(units, _mm_set1_epi16((short)0xf800));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((short)0xff80)), zero)) == 0xffff)
+		{
+			_mm_storel_epi64((__m128i*)dest, _mm_packus_epi16(units, units));
+			dest += 8;
+			return true;
+		}
+
+		const __m128i notThreeBytes = _mm_or_si128(_mm_cmpeq_epi16(top, zero),
+		                                           _mm_cmpeq_epi16(top, _mm_set1_epi16((short)0xd800)));
+
+		if (_mm_movemask_epi8(notThreeBytes) != 0)
+			return false;
+
+		const __m128i lowBits = _mm_set1_epi16(0x3f);
+		const __m128i continuation = _mm_set1_epi16(0x80);
+
+		const __m128i first  = _mm_or_si128(_mm_srli_epi16(units, 12), _mm_set1_epi16(0xe0));
+		const __m128i second = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(units, 6), lowBits), continuation);
+		const __m128i third  = _mm_or_si128(_mm_and_si128(units, lowBits), continuation);
+
+		// firstAndSecond holds the eight first bytes, then the eight second bytes
+		const __m128i firstAndSecond = _mm_packus_epi16(first, second);
+		const __m128i thirdBytes = _mm_packus_epi16(third, third);
+
+		const __m128i head = _mm_or_si128(
+			_mm_shuffle_epi8(firstAndSecond, _mm_setr_epi8(0, 8, -128, 1, 9, -128, 2, 10, -128, 3, 11, -128, 4, 12, -128, 5)),
+			_mm_shuffle_epi8(thirdBytes, _mm_setr_epi8(-128, -128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128)));
+
+		const __m128i tail = _mm_or_si128(
+			_mm_shuffle_epi8(firstAndSecond, _mm_setr_epi8(13, -128, 6, 14, -128, 7, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+			_mm_shuffle_epi8(thirdBytes, _mm_setr_epi8(-128, 5, -128, -128, 6, -128, -128, 7, -128, -128, -128, -128, -128, -128, -128, -128)));
+
+		_mm_storeu_si128((__m128i*)dest, head);
+		_mm_storel_epi64((__m128i*)(dest + 16), tail);
+		dest += 24;
+		return true;
+	}
+
+	EZ_CONSOLE_AVX2_TARGET
+	static size_t findFirstInvalidAVX2(const char *data, size_t numBytes)
+	{
+		const juce::uint8 *bytes = (const juce::uint8*)data;
+		size_t i = 0;
+		bool isValid = true;
+
+		while (i < numBytes)
+		{
+			if (i + 32 <= numBytes
+			    && _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(bytes + i))) == 0)
+			{
+				i += 32;
+				continue;
+			}
+
+			i = skipSequences(bytes, i, juce::jmin(i + 32, numBytes), numBytes, isValid);
+
+			if (!isValid)
+				return i;
+		}
+
+		return numBytes;
+	}
+
+	EZ_CONSOLE_AVX2_TARGET
+	static size_t convertUTF16AVX2(const juce::uint16 *source, size_t numUnits, char *dest)
+	{
+		const __m256i nonAscii = _mm256_set1_epi16((short)0xff80);
+		char *d = dest;
+		size_t i = 0;
+
+		while (i < numUnits)
+		{
+			if (i + 16 <= numUnits)
+			{
+				const __m256i units = _mm256_loadu_si256((const __m256i*)(source + i));
+
+				if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(units, nonAscii), _mm256_setzero_si256())) == -1)
+				{
+					_mm_storeu_si128((__m128i*)d, _mm_packus_epi16(_mm256_castsi256_si128(units),
+					                                                 _mm256_extracti128_si256(units, 1)));
+					d += 16;
+					i += 16;
+					continue;
+				}
+			}
+
+			if (i + 8 <= numUnits && encodeBlockAVX2(_mm_loadu_si128((const __m128i*)(source + i)), d))
+			{
+				i += 8;
+				continue;
+			}
+
+			for (const size_t end = juce::jmin(i + 8, numUnits); i < end;)
+				i += encodeUTF16At(source, i, numUnits, d);
+		}
+
+		return (size_t)(d - dest);
+	}
+
+	EZ_CONSOLE_AVX2_TARGET
+	static size_t convertUTF32AVX2(const juce::uint32 *source, size_t numUnits, char *dest)
+	{
+		const __m256i aboveBMP = _mm256_set1_epi32((int)0xffff0000);
+		char *d = dest;
+		size_t i = 0;
+
+		while (i < numUnits)
+		{
+			if (i + 8 <= numUnits)
+			{
+				const __m256i units = _mm256_loadu_si256((const __m256i*)(source + i));
+
+				if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(units, aboveBMP), _mm256_setzero_si256())) == -1
+				    && encodeBlockAVX2(_mm_packus_epi32(_mm256_castsi256_si128(units), _mm256_extracti128_si256(units, 1)), d))
+				{
+					i += 8;
+					continue;
+				}
+			}
+
+			for (const size_t end = juce::jmin(i + 8, numUnits); i < end; ++i)
+				d += writeCodePoint(source[i], d);
+		}
+
+		return (size_t)(d - dest);
+	}
+#else
+	static size_t findFirstInvalidAVX2(const char*, size_t)                   { return 0; }
+	static size_t convertUTF16AVX2(const juce::uint16*, size_t, char*)       { return 0; }
+	static size_t convertUTF32AVX2(const juce::uint32*, size_t, char*)       { return 0; }
+#endif
+};